@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <string>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <math.h>
 #include <boost/filesystem.hpp>
@@ -59,6 +60,34 @@
 
 using namespace Slic3r;
 
+// Print the memory held by the layers of the print objects, by processing step, by data type and the largest layer.
+static void print_memory_report(const Print &print)
+{
+    static const char *step_names[posCount] = { "slice", "perimeters", "prepare infill", "infill", "ironing", "support material" };
+    auto MB = [](size_t bytes) { return double(bytes) / (1024. * 1024.); };
+    boost::nowide::cout << std::fixed << std::setprecision(2);
+    for (const PrintObject *object : print.objects()) {
+        PrintObjectMemoryUsed memory = object->memory_used();
+        LayerMemoryUsed       total  = memory.total();
+        boost::nowide::cout << "Memory used by the layers of " << object->model_object()->name << ": " << MB(total.total()) << " MB in " <<
+            memory.layers.size() << " layers and " << memory.support_layers.size() << " support layers" << std::endl;
+        boost::nowide::cout << "    by step:";
+        for (int step = 0; step < posCount; ++ step)
+            boost::nowide::cout << (step == 0 ? " " : ", ") << step_names[step] << " " << MB(memory.step(PrintObjectStep(step))) << " MB";
+        boost::nowide::cout << std::endl << "    by data:";
+        for (int type = 0; type < ldtCount; ++ type)
+            boost::nowide::cout << (type == 0 ? " " : ", ") << layer_data_type_name(LayerDataType(type)) << " " << MB(total[LayerDataType(type)]) << " MB";
+        boost::nowide::cout << std::endl;
+        auto it_max = std::max_element(memory.layers.begin(), memory.layers.end(),
+            [](const LayerMemoryUsed &l1, const LayerMemoryUsed &l2) { return l1.total() < l2.total(); });
+        if (it_max != memory.layers.end()) {
+            const Layer *layer = object->layers()[it_max - memory.layers.begin()];
+            boost::nowide::cout << "    largest layer: " << layer->id() << " at print_z " << layer->print_z << ", " << MB(it_max->total()) << " MB" << std::endl;
+        }
+    }
+    boost::nowide::cout << std::defaultfloat;
+}
+
 int CLI::run(int argc, char **argv)
 {
 #ifdef __WXGTK__
@@ -435,8 +464,9 @@ int CLI::run(int argc, char **argv)
                 std::string outfile = m_config.opt_string("output");
                 Print       fff_print;
                 SLAPrint    sla_print;
+                // The archive is not set as the printer of the SLAPrint, thus the layers are not rasterized
+                // during processing, they are rasterized while streamed into the archive.
                 SL1Archive  sla_archive(sla_print.printer_config());
-                sla_print.set_printer(&sla_archive);
                 sla_print.set_status_callback(
                             [](const PrintBase::SlicingStatus& s)
                 {
@@ -467,7 +497,11 @@ int CLI::run(int argc, char **argv)
                 else
                     try {
                         std::string outfile_final;
+                        if (printer_technology == ptFFF)
+                            fff_print.set_release_intermediates(m_config.opt_bool("release_intermediates"));
                         print->process();
+                        if (printer_technology == ptFFF && m_config.opt_bool("memory_report"))
+                            print_memory_report(fff_print);
                         if (printer_technology == ptFFF) {
                             // The outfile is processed by a PlaceholderParser.
 #if ENABLE_GCODE_VIEWER
@@ -480,7 +514,7 @@ int CLI::run(int argc, char **argv)
                             outfile = sla_print.output_filepath(outfile);
                             // We need to finalize the filename beforehand because the export function sets the filename inside the zip metadata
                             outfile_final = sla_print.print_statistics().finalize_output_path(outfile);
-                            sla_archive.export_print(outfile_final, sla_print);
+                            sla_archive.export_print_streaming(outfile_final, sla_print);
                         }
                         if (outfile != outfile_final && Slic3r::rename_file(outfile, outfile_final)) {
                             boost::nowide::cerr << "Renaming file " << outfile << " to " << outfile_final << " failed" << std::endl;
@@ -47,6 +47,7 @@
 #include <cstdlib>
 #include <ostream>
 #include <functional>
+#include <memory>
 #include <assert.h>
 #include <libslic3r/Int128.hpp>
 
@@ -67,6 +68,69 @@ namespace ClipperLib_Z {
 namespace ClipperLib {
 #endif /* use_xyz */
 
+//------------------------------------------------------------------------------
+// Arena
+//------------------------------------------------------------------------------
+
+static thread_local Arena *s_current_arena = nullptr;
+
+Arena* current_arena()
+{
+  return s_current_arena;
+}
+
+ArenaScope::ArenaScope(Arena &arena) : m_prev(s_current_arena)
+{
+  s_current_arena = &arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+  s_current_arena = m_prev;
+}
+
+Arena::~Arena()
+{
+  for (Block &block : m_blocks)
+    ::operator delete(block.data);
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+  char *ptr = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(m_ptr) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+  if (m_ptr == nullptr || ptr + size > m_end) {
+    // The current block is exhausted, allocate a new one. The block sizes grow geometrically up to 16MB
+    // to keep the number of system allocations low for large inputs.
+    size_t block_size = std::max(m_next_block_size, size + alignment);
+    m_next_block_size = std::min<size_t>(m_next_block_size * 2, 16 * 1024 * 1024);
+    Block block { static_cast<char*>(::operator new(block_size)), block_size };
+    m_blocks.emplace_back(block);
+    ++ m_num_blocks;
+    m_end = block.data + block.size;
+    ptr   = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(block.data) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+  }
+  m_ptr = ptr + size;
+  ++ m_num_allocations;
+  m_num_bytes += size;
+  return ptr;
+}
+
+void Arena::release()
+{
+  if (m_blocks.empty())
+    return;
+  auto it_largest = std::max_element(m_blocks.begin(), m_blocks.end(), [](const Block &b1, const Block &b2) { return b1.size < b2.size; });
+  Block largest = *it_largest;
+  for (auto it = m_blocks.begin(); it != m_blocks.end(); ++ it)
+    if (it != it_largest)
+      ::operator delete(it->data);
+  m_blocks.assign(1, largest);
+  m_ptr = largest.data;
+  m_end = largest.data + largest.size;
+  m_next_block_size = m_block_size;
+}
+//------------------------------------------------------------------------------
+
 static double const pi = 3.141592653589793238;
 static double const two_pi = pi *2;
 static double const def_arc_tolerance = 0.25;
@@ -722,73 +786,7 @@ TEdge* ClipperBase::ProcessBound(TEdge* E, bool NextIsForward)
 }
 //------------------------------------------------------------------------------
 
-bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
-{
-  CLIPPERLIB_PROFILE_FUNC();
-  // Remove duplicate end point from a closed input path.
-  // Remove duplicate points from the end of the input path.
-  int highI = (int)pg.size() -1;
-  if (Closed) 
-    while (highI > 0 && (pg[highI] == pg[0])) 
-      --highI;
-  while (highI > 0 && (pg[highI] == pg[highI -1])) 
-    --highI;
-  if ((Closed && highI < 2) || (!Closed && highI < 1))
-    return false;
-
-  // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
-  // Fill in the edge array.
-  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
-  if (result)
-    // Success, remember the edge array.
-    m_edges.emplace_back(std::move(edges));
-  return result;
-}
-
-bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
-{
-  CLIPPERLIB_PROFILE_FUNC();
-  std::vector<int> num_edges(ppg.size(), 0);
-  int num_edges_total = 0;
-  for (size_t i = 0; i < ppg.size(); ++ i) {
-    const Path &pg = ppg[i];
-    // Remove duplicate end point from a closed input path.
-    // Remove duplicate points from the end of the input path.
-    int highI = (int)pg.size() -1;
-    if (Closed) 
-      while (highI > 0 && (pg[highI] == pg[0])) 
-        --highI;
-    while (highI > 0 && (pg[highI] == pg[highI -1])) 
-      --highI;
-    if ((Closed && highI < 2) || (!Closed && highI < 1))
-      highI = -1;
-    num_edges[i] = highI + 1;
-    num_edges_total += highI + 1;
-  }
-  if (num_edges_total == 0)
-    return false;
-
-  // Allocate a new edge array.
-  std::vector<TEdge> edges(num_edges_total);
-  // Fill in the edge array.
-  bool result = false;
-  TEdge *p_edge = edges.data();
-  for (Paths::size_type i = 0; i < ppg.size(); ++i)
-    if (num_edges[i]) {
-      bool res = AddPathInternal(ppg[i], num_edges[i] - 1, PolyTyp, Closed, p_edge);
-      if (res) {
-        p_edge += num_edges[i];
-        result = true;
-      }
-    }
-  if (result)
-    // At least some edges were generated. Remember the edge array.
-    m_edges.emplace_back(std::move(edges));
-  return result;
-}
-
-bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
+bool ClipperBase::AddEdgesInternal(int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   CLIPPERLIB_PROFILE_FUNC();
 #ifdef use_lines
@@ -799,20 +797,17 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
     throw clipperException("AddPath: Open paths have been disabled.");
 #endif
 
-  assert(highI >= 0 && highI < pg.size());
+  assert(highI >= 0);
 
   //1. Basic (first) edge initialization ...
+  // The edges have their Curr point filled in with the path points, InitEdge() clears the edge, thus copy the point first.
   try
   {
-    edges[1].Curr = pg[1];
-    RangeTest(pg[0], m_UseFullRange);
-    RangeTest(pg[highI], m_UseFullRange);
-    InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
-    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
-    for (int i = highI - 1; i >= 1; --i)
+    for (int i = highI; i >= 0; --i)
     {
-      RangeTest(pg[i], m_UseFullRange);
-      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
+      IntPoint pt = edges[i].Curr;
+      RangeTest(pt, m_UseFullRange);
+      InitEdge(&edges[i], &edges[i == highI ? 0 : i+1], &edges[i == 0 ? highI : i-1], pt);
     }
   }
   catch(...)
@@ -1048,9 +1043,16 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_PolyOuts(m_arena),
+  m_OutPts(m_arena),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
+  m_Joins(m_arena),
+  m_GhostJoins(m_arena),
+  m_IntersectList(m_arena),
+  m_Scanbeam(std::less<cInt>(), ArenaVector<cInt>(m_arena)),
+  m_Maxima(m_arena),
   m_ActiveEdges(nullptr),
   m_SortedEdges(nullptr)
 {
@@ -1068,7 +1070,7 @@ void Clipper::Reset()
 {
   CLIPPERLIB_PROFILE_FUNC();
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt>();
+  m_Scanbeam = Scanbeam(std::less<cInt>(), ArenaVector<cInt>(m_arena));
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1193,7 +1195,12 @@ OutPt* Clipper::AllocateOutPt()
     pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
   } else {
     // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    if (m_arena) {
+      OutPt *chunk = static_cast<OutPt*>(m_arena->allocate(m_OutPtsChunkSize * sizeof(OutPt), alignof(OutPt)));
+      std::uninitialized_default_construct_n(chunk, m_OutPtsChunkSize);
+      m_OutPts.push_back(chunk);
+    } else
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
     m_OutPtsChunkLast = 1;
     pt = m_OutPts.back();
   }
@@ -1202,10 +1209,13 @@ OutPt* Clipper::AllocateOutPt()
 
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
-  for (OutRec *rec : m_PolyOuts)
-    delete rec;
+  // Memory allocated from an arena is released with the arena.
+  if (m_arena == nullptr) {
+    for (OutPt *pts : m_OutPts)
+      delete[] pts;
+    for (OutRec *rec : m_PolyOuts)
+      delete rec;
+  }
   m_OutPts.clear();
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
@@ -1989,7 +1999,7 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = m_arena ? new (m_arena->allocate(sizeof(OutRec), alignof(OutRec))) OutRec : new OutRec;
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -2225,8 +2235,8 @@ void Clipper::ProcessHorizontal(TEdge *horzEdge)
   if (!eLastHorz->NextInLML)
     eMaxPair = GetMaximaPair(eLastHorz);
 
-  std::vector<cInt>::const_iterator maxIt;
-  std::vector<cInt>::const_reverse_iterator maxRit;
+  ArenaVector<cInt>::const_iterator maxIt;
+  ArenaVector<cInt>::const_reverse_iterator maxRit;
   if (!m_Maxima.empty())
   {
       //get the first maxima in range (X) ...
@@ -3343,77 +3353,6 @@ void ClipperOffset::Clear()
 }
 //------------------------------------------------------------------------------
 
-void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
-{
-  int highI = (int)path.size() - 1;
-  if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
-  newNode->m_jointype = joinType;
-  newNode->m_endtype = endType;
-
-  //strip duplicate points from path and also get index to the lowest point ...
-  bool   has_shortest_edge_length = ShortestEdgeLength > 0.;
-  double shortest_edge_length2 = has_shortest_edge_length ? ShortestEdgeLength * ShortestEdgeLength : 0.;
-  if (endType == etClosedLine || endType == etClosedPolygon)
-    for (; highI > 0; -- highI) {
-      bool same = false;
-      if (has_shortest_edge_length) {
-        double dx = double(path[highI].X - path[0].X);
-        double dy = double(path[highI].Y - path[0].Y);
-        same = dx*dx + dy*dy < shortest_edge_length2;
-      } else
-        same = path[0] == path[highI];
-      if (! same)
-        break;
-    }
-  newNode->Contour.reserve(highI + 1);
-  newNode->Contour.push_back(path[0]);
-  int j = 0, k = 0;
-  for (int i = 1; i <= highI; i++) {
-    bool same = false;
-    if (has_shortest_edge_length) {
-      double dx = double(path[i].X - newNode->Contour[j].X);
-      double dy = double(path[i].Y - newNode->Contour[j].Y);
-      same = dx*dx + dy*dy < shortest_edge_length2;
-    } else
-      same = newNode->Contour[j] == path[i];
-    if (same)
-      continue;
-    j++;
-    newNode->Contour.push_back(path[i]);
-    if (path[i].Y > newNode->Contour[k].Y ||
-      (path[i].Y == newNode->Contour[k].Y &&
-      path[i].X < newNode->Contour[k].X)) k = j;
-  }
-  if (endType == etClosedPolygon && j < 2)
-  {
-    delete newNode;
-    return;
-  }
-  m_polyNodes.AddChild(*newNode);
-
-  //if this path's lowest pt is lower than all the others then update m_lowest
-  if (endType != etClosedPolygon) return;
-  if (m_lowest.X < 0)
-    m_lowest = IntPoint(m_polyNodes.ChildCount() - 1, k);
-  else
-  {
-    IntPoint ip = m_polyNodes.Childs[(int)m_lowest.X]->Contour[(int)m_lowest.Y];
-    if (newNode->Contour[k].Y > ip.Y ||
-      (newNode->Contour[k].Y == ip.Y &&
-      newNode->Contour[k].X < ip.X))
-      m_lowest = IntPoint(m_polyNodes.ChildCount() - 1, k);
-  }
-}
-//------------------------------------------------------------------------------
-
-void ClipperOffset::AddPaths(const Paths& paths, JoinType joinType, EndType endType)
-{
-  for (const Path &path : paths)
-    AddPath(path, joinType, endType);
-}
-//------------------------------------------------------------------------------
-
 void ClipperOffset::FixOrientations()
 {
   //fixup orientations of all closed paths if the orientation of the
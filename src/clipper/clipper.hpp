@@ -56,6 +56,7 @@
 #include <ostream>
 #include <functional>
 #include <queue>
+#include <memory>
 
 #ifdef use_xyz
 namespace ClipperLib_Z {
@@ -102,6 +103,13 @@ struct IntPoint {
 typedef std::vector< IntPoint > Path;
 typedef std::vector< Path > Paths;
 
+// Conversion of a point of a path passed to AddPath() / AddPaths() to IntPoint.
+// Besides IntPoint, any point type with x() and y() accessors is accepted (Eigen vectors for example),
+// so that the paths do not need to be converted to ClipperLib::Path first.
+inline const IntPoint& PathPoint(const IntPoint &pt) { return pt; }
+template<typename PointType>
+inline IntPoint PathPoint(const PointType &pt) { return IntPoint(cInt(pt.x()), cInt(pt.y())); }
+
 inline Path& operator <<(Path& poly, const IntPoint& p) {poly.push_back(p); return poly;}
 inline Paths& operator <<(Paths& polys, const Path& p) {polys.push_back(p); return polys;}
 
@@ -122,6 +130,90 @@ struct DoublePoint
 typedef std::function<void(const IntPoint& e1bot, const IntPoint& e1top, const IntPoint& e2bot, const IntPoint& e2top, IntPoint& pt)> ZFillCallback;
 #endif
 
+// Monotonic memory arena for the short lived internal data structures of Clipper and ClipperOffset
+// (edges, local minima, scanbeam, output points and records, joins and intersections).
+// The memory is handed out from large blocks and it is released in bulk by release(),
+// deallocation of a single object is a no-op. An arena must only be used by a single thread.
+class Arena
+{
+public:
+  explicit Arena(size_t block_size = 256 * 1024) : m_block_size(block_size), m_next_block_size(block_size) {}
+  ~Arena();
+  void* allocate(size_t size, size_t alignment);
+  // Release all the memory allocated from the arena. The largest block is kept to be reused.
+  void  release();
+  // Number of allocations served by the arena since its construction.
+  size_t num_allocations() const { return m_num_allocations; }
+  // Number of bytes served by the arena since its construction.
+  size_t num_bytes() const { return m_num_bytes; }
+  // Number of blocks the arena allocated from the system since its construction.
+  size_t num_blocks() const { return m_num_blocks; }
+private:
+  Arena(const Arena &) = delete;
+  Arena& operator=(const Arena &) = delete;
+  struct Block {
+    char   *data;
+    size_t  size;
+  };
+  std::vector<Block> m_blocks;
+  char   *m_ptr { nullptr };
+  char   *m_end { nullptr };
+  size_t  m_block_size;
+  size_t  m_next_block_size;
+  size_t  m_num_allocations { 0 };
+  size_t  m_num_bytes { 0 };
+  size_t  m_num_blocks { 0 };
+};
+
+// Arena active on the current thread, nullptr if none.
+Arena* current_arena();
+
+// While an ArenaScope is alive, Clipper and ClipperOffset objects constructed by the current thread allocate
+// their internal data structures from the arena. These objects must be destroyed before the arena is released.
+// The input and output paths and PolyTrees are allocated from the heap as usual.
+class ArenaScope
+{
+public:
+  explicit ArenaScope(Arena &arena);
+  ~ArenaScope();
+private:
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope& operator=(const ArenaScope &) = delete;
+  Arena *m_prev;
+};
+
+// Allocator of the internal containers of Clipper and ClipperOffset, allocating from an arena
+// or from the heap if the arena is nullptr.
+template<typename T>
+class ArenaAllocator
+{
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ArenaAllocator(Arena *arena = nullptr) noexcept : m_arena(arena) {}
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> &rhs) noexcept : m_arena(rhs.arena()) {}
+
+  T*     allocate(size_t n) 
+    { return static_cast<T*>(m_arena ? m_arena->allocate(n * sizeof(T), alignof(T)) : ::operator new(n * sizeof(T))); }
+  void   deallocate(T *p, size_t) noexcept { if (m_arena == nullptr) ::operator delete(p); }
+  Arena* arena() const noexcept { return m_arena; }
+
+  template<typename U>
+  bool   operator==(const ArenaAllocator<U> &rhs) const noexcept { return m_arena == rhs.arena(); }
+  template<typename U>
+  bool   operator!=(const ArenaAllocator<U> &rhs) const noexcept { return m_arena != rhs.arena(); }
+
+private:
+  Arena *m_arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
 enum InitOptions {ioReverseSolution = 1, ioStrictlySimple = 2, ioPreserveCollinear = 4};
 enum JoinType {jtSquare, jtRound, jtMiter};
 enum EndType {etClosedPolygon, etClosedLine, etOpenButt, etOpenSquare, etOpenRound};
@@ -289,10 +381,16 @@ enum EdgeSide { esLeft = 1, esRight = 2};
 class ClipperBase
 {
 public:
-  ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
+  ClipperBase() : m_arena(current_arena()), m_MinimaList(m_arena), m_UseFullRange(false), m_edges(m_arena), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
-  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
-  bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  // A path is any random access container of points accepted by PathPoint(), providing size() and operator[].
+  // Paths is any container of such paths iterable by a range based for loop.
+  template<typename PathType>
+  bool AddPath(const PathType &pg, PolyType PolyTyp, bool Closed);
+  template<typename PathsType>
+  bool AddPaths(const PathsType &ppg, PolyType PolyTyp, bool Closed);
+  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed) { return AddPath<Path>(pg, PolyTyp, Closed); }
+  bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed) { return AddPaths<Paths>(ppg, PolyTyp, Closed); }
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -300,21 +398,34 @@ public:
   bool PreserveCollinear() const {return m_PreserveCollinear;};
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
-  bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Returns index of the last point of the path after removal of the duplicate points at its end, -1 if the path is degenerate.
+  template<typename PathType>
+  static int PathHighIndex(const PathType &pg, bool Closed);
+  // Fills in the edge array from the path points.
+  template<typename PathType>
+  bool AddPathInternal(const PathType &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges) {
+    for (int i = 0; i <= highI; ++ i)
+      edges[i].Curr = PathPoint(pg[i]);
+    return AddEdgesInternal(highI, PolyTyp, Closed, edges);
+  }
+  // Initializes the edges with their Curr point already filled in from an input path.
+  bool AddEdgesInternal(int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
   TEdge* DescendToMin(TEdge *&E);
   void AscendToMax(TEdge *&E, bool Appending, bool IsClosed);
 
+  // Arena to allocate the internal data structures from, captured at construction. Heap if nullptr.
+  Arena            *m_arena;
   // Local minima (Y, left edge, right edge) sorted by ascending Y.
-  std::vector<LocalMinimum> m_MinimaList;
+  ArenaVector<LocalMinimum> m_MinimaList;
 
   // True if the input polygons have abs values higher than loRange, but lower than hiRange.
   // False if the input polygons have abs values lower or equal to loRange.
   bool              m_UseFullRange;
   // A vector of edges per each input path.
-  std::vector<std::vector<TEdge>> m_edges;
+  ArenaVector<ArenaVector<TEdge>> m_edges;
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -358,22 +469,23 @@ protected:
 private:
   
   // Output polygons.
-  std::vector<OutRec*>  m_PolyOuts;
+  ArenaVector<OutRec*>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
-  std::vector<OutPt*>   m_OutPts;
+  ArenaVector<OutPt*>   m_OutPts;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
   size_t                m_OutPtsChunkLast;
 
-  std::vector<Join>     m_Joins;
-  std::vector<Join>     m_GhostJoins;
-  std::vector<IntersectNode> m_IntersectList;
+  ArenaVector<Join>     m_Joins;
+  ArenaVector<Join>     m_GhostJoins;
+  ArenaVector<IntersectNode> m_IntersectList;
   ClipType              m_ClipType;
   // A priority queue (a binary heap) of Y coordinates.
-  std::priority_queue<cInt> m_Scanbeam;
+  typedef std::priority_queue<cInt, ArenaVector<cInt>> Scanbeam;
+  Scanbeam              m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
-  std::vector<cInt>     m_Maxima;
+  ArenaVector<cInt>     m_Maxima;
   TEdge                *m_ActiveEdges;
   TEdge                *m_SortedEdges;
   PolyFillType          m_ClipFillType;
@@ -445,10 +557,16 @@ class ClipperOffset
 {
 public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
-    MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
+    MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_normals(current_arena()), m_lowest(-1, 0) {}
   ~ClipperOffset() { Clear(); }
-  void AddPath(const Path& path, JoinType joinType, EndType endType);
-  void AddPaths(const Paths& paths, JoinType joinType, EndType endType);
+  // Paths are accepted in the same form as by ClipperBase::AddPath() / AddPaths().
+  template<typename PathType>
+  void AddPath(const PathType& path, JoinType joinType, EndType endType);
+  template<typename PathsType>
+  void AddPaths(const PathsType& paths, JoinType joinType, EndType endType)
+    { for (const auto &path : paths) AddPath(path, joinType, endType); }
+  void AddPath(const Path& path, JoinType joinType, EndType endType) { AddPath<Path>(path, joinType, endType); }
+  void AddPaths(const Paths& paths, JoinType joinType, EndType endType) { AddPaths<Paths>(paths, joinType, endType); }
   void Execute(Paths& solution, double delta);
   void Execute(PolyTree& solution, double delta);
   void Clear();
@@ -459,7 +577,7 @@ private:
   Paths m_destPolys;
   Path m_srcPoly;
   Path m_destPoly;
-  std::vector<DoublePoint> m_normals;
+  ArenaVector<DoublePoint> m_normals;
   double m_delta, m_sinA, m_sin, m_cos;
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
@@ -485,6 +603,145 @@ class clipperException : public std::exception
 };
 //------------------------------------------------------------------------------
 
+template<typename PathType>
+int ClipperBase::PathHighIndex(const PathType &pg, bool Closed)
+{
+  // Remove duplicate end point from a closed input path.
+  // Remove duplicate points from the end of the input path.
+  int highI = (int)pg.size() -1;
+  if (Closed) 
+    while (highI > 0 && (PathPoint(pg[highI]) == PathPoint(pg[0]))) 
+      --highI;
+  while (highI > 0 && (PathPoint(pg[highI]) == PathPoint(pg[highI -1]))) 
+    --highI;
+  if ((Closed && highI < 2) || (!Closed && highI < 1))
+    highI = -1;
+  return highI;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathType>
+bool ClipperBase::AddPath(const PathType &pg, PolyType PolyTyp, bool Closed)
+{
+  int highI = PathHighIndex(pg, Closed);
+  if (highI < 0)
+    return false;
+
+  // Allocate a new edge array.
+  ArenaVector<TEdge> edges(highI + 1, m_arena);
+  // Fill in the edge array.
+  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
+  if (result)
+    // Success, remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathsType>
+bool ClipperBase::AddPaths(const PathsType &ppg, PolyType PolyTyp, bool Closed)
+{
+  ArenaVector<int> num_edges(m_arena);
+  int num_edges_total = 0;
+  for (const auto &pg : ppg) {
+    int highI = PathHighIndex(pg, Closed);
+    num_edges.emplace_back(highI + 1);
+    num_edges_total += highI + 1;
+  }
+  if (num_edges_total == 0)
+    return false;
+
+  // Allocate a new edge array.
+  ArenaVector<TEdge> edges(num_edges_total, m_arena);
+  // Fill in the edge array.
+  bool result = false;
+  TEdge *p_edge = edges.data();
+  size_t i = 0;
+  for (const auto &pg : ppg) {
+    if (num_edges[i]) {
+      bool res = AddPathInternal(pg, num_edges[i] - 1, PolyTyp, Closed, p_edge);
+      if (res) {
+        p_edge += num_edges[i];
+        result = true;
+      }
+    }
+    ++ i;
+  }
+  if (result)
+    // At least some edges were generated. Remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathType>
+void ClipperOffset::AddPath(const PathType& path, JoinType joinType, EndType endType)
+{
+  int highI = (int)path.size() - 1;
+  if (highI < 0) return;
+  PolyNode* newNode = new PolyNode();
+  newNode->m_jointype = joinType;
+  newNode->m_endtype = endType;
+
+  //strip duplicate points from path and also get index to the lowest point ...
+  bool   has_shortest_edge_length = ShortestEdgeLength > 0.;
+  double shortest_edge_length2 = has_shortest_edge_length ? ShortestEdgeLength * ShortestEdgeLength : 0.;
+  const IntPoint first = PathPoint(path[0]);
+  if (endType == etClosedLine || endType == etClosedPolygon)
+    for (; highI > 0; -- highI) {
+      const IntPoint last = PathPoint(path[highI]);
+      bool same = false;
+      if (has_shortest_edge_length) {
+        double dx = double(last.X - first.X);
+        double dy = double(last.Y - first.Y);
+        same = dx*dx + dy*dy < shortest_edge_length2;
+      } else
+        same = first == last;
+      if (! same)
+        break;
+    }
+  newNode->Contour.reserve(highI + 1);
+  newNode->Contour.push_back(first);
+  int j = 0, k = 0;
+  for (int i = 1; i <= highI; i++) {
+    const IntPoint pt = PathPoint(path[i]);
+    bool same = false;
+    if (has_shortest_edge_length) {
+      double dx = double(pt.X - newNode->Contour[j].X);
+      double dy = double(pt.Y - newNode->Contour[j].Y);
+      same = dx*dx + dy*dy < shortest_edge_length2;
+    } else
+      same = newNode->Contour[j] == pt;
+    if (same)
+      continue;
+    j++;
+    newNode->Contour.push_back(pt);
+    if (pt.Y > newNode->Contour[k].Y ||
+      (pt.Y == newNode->Contour[k].Y &&
+      pt.X < newNode->Contour[k].X)) k = j;
+  }
+  if (endType == etClosedPolygon && j < 2)
+  {
+    delete newNode;
+    return;
+  }
+  m_polyNodes.AddChild(*newNode);
+
+  //if this path's lowest pt is lower than all the others then update m_lowest
+  if (endType != etClosedPolygon) return;
+  if (m_lowest.X < 0)
+    m_lowest = IntPoint(m_polyNodes.ChildCount() - 1, k);
+  else
+  {
+    IntPoint ip = m_polyNodes.Childs[(int)m_lowest.X]->Contour[(int)m_lowest.Y];
+    if (newNode->Contour[k].Y > ip.Y ||
+      (newNode->Contour[k].Y == ip.Y &&
+      newNode->Contour[k].X < ip.X))
+      m_lowest = IntPoint(m_polyNodes.ChildCount() - 1, k);
+  }
+}
+//------------------------------------------------------------------------------
+
 } //ClipperLib namespace
 
 #endif //clipper_hpp
@@ -57,15 +57,6 @@ err:
 }
 #endif /* CLIPPER_UTILS_DEBUG */
 
-void scaleClipperPolygon(ClipperLib::Path &polygon)
-{
-    CLIPPERUTILS_PROFILE_FUNC();
-    for (ClipperLib::Path::iterator pit = polygon.begin(); pit != polygon.end(); ++pit) {
-        pit->X <<= CLIPPER_OFFSET_POWER_OF_2;
-        pit->Y <<= CLIPPER_OFFSET_POWER_OF_2;
-    }
-}
-
 void scaleClipperPolygons(ClipperLib::Paths &polygons)
 {
     CLIPPERUTILS_PROFILE_FUNC();
@@ -128,6 +119,7 @@ ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -136,6 +128,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -182,15 +175,6 @@ ClipperLib::Path Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
     return retval;
 }
 
-ClipperLib::Path Slic3rMultiPoint_to_ClipperPath_reversed(const Slic3r::MultiPoint &input)
-{
-    ClipperLib::Path output;
-    output.reserve(input.points.size());
-    for (Slic3r::Points::const_reverse_iterator pit = input.points.rbegin(); pit != input.points.rend(); ++pit)
-        output.emplace_back((*pit)(0), (*pit)(1));
-    return output;
-}
-
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 {
     ClipperLib::Paths retval;
@@ -249,6 +233,37 @@ ClipperLib::Paths _offset(ClipperLib::Path &&input, ClipperLib::EndType endType,
 	return _offset(std::move(paths), endType, delta, joinType, miterLimit);
 }
 
+// Same as _offset(ClipperLib::Paths &&input, ...), but ClipperOffset reads the Slic3r points in place
+// and scales them by CLIPPER_OFFSET_SCALE on the fly.
+template<typename PathsProvider>
+static ClipperLib::Paths _offset_provider(const PathsProvider &input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    // perform offset
+    ClipperLib::ClipperOffset co;
+    if (joinType == jtRound)
+        co.ArcTolerance = miterLimit;
+    else
+        co.MiterLimit = miterLimit;
+    float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
+    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+    co.AddPaths(ClipperUtils::ScaledPathsProvider<PathsProvider>(input), joinType, endType);
+    ClipperLib::Paths retval;
+    co.Execute(retval, delta_scaled);
+    
+    // unscale output
+    unscaleClipperPolygons(retval);
+    return retval;
+}
+
+ClipperLib::Paths _offset(const Slic3r::Polygon &polygon, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _offset_provider(ClipperUtils::SinglePathProvider(polygon.points), endType, delta, joinType, miterLimit); }
+ClipperLib::Paths _offset(const Slic3r::Polygons &polygons, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _offset_provider(ClipperUtils::PolygonsProvider(polygons), endType, delta, joinType, miterLimit); }
+ClipperLib::Paths _offset(const Slic3r::Polyline &polyline, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _offset_provider(ClipperUtils::SinglePathProvider(polyline.points), endType, delta, joinType, miterLimit); }
+ClipperLib::Paths _offset(const Slic3r::Polylines &polylines, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _offset_provider(ClipperUtils::PolylinesProvider(polylines), endType, delta, joinType, miterLimit); }
+
 // This is a safe variant of the polygon offset, tailored for a single ExPolygon:
 // a single polygon with multiple non-overlapping holes.
 // Each contour and hole is offsetted separately, then the holes are subtracted from the outer contours.
@@ -260,15 +275,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     const float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
     ClipperLib::Paths contours;
     {
-        ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(expolygon.contour);
-        scaleClipperPolygon(input);
         ClipperLib::ClipperOffset co;
         if (joinType == jtRound)
             co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
         else
             co.MiterLimit = miterLimit;
         co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-        co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        co.AddPath(ClipperUtils::ScaledPath(expolygon.contour.points), joinType, ClipperLib::etClosedPolygon);
         co.Execute(contours, delta_scaled);
     }
 
@@ -277,15 +290,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     {
         holes.reserve(expolygon.holes.size());
         for (Polygons::const_iterator it_hole = expolygon.holes.begin(); it_hole != expolygon.holes.end(); ++ it_hole) {
-            ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
-            scaleClipperPolygon(input);
             ClipperLib::ClipperOffset co;
             if (joinType == jtRound)
                 co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
                 co.MiterLimit = miterLimit;
             co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co.AddPath(ClipperUtils::ScaledPath(it_hole->points, true), joinType, ClipperLib::etClosedPolygon);
             ClipperLib::Paths out;
             co.Execute(out, - delta_scaled);
             holes.insert(holes.end(), out.begin(), out.end());
@@ -309,94 +320,87 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     return output;
 }
 
+// Offsets a single contour or a reversed hole the same way as _offset(const ExPolygon&, ...) does.
+ClipperLib::Paths ExPolygonsOffsetter::offset_path(const Points &points, bool hole, const float delta_scaled) const
+{
+    ClipperLib::ClipperOffset co;
+    if (m_joinType == jtRound)
+        co.ArcTolerance = m_miterLimit * double(CLIPPER_OFFSET_SCALE);
+    else
+        co.MiterLimit = m_miterLimit;
+    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+    co.AddPath(ClipperUtils::ScaledPath(points, hole), m_joinType, ClipperLib::etClosedPolygon);
+    ClipperLib::Paths out;
+    co.Execute(out, delta_scaled);
+    return out;
+}
+
+// Offsets the outer contour by delta_scaled, the holes one by one by -delta_scaled.
+// The holes are not offsetted if the contour vanished. Returns false if the contour vanished.
+bool ExPolygonsOffsetter::offset_scaled(const ExPolygon &expoly, const float delta_scaled, ClipperLib::Paths &contours, ClipperLib::Paths &holes) const
+{
+    contours = this->offset_path(expoly.contour.points, false, delta_scaled);
+    holes.clear();
+    if (contours.empty())
+        // No need to try to offset the holes.
+        return false;
+    for (const Polygon &hole : expoly.holes) {
+        ClipperLib::Paths out = this->offset_path(hole.points, true, - delta_scaled);
+        holes.insert(holes.end(), out.begin(), out.end());
+    }
+    return true;
+}
+
 // This is a safe variant of the polygons offset, tailored for multiple ExPolygons.
 // It is required, that the input expolygons do not overlap and that the holes of each ExPolygon don't intersect with their respective outer contours.
 // Each ExPolygon is offsetted separately, then the offsetted ExPolygons are united.
-ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delta,
-    ClipperLib::JoinType joinType, double miterLimit)
+ClipperLib::Paths ExPolygonsOffsetter::offset_paths(const float delta) const
 {
     const float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
     // Offsetted ExPolygons before they are united.
     ClipperLib::Paths contours_cummulative;
-    contours_cummulative.reserve(expolygons.size());
+    contours_cummulative.reserve(m_expolygons.size());
     // How many non-empty offsetted expolygons were actually collected into contours_cummulative?
     // If only one, then there is no need to do a final union.
     size_t expolygons_collected = 0;
-    for (Slic3r::ExPolygons::const_iterator it_expoly = expolygons.begin(); it_expoly != expolygons.end(); ++ it_expoly) {
-        // 1) Offset the outer contour.
-        ClipperLib::Paths contours;
-        {
-            ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(it_expoly->contour);
-            scaleClipperPolygon(input);
-            ClipperLib::ClipperOffset co;
-            if (joinType == jtRound)
-                co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
-            else
-                co.MiterLimit = miterLimit;
-            co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-            co.Execute(contours, delta_scaled);
-        }
-        if (contours.empty())
-            // No need to try to offset the holes.
+    ClipperLib::Paths contours;
+    ClipperLib::Paths holes;
+    for (const ExPolygon &expoly : m_expolygons) {
+        // 1) Offset the outer contour, 2) offset the holes one by one, collect the offsetted holes.
+        if (! this->offset_scaled(expoly, delta_scaled, contours, holes))
             continue;
 
-        if (it_expoly->holes.empty()) {
-            // No need to subtract holes from the offsetted expolygon, we are done.
+        // 3) Subtract holes from the contours.
+        if (holes.empty()) {
+            // No hole remaining after an offset. Just copy the outer contour.
             contours_cummulative.insert(contours_cummulative.end(), contours.begin(), contours.end());
             ++ expolygons_collected;
-        } else {
-            // 2) Offset the holes one by one, collect the offsetted holes.
-            ClipperLib::Paths holes;
-            {
-                for (Polygons::const_iterator it_hole = it_expoly->holes.begin(); it_hole != it_expoly->holes.end(); ++ it_hole) {
-                    ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
-                    scaleClipperPolygon(input);
-                    ClipperLib::ClipperOffset co;
-                    if (joinType == jtRound)
-                        co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
-                    else
-                        co.MiterLimit = miterLimit;
-                    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-                    co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-                    ClipperLib::Paths out;
-                    co.Execute(out, - delta_scaled);
-                    holes.insert(holes.end(), out.begin(), out.end());
-                }
-            }
-
-            // 3) Subtract holes from the contours.
-            if (holes.empty()) {
-                // No hole remaining after an offset. Just copy the outer contour.
-                contours_cummulative.insert(contours_cummulative.end(), contours.begin(), contours.end());
+        } else if (delta < 0) {
+            // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
+            // Subtract the offsetted holes from the offsetted contours.
+            ClipperLib::Clipper clipper;
+            clipper.Clear();
+            clipper.AddPaths(contours, ClipperLib::ptSubject, true);
+            clipper.AddPaths(holes, ClipperLib::ptClip, true);
+            ClipperLib::Paths output;
+            clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            if (! output.empty()) {
+                contours_cummulative.insert(contours_cummulative.end(), output.begin(), output.end());
                 ++ expolygons_collected;
-            } else if (delta < 0) {
-                // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
-                // Subtract the offsetted holes from the offsetted contours.
-                ClipperLib::Clipper clipper;
-                clipper.Clear();
-                clipper.AddPaths(contours, ClipperLib::ptSubject, true);
-                clipper.AddPaths(holes, ClipperLib::ptClip, true);
-                ClipperLib::Paths output;
-                clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
-                if (! output.empty()) {
-                    contours_cummulative.insert(contours_cummulative.end(), output.begin(), output.end());
-                    ++ expolygons_collected;
-                } else {
-                    // The offsetted holes have eaten up the offsetted outer contour.
-                }
             } else {
-                // Positive offset. As long as the Clipper offset does what one expects it to do, the offsetted hole will have a smaller
-                // area than the original hole or even disappear, therefore there will be no new intersections.
-                // Just collect the reversed holes.
-                contours_cummulative.reserve(contours.size() + holes.size());
-                contours_cummulative.insert(contours_cummulative.end(), contours.begin(), contours.end());
-                // Reverse the holes in place.
-                for (size_t i = 0; i < holes.size(); ++ i)
-                    std::reverse(holes[i].begin(), holes[i].end());
-                contours_cummulative.insert(contours_cummulative.end(), holes.begin(), holes.end());
-                ++ expolygons_collected;
+                // The offsetted holes have eaten up the offsetted outer contour.
             }
+        } else {
+            // Positive offset. As long as the Clipper offset does what one expects it to do, the offsetted hole will have a smaller
+            // area than the original hole or even disappear, therefore there will be no new intersections.
+            // Just collect the reversed holes.
+            contours_cummulative.reserve(contours.size() + holes.size());
+            contours_cummulative.insert(contours_cummulative.end(), contours.begin(), contours.end());
+            // Reverse the holes in place.
+            for (size_t i = 0; i < holes.size(); ++ i)
+                std::reverse(holes[i].begin(), holes[i].end());
+            contours_cummulative.insert(contours_cummulative.end(), holes.begin(), holes.end());
+            ++ expolygons_collected;
         }
     }
 
@@ -418,16 +422,42 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
     return output;
 }
 
+// Each ExPolygon is offsetted by delta1 the same way as by offset_ex(const ExPolygon&), then by delta2, the results are united.
+ExPolygons ExPolygonsOffsetter::offset2_ex(const float delta1, const float delta2) const
+{
+    const float delta_scaled = delta1 * float(CLIPPER_OFFSET_SCALE);
+    Polygons polys;
+    ClipperLib::Paths contours;
+    ClipperLib::Paths holes;
+    for (const ExPolygon &expoly : m_expolygons) {
+        this->offset_scaled(expoly, delta_scaled, contours, holes);
+        // Subtract holes from the contours.
+        ClipperLib::Paths output;
+        if (holes.empty()) {
+            output = std::move(contours);
+        } else {
+            ClipperLib::Clipper clipper;
+            clipper.Clear();
+            clipper.AddPaths(contours, ClipperLib::ptSubject, true);
+            clipper.AddPaths(holes, ClipperLib::ptClip, true);
+            clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        }
+        unscaleClipperPolygons(output);
+        append(polys, Slic3r::offset(ClipperPaths_to_Slic3rExPolygons(output), delta2, m_joinType, m_miterLimit));
+    }
+    return union_ex(polys);
+}
+
+ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delta,
+    ClipperLib::JoinType joinType, double miterLimit)
+{
+    return ExPolygonsOffsetter(expolygons, joinType, miterLimit).offset_paths(delta);
+}
+
 ClipperLib::Paths
 _offset2(const Polygons &polygons, const float delta1, const float delta2,
     const ClipperLib::JoinType joinType, const double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
-    // scale input
-    scaleClipperPolygons(input);
-    
     // prepare ClipperOffset object
     ClipperLib::ClipperOffset co;
     if (joinType == jtRound) {
@@ -441,7 +471,7 @@ _offset2(const Polygons &polygons, const float delta1, const float delta2,
     
     // perform first offset
     ClipperLib::Paths output1;
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
+    co.AddPaths(ClipperUtils::ScaledPathsProvider<ClipperUtils::PolygonsProvider>(polygons), joinType, ClipperLib::etClosedPolygon);
     co.Execute(output1, delta_scaled1);
     
     // perform second offset
@@ -477,46 +507,63 @@ offset2_ex(const Polygons &polygons, const float delta1, const float delta2,
     return ClipperPaths_to_Slic3rExPolygons(output);
 }
 
-//FIXME Vojtech: This functon may likely be optimized to avoid some of the Slic3r to Clipper 
-// conversions and unnecessary Clipper calls.
 ExPolygons offset2_ex(const ExPolygons &expolygons, const float delta1,
     const float delta2, ClipperLib::JoinType joinType, double miterLimit)
 {
-    Polygons polys;
-    for (const ExPolygon &expoly : expolygons)
-        append(polys, 
-               offset(offset_ex(expoly, delta1, joinType, miterLimit), 
-                      delta2, joinType, miterLimit));
-    return union_ex(polys);
+    return ExPolygonsOffsetter(expolygons, joinType, miterLimit).offset2_ex(delta1, delta2);
 }
 
-template<class T, class TSubj, class TClip>
+// Adds the subject and clip paths to Clipper. Clipper reads the Slic3r points in place,
+// only the paths to be safety offsetted are converted to ClipperLib::Paths.
+template<class TSubjProvider, class TClipProvider>
+static void _clipper_add_paths(
+    ClipperLib::Clipper            &clipper,
+    const TSubjProvider            &subject,
+    const bool                      subject_closed,
+    const bool                      safety_offset_subject,
+    const TClipProvider            &clip,
+    const bool                      safety_offset_clip)
+{
+    auto to_paths = [](const auto &provider) {
+        ClipperLib::Paths paths;
+        paths.reserve(provider.size());
+        for (const Points &points : provider) {
+            paths.emplace_back();
+            paths.back().reserve(points.size());
+            for (const Point &pt : points)
+                paths.back().emplace_back(pt.x(), pt.y());
+        }
+        return paths;
+    };
+    if (safety_offset_subject) {
+        ClipperLib::Paths input_subject = to_paths(subject);
+        safety_offset(&input_subject);
+        clipper.AddPaths(input_subject, ClipperLib::ptSubject, subject_closed);
+    } else
+        clipper.AddPaths(subject, ClipperLib::ptSubject, subject_closed);
+    if (safety_offset_clip) {
+        ClipperLib::Paths input_clip = to_paths(clip);
+        safety_offset(&input_clip);
+        clipper.AddPaths(input_clip, ClipperLib::ptClip, true);
+    } else
+        clipper.AddPaths(clip, ClipperLib::ptClip, true);
+}
+
+template<class T, class TSubjProvider, class TClipProvider>
 T _clipper_do(const ClipperLib::ClipType     clipType,
-              TSubj &&                        subject,
-              TClip &&                        clip,
+              const TSubjProvider           &subject,
+              const TClipProvider           &clip,
               const ClipperLib::PolyFillType fillType,
               const bool                     safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(std::forward<TSubj>(subject));
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(std::forward<TClip>(clip));
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
     // init Clipper
     ClipperLib::Clipper clipper;
     clipper.Clear();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    // perform safety offset of the subject for union, of the clip polygons otherwise
+    bool union_ = clipType == ClipperLib::ctUnion;
+    _clipper_add_paths(clipper, subject, true, safety_offset_ && union_, clip, safety_offset_ && ! union_);
     
     // perform operation
     T retval;
@@ -531,27 +578,22 @@ T _clipper_do(const ClipperLib::ClipType     clipType,
 // This function implmenets a following workaround:
 // 1) Peform the Clipper operation with the output to Paths. This method handles overlaps in a reasonable time.
 // 2) Run Clipper Union once again to extract the PolyTree from the result of 1).
-inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+template<class TSubjProvider, class TClipProvider>
+inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const TSubjProvider &subject, 
+    const TClipProvider &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_)
-        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
-    
     ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    // perform safety offset of the subject for union, of the clip polygons otherwise
+    bool union_ = clipType == ClipperLib::ctUnion;
+    _clipper_add_paths(clipper, subject, true, safety_offset_ && union_, clip, safety_offset_ && ! union_);
     // Perform the operation with the output to input_subject.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    ClipperLib::Paths output;
+    clipper.Execute(clipType, output, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
     clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(output, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
@@ -561,20 +603,12 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
     const Polygons &clip, const ClipperLib::PolyFillType fillType,
     const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) safety_offset(&input_clip);
-    
     // init Clipper
     ClipperLib::Clipper clipper;
     clipper.Clear();
     
-    // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    // add polygons, perform safety offset of the clip polygons
+    _clipper_add_paths(clipper, ClipperUtils::PolylinesProvider(subject), false, false, ClipperUtils::PolygonsProvider(clip), safety_offset_);
     
     // perform operation
     ClipperLib::PolyTree retval;
@@ -584,12 +618,27 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
 
 Polygons _clipper(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
 {
-    return ClipperPaths_to_Slic3rPolygons(_clipper_do<ClipperLib::Paths>(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_));
+    return ClipperPaths_to_Slic3rPolygons(_clipper_do<ClipperLib::Paths>(
+        clipType, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_));
+}
+
+Polygons _clipper(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    return ClipperPaths_to_Slic3rPolygons(_clipper_do<ClipperLib::Paths>(
+        clipType, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::ExPolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_));
 }
 
 ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
 {
-    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(
+        clipType, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_);
+    return PolyTreeToExPolygons(polytree);
+}
+
+ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(
+        clipType, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::ExPolygonsProvider(clip), ClipperLib::pftNonZero, safety_offset_);
     return PolyTreeToExPolygons(polytree);
 }
 
@@ -670,22 +719,22 @@ _clipper_ln(ClipperLib::ClipType clipType, const Lines &subject, const Polygons
 
 ClipperLib::PolyTree union_pt(const Polygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, ClipperUtils::PolygonsProvider(subject), ClipperUtils::PolygonsProvider(Polygons()), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(const ExPolygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(Polygons()), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(Polygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return union_pt(static_cast<const Polygons&>(subject), safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(ExPolygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return union_pt(static_cast<const ExPolygons&>(subject), safety_offset_);
 }
 
 // Simple spatial ordering of Polynodes
@@ -759,18 +808,15 @@ Polygons union_pt_chained(const Polygons &subject, bool safety_offset_)
 
 Polygons simplify_polygons(const Polygons &subject, bool preserve_collinear)
 {
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::Paths output;
     if (preserve_collinear) {
         ClipperLib::Clipper c;
         c.PreserveCollinear(true);
         c.StrictlySimple(true);
-        c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+        c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
         c.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     } else {
-        ClipperLib::SimplifyPolygons(input_subject, output, ClipperLib::pftNonZero);
+        ClipperLib::SimplifyPolygons(Slic3rMultiPoints_to_ClipperPaths(subject), output, ClipperLib::pftNonZero);
     }
     
     // convert into Slic3r polygons
@@ -782,15 +828,12 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
     if (! preserve_collinear)
         return union_ex(simplify_polygons(subject, false));
 
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::PolyTree polytree;
     
     ClipperLib::Clipper c;
     c.PreserveCollinear(true);
     c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
     c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
@@ -852,7 +895,7 @@ Polygons top_level_islands(const Slic3r::Polygons &polygons)
     ClipperLib::Clipper clipper;
     clipper.Clear();
     // perform union
-    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::ptSubject, true);
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(polygons), ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
     clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
     // Convert only the top level islands to the output.
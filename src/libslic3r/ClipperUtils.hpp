@@ -1,6 +1,8 @@
 #ifndef slic3r_ClipperUtils_hpp_
 #define slic3r_ClipperUtils_hpp_
 
+#include <memory>
+
 #include "libslic3r.h"
 #include "clipper.hpp"
 #include "ExPolygon.hpp"
@@ -26,6 +28,103 @@ using ClipperLib::jtSquare;
 
 namespace Slic3r {
 
+namespace ClipperUtils {
+    // Providers of Slic3r paths to ClipperLib::Clipper::AddPaths() and ClipperLib::ClipperOffset::AddPaths().
+    // ClipperLib reads the Slic3r::Points in place through ClipperLib::PathPoint(), thus the input polygons
+    // do not need to be converted to ClipperLib::Paths first. Iterating over a provider yields const Points&.
+    class SinglePathProvider {
+    public:
+        SinglePathProvider(const Points &points) : m_points(points) {}
+        const Points* begin() const { return &m_points; }
+        const Points* end()   const { return &m_points + 1; }
+        size_t        size()  const { return 1; }
+    private:
+        const Points &m_points;
+    };
+
+    template<typename MultiPointType>
+    class MultiPointsProvider {
+    public:
+        MultiPointsProvider(const std::vector<MultiPointType> &multipoints) : m_multipoints(multipoints) {}
+        class iterator {
+        public:
+            using base_iterator = typename std::vector<MultiPointType>::const_iterator;
+            explicit iterator(base_iterator it) : m_it(it) {}
+            const Points& operator*() const { return m_it->points; }
+            iterator&     operator++() { ++ m_it; return *this; }
+            bool          operator!=(const iterator &rhs) const { return m_it != rhs.m_it; }
+        private:
+            base_iterator m_it;
+        };
+        iterator begin() const { return iterator(m_multipoints.begin()); }
+        iterator end()   const { return iterator(m_multipoints.end()); }
+        size_t   size()  const { return m_multipoints.size(); }
+    private:
+        const std::vector<MultiPointType> &m_multipoints;
+    };
+    using PolygonsProvider  = MultiPointsProvider<Polygon>;
+    using PolylinesProvider = MultiPointsProvider<Polyline>;
+
+    // Contour of each ExPolygon followed by its holes, in the order of to_polygons(const ExPolygons&).
+    class ExPolygonsProvider {
+    public:
+        ExPolygonsProvider(const ExPolygons &expolygons) : m_expolygons(expolygons) {}
+        class iterator {
+        public:
+            explicit iterator(ExPolygons::const_iterator it) : m_it(it), m_idx(0) {}
+            const Points& operator*() const { return m_idx == 0 ? m_it->contour.points : m_it->holes[m_idx - 1].points; }
+            iterator&     operator++() { if (m_idx == m_it->holes.size()) { ++ m_it; m_idx = 0; } else ++ m_idx; return *this; }
+            bool          operator!=(const iterator &rhs) const { return m_it != rhs.m_it || m_idx != rhs.m_idx; }
+        private:
+            ExPolygons::const_iterator m_it;
+            // 0 for the contour, hole index + 1 for a hole.
+            size_t                     m_idx;
+        };
+        iterator begin() const { return iterator(m_expolygons.begin()); }
+        iterator end()   const { return iterator(m_expolygons.end()); }
+        size_t   size()  const { return number_polygons(m_expolygons); }
+    private:
+        const ExPolygons &m_expolygons;
+    };
+
+    // Path scaled up by CLIPPER_OFFSET_SCALE while being read by ClipperLib::ClipperOffset, optionally reversed.
+    // Replaces the conversion to ClipperLib::Path followed by scaling of the converted path in place.
+    class ScaledPath {
+    public:
+        ScaledPath(const Points &points, bool reversed = false) : m_points(points), m_reversed(reversed) {}
+        size_t size() const { return m_points.size(); }
+        ClipperLib::IntPoint operator[](size_t idx) const {
+            const Point &pt = m_points[m_reversed ? m_points.size() - 1 - idx : idx];
+            return ClipperLib::IntPoint(ClipperLib::cInt(pt.x()) << CLIPPER_OFFSET_POWER_OF_2, ClipperLib::cInt(pt.y()) << CLIPPER_OFFSET_POWER_OF_2);
+        }
+    private:
+        const Points &m_points;
+        bool          m_reversed;
+    };
+
+    // Paths of another provider scaled up by CLIPPER_OFFSET_SCALE, see ScaledPath.
+    template<typename PathsProvider>
+    class ScaledPathsProvider {
+    public:
+        ScaledPathsProvider(const PathsProvider &paths) : m_paths(paths) {}
+        class iterator {
+        public:
+            using base_iterator = decltype(std::declval<const PathsProvider&>().begin());
+            explicit iterator(base_iterator it) : m_it(it) {}
+            ScaledPath operator*() const { return ScaledPath(*m_it); }
+            iterator&  operator++() { ++ m_it; return *this; }
+            bool       operator!=(const iterator &rhs) const { return m_it != rhs.m_it; }
+        private:
+            base_iterator m_it;
+        };
+        iterator begin() const { return iterator(m_paths.begin()); }
+        iterator end()   const { return iterator(m_paths.end()); }
+        size_t   size()  const { return m_paths.size(); }
+    private:
+        const PathsProvider &m_paths;
+    };
+}
+
 //-----------------------------------------------------------
 // legacy code from Clipper documentation
 void AddOuterPolyNodeToExPolygons(ClipperLib::PolyNode& polynode, Slic3r::ExPolygons *expolygons);
@@ -45,16 +144,21 @@ Slic3r::ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &inp
 // offset Polygons
 ClipperLib::Paths _offset(ClipperLib::Path &&input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
 ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+// Same as above, the input is read by Clipper in place, scaled on the fly.
+ClipperLib::Paths _offset(const Slic3r::Polygon &polygon, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+ClipperLib::Paths _offset(const Slic3r::Polygons &polygons, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+ClipperLib::Paths _offset(const Slic3r::Polyline &polyline, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+ClipperLib::Paths _offset(const Slic3r::Polylines &polylines, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
 inline Slic3r::Polygons offset(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter,  double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polygon), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polygon, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 inline Slic3r::Polygons offset(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polygons, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 
 // offset Polylines
 inline Slic3r::Polygons offset(const Slic3r::Polyline &polyline, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtSquare, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polyline), ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polyline, ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
 inline Slic3r::Polygons offset(const Slic3r::Polylines &polylines, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtSquare, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polylines), ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polylines, ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
 
 // offset expolygons and surfaces
 ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit);
@@ -64,9 +168,9 @@ inline Slic3r::Polygons offset(const Slic3r::ExPolygon &expolygon, const float d
 inline Slic3r::Polygons offset(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
     { return ClipperPaths_to_Slic3rPolygons(_offset(expolygons, delta, joinType, miterLimit)); }
 inline Slic3r::ExPolygons offset_ex(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rExPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polygon), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }    
+    { return ClipperPaths_to_Slic3rExPolygons(_offset(polygon, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }    
 inline Slic3r::ExPolygons offset_ex(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rExPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rExPolygons(_offset(polygons, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 inline Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
     { return ClipperPaths_to_Slic3rExPolygons(_offset(expolygon, delta, joinType, miterLimit)); }
 inline Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
@@ -85,10 +189,40 @@ Slic3r::ExPolygons offset2_ex(const Slic3r::ExPolygons &expolygons, const float
     const float delta2, ClipperLib::JoinType joinType = ClipperLib::jtMiter, 
     double miterLimit = 3);
 
+// Offsetting of the same ExPolygons by multiple deltas, for example to produce the successive perimeter shells
+// together with the gaps between them. The ExPolygons are referenced, not copied, thus they have to outlive
+// the offsetter and each offset reads their current content. Each offset loads the contours and holes into ClipperOffset
+// scaled on the fly, with ShortestEdgeLength derived from its own delta, therefore the results are the same
+// as of offset(), offset_ex() and offset2_ex() over the ExPolygons.
+class ExPolygonsOffsetter
+{
+public:
+    ExPolygonsOffsetter(const Slic3r::ExPolygons &expolygons, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3) :
+        m_expolygons(expolygons), m_joinType(joinType), m_miterLimit(miterLimit) {}
+
+    size_t              size() const { return m_expolygons.size(); }
+    ClipperLib::Paths   offset_paths(const float delta) const;
+    Slic3r::Polygons    offset(const float delta) const { return ClipperPaths_to_Slic3rPolygons(this->offset_paths(delta)); }
+    Slic3r::ExPolygons  offset_ex(const float delta) const { return ClipperPaths_to_Slic3rExPolygons(this->offset_paths(delta)); }
+    Slic3r::ExPolygons  offset2_ex(const float delta1, const float delta2) const;
+
+private:
+    ClipperLib::Paths   offset_path(const Slic3r::Points &points, bool hole, const float delta_scaled) const;
+    bool                offset_scaled(const Slic3r::ExPolygon &expoly, const float delta_scaled, ClipperLib::Paths &contours, ClipperLib::Paths &holes) const;
+
+    const Slic3r::ExPolygons       &m_expolygons;
+    ClipperLib::JoinType            m_joinType;
+    double                          m_miterLimit;
+};
+
 Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
 Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
     const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
@@ -112,13 +246,13 @@ diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safe
 inline Slic3r::ExPolygons
 diff_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 diff(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -155,13 +289,13 @@ intersection_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, b
 inline Slic3r::ExPolygons
 intersection_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 intersection(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -206,7 +340,7 @@ inline Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, bool safety_
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctUnion, to_polygons(subject), Slic3r::Polygons(), safety_offset_);
+    return _clipper_ex(ClipperLib::ctUnion, subject, Slic3r::ExPolygons(), safety_offset_);
 }
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject, bool safety_offset_ = false)
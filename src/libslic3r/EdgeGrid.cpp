@@ -33,7 +33,9 @@ EdgeGrid::Grid::Grid() :
 EdgeGrid::Grid::~Grid() 
 {
 	m_contours.clear();
-	m_cell_data.clear();
+	m_contour_points.clear();
+	m_contour_offsets.clear();
+	m_cell_segments.clear();
 	m_cells.clear();
 }
 
@@ -281,7 +283,7 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 		}
 	}
 
-	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
+	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_segments.
 	size_t cnt = m_cells.front().end;
 	for (size_t i = 1; i < m_cells.size(); ++ i) {
 		m_cells[i].begin = cnt;
@@ -290,28 +292,48 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	}
 
 	// 5) Allocate the cell data.
-	m_cell_data.assign(cnt, std::pair<size_t, size_t>(size_t(-1), size_t(-1)));
+	assert(cnt < std::numeric_limits<uint32_t>::max());
+	m_cell_segments.assign(cnt, uint32_t(-1));
 
-	// 6) Finally fill in m_cell_data by rasterizing the lines once again.
+	// Copy the contours into m_contour_points, each contour extended by its last point at the start and by its first point at the end.
+	m_contour_offsets.assign(m_contours.size(), 0);
+	{
+		size_t npoints = 0;
+		for (const Slic3r::Points *pts : m_contours)
+			npoints += pts->size() + 2;
+		assert(npoints < std::numeric_limits<uint32_t>::max());
+		m_contour_points.clear();
+		m_contour_points.reserve(npoints);
+		for (size_t i = 0; i < m_contours.size(); ++ i) {
+			const Slic3r::Points &pts = *m_contours[i];
+			m_contour_points.emplace_back(pts.back());
+			m_contour_offsets[i] = uint32_t(m_contour_points.size());
+			m_contour_points.insert(m_contour_points.end(), pts.begin(), pts.end());
+			m_contour_points.emplace_back(pts.front());
+		}
+	}
+
+	// 6) Finally fill in m_cell_segments by rasterizing the lines once again.
 	for (size_t i = 0; i < m_cells.size(); ++i)
 		m_cells[i].end = m_cells[i].begin;
 
 	struct Visitor {
-		Visitor(std::vector<std::pair<size_t, size_t>> &cell_data, std::vector<Cell> &cells, size_t cols) :
-			cell_data(cell_data), cells(cells), cols(cols), i(0), j(0) {}
+		Visitor(std::vector<uint32_t> &cell_segments, const std::vector<uint32_t> &contour_offsets, std::vector<Cell> &cells, size_t cols) :
+			cell_segments(cell_segments), contour_offsets(contour_offsets), cells(cells), cols(cols), i(0), j(0) {}
 
 		inline bool operator()(coord_t iy, coord_t ix) {
-			cell_data[cells[iy*cols + ix].end++] = std::pair<size_t, size_t>(i, j);
+			cell_segments[cells[iy*cols + ix].end++] = contour_offsets[i] + uint32_t(j);
 			// Continue traversing the grid along the edge.
 			return true;
 		}
 
-		std::vector<std::pair<size_t, size_t>> &cell_data;
+		std::vector<uint32_t>				   &cell_segments;
+		const std::vector<uint32_t>			   &contour_offsets;
 		std::vector<Cell> 					   &cells;
 		size_t									cols;
 		size_t 									i;
 		size_t 									j;
-	} visitor(m_cell_data, m_cells, m_cols);
+	} visitor(m_cell_segments, m_contour_offsets, m_cells, m_cols);
 
 	assert(visitor.i == 0);
 	for (; visitor.i < m_contours.size(); ++ visitor.i) {
@@ -476,17 +498,10 @@ bool EdgeGrid::Grid::line_cell_intersect(const Point &p1a, const Point &p2a, con
 	int64_t va_x = p2a(0) - p1a(0);
 	int64_t va_y = p2a(1) - p1a(1);
 	for (size_t i = cell.begin; i != cell.end; ++ i) {
-		const std::pair<size_t, size_t> &cell_data = m_cell_data[i];
-		// Contour indexed by the ith line of this cell.
-		const Slic3r::Points &contour = *m_contours[cell_data.first];
-		// Point indices in contour indexed by the ith line of this cell.
-		size_t idx1 = cell_data.second;
-		size_t idx2 = idx1 + 1;
-		if (idx2 == contour.size())
-			idx2 = 0;
 		// The points of the ith line of this cell and its bounding box.
-		const Point &p1b = contour[idx1];
-		const Point &p2b = contour[idx2];
+		const Slic3r::Point *pts = this->segment_points(i);
+		const Point &p1b = pts[0];
+		const Point &p2b = pts[1];
 		BoundingBox bbox2(p1b, p1b);
 		bbox2.merge(p2b);
 		// Do the bounding boxes intersect?
@@ -541,16 +556,9 @@ bool EdgeGrid::Grid::inside(const Point &pt_src)
 		// Hit in the first cell?
 		const Cell &cell = m_cells[iy * m_cols + ix];
 		for (size_t i = cell.begin; i != cell.end; ++ i) {
-			const std::pair<size_t, size_t> &cell_data = m_cell_data[i];
-			// Contour indexed by the ith line of this cell.
-			const Slic3r::Points &contour = *m_contours[cell_data.first];
-			// Point indices in contour indexed by the ith line of this cell.
-			size_t idx1 = cell_data.second;
-			size_t idx2 = idx1 + 1;
-			if (idx2 == contour.size())
-				idx2 = 0;
-			const Point &p1 = contour[idx1];
-			const Point &p2 = contour[idx2];
+			const Slic3r::Point *pts = this->segment_points(i);
+			const Point &p1 = pts[0];
+			const Point &p2 = pts[1];
 			if (p1(1) < p2(1)) {
 				if (p(1) < p1(1) || p(1) > p2(1))
 					continue;
@@ -569,12 +577,7 @@ bool EdgeGrid::Grid::inside(const Point &pt_src)
 						// On the segment.
 						return true;
 					// Before or after the segment.
-					size_t idx0 = idx1 - 1;
-					size_t idx2 = idx1 + 1;
-					if (idx0 == (size_t)-1)
-						idx0 = contour.size() - 1;
-					if (idx2 == contour.size())
-						idx2 = 0;
+					const Point &p0 = pts[-1];
 				}
 			}
 		}
@@ -678,11 +681,10 @@ void EdgeGrid::Grid::calculate_sdf()
 			const Cell &cell = m_cells[r * m_cols + c];
 			// For each segment in the cell:
 			for (size_t i = cell.begin; i != cell.end; ++ i) {
-				const Slic3r::Points &pts = *m_contours[m_cell_data[i].first];
-				size_t ipt = m_cell_data[i].second;
+				const Slic3r::Point *pts = this->segment_points(i);
 				// End points of the line segment.
-				const Slic3r::Point &p1 = pts[ipt];
-				const Slic3r::Point &p2 = pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1];
+				const Slic3r::Point &p1 = pts[0];
+				const Slic3r::Point &p2 = pts[1];
 				// Segment vector
 				const Slic3r::Point v_seg = p2 - p1;
 				// l2 of v_seg
@@ -706,7 +708,7 @@ void EdgeGrid::Grid::calculate_sdf()
 							double dabs = sqrt(int64_t(v_pt(0)) * int64_t(v_pt(0)) + int64_t(v_pt(1)) * int64_t(v_pt(1)));
 							if (dabs < d_min) {
 								// Previous point.
-								const Slic3r::Point &p0 = pts[(ipt == 0) ? (pts.size() - 1) : ipt - 1];
+								const Slic3r::Point &p0 = pts[-1];
 								Slic3r::Point v_seg_prev = p1 - p0;
 								int64_t t2_pt = int64_t(v_seg_prev(0)) * int64_t(v_pt(0)) + int64_t(v_seg_prev(1)) * int64_t(v_pt(1));
 								if (t2_pt > 0) {
@@ -1076,16 +1078,16 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point(const Point &pt
 	// Signum of the distance field at pt.
 	int sign_min = 0;
 	double l2_seg_min = 1.;
+	// Index of the closest segment in m_cell_segments.
+	size_t i_closest = size_t(-1);
 	for (int r = bbox.min(1); r <= bbox.max(1); ++ r) {
 		for (int c = bbox.min(0); c <= bbox.max(0); ++ c) {
 			const Cell &cell = m_cells[r * m_cols + c];
 			for (size_t i = cell.begin; i < cell.end; ++ i) {
-				const size_t          contour_idx = m_cell_data[i].first;
-				const Slic3r::Points &pts         = *m_contours[contour_idx];
-				size_t ipt = m_cell_data[i].second;
+				const Slic3r::Point *pts = this->segment_points(i);
 				// End points of the line segment.
-				const Slic3r::Point &p1 = pts[ipt];
-				const Slic3r::Point &p2 = pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1];
+				const Slic3r::Point &p1 = pts[0];
+				const Slic3r::Point &p2 = pts[1];
 				const Slic3r::Point v_seg = p2 - p1;
 				const Slic3r::Point v_pt  = pt - p1;
 				// dot(p2-p1, pt-p1)
@@ -1097,7 +1099,7 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point(const Point &pt
 					double dabs = sqrt(int64_t(v_pt(0)) * int64_t(v_pt(0)) + int64_t(v_pt(1)) * int64_t(v_pt(1)));
 					if (dabs < d_min) {
 						// Previous point.
-						const Slic3r::Point &p0 = pts[(ipt == 0) ? (pts.size() - 1) : ipt - 1];
+						const Slic3r::Point &p0 = pts[-1];
 						Slic3r::Point v_seg_prev = p1 - p0;
 						int64_t t2_pt = int64_t(v_seg_prev(0)) * int64_t(v_pt(0)) + int64_t(v_seg_prev(1)) * int64_t(v_pt(1));
 						if (t2_pt > 0) {
@@ -1107,8 +1109,7 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point(const Point &pt
 							int64_t det = int64_t(v_seg_prev(0)) * int64_t(v_seg(1)) - int64_t(v_seg_prev(1)) * int64_t(v_seg(0));
 							assert(det != 0);
 							sign_min = (det > 0) ? 1 : -1;
-							result.contour_idx = contour_idx;
-							result.start_point_idx = ipt;
+							i_closest = i;
 							result.t = 0.;
 #ifndef NDEBUG
 							Vec2d vfoot = (p1 - pt).cast<double>();
@@ -1132,8 +1133,7 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point(const Point &pt
 						d_min = dabs;
 						sign_min = (d_seg < 0) ? -1 : ((d_seg == 0) ? 0 : 1);
 						l2_seg_min = l2_seg;
-						result.contour_idx = contour_idx;
-						result.start_point_idx = ipt;
+						i_closest = i;
 						result.t = t_pt;
 #ifndef NDEBUG
 						Vec2d foot = p1.cast<double>() * (1. - result.t / l2_seg_min) + p2.cast<double>() * (result.t / l2_seg_min);
@@ -1147,7 +1147,10 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point(const Point &pt
 			}
 		}
 	}
-    if (result.contour_idx != size_t(-1) && d_min <= double(search_radius)) {
+    if (i_closest != size_t(-1) && d_min <= double(search_radius)) {
+		const std::pair<size_t, size_t> contour_and_segment = this->contour_and_segment(m_cell_segments[i_closest]);
+		result.contour_idx     = contour_and_segment.first;
+		result.start_point_idx = contour_and_segment.second;
 		result.distance = d_min * sign_min;
 		result.t /= l2_seg_min;
 		assert(result.t >= 0. && result.t < 1.);
@@ -1209,11 +1212,10 @@ bool EdgeGrid::Grid::signed_distance_edges(const Point &pt, coord_t search_radiu
 		for (int c = bbox.min(0); c <= bbox.max(0); ++ c) {
 			const Cell &cell = m_cells[r * m_cols + c];
 			for (size_t i = cell.begin; i < cell.end; ++ i) {
-				const Slic3r::Points &pts = *m_contours[m_cell_data[i].first];
-				size_t ipt = m_cell_data[i].second;
+				const Slic3r::Point *pts = this->segment_points(i);
 				// End points of the line segment.
-				const Slic3r::Point &p1 = pts[ipt];
-				const Slic3r::Point &p2 = pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1];
+				const Slic3r::Point &p1 = pts[0];
+				const Slic3r::Point &p2 = pts[1];
 				Slic3r::Point v_seg = p2 - p1;
 				Slic3r::Point v_pt  = pt - p1;
 				// dot(p2-p1, pt-p1)
@@ -1225,7 +1227,7 @@ bool EdgeGrid::Grid::signed_distance_edges(const Point &pt, coord_t search_radiu
 					double dabs = sqrt(int64_t(v_pt(0)) * int64_t(v_pt(0)) + int64_t(v_pt(1)) * int64_t(v_pt(1)));
 					if (dabs < d_min) {
 						// Previous point.
-						const Slic3r::Point &p0 = pts[(ipt == 0) ? (pts.size() - 1) : ipt - 1];
+						const Slic3r::Point &p0 = pts[-1];
 						Slic3r::Point v_seg_prev = p1 - p0;
 						int64_t t2_pt = int64_t(v_seg_prev(0)) * int64_t(v_pt(0)) + int64_t(v_seg_prev(1)) * int64_t(v_pt(1));
 						if (t2_pt > 0) {
@@ -1415,14 +1417,16 @@ std::vector<std::pair<EdgeGrid::Grid::ContourEdge, EdgeGrid::Grid::ContourEdge>>
 			const Cell &cell = m_cells[r * m_cols + c];
 			// For each pair of segments in the cell:
 			for (size_t i = cell.begin; i != cell.end; ++ i) {
-				const Slic3r::Points &ipts = *m_contours[m_cell_data[i].first];
-				size_t ipt = m_cell_data[i].second;
+				const std::pair<size_t, size_t> icontour_and_segment = this->contour_and_segment(m_cell_segments[i]);
+				const Slic3r::Points &ipts = *m_contours[icontour_and_segment.first];
+				size_t ipt = icontour_and_segment.second;
 				// End points of the line segment and their vector.
 				const Slic3r::Point &ip1 = ipts[ipt];
 				const Slic3r::Point &ip2 = ipts[(ipt + 1 == ipts.size()) ? 0 : ipt + 1];
 				for (size_t j = i + 1; j != cell.end; ++ j) {
-					const Slic3r::Points &jpts = *m_contours[m_cell_data[j].first];
-					size_t 				  jpt  = m_cell_data[j].second;
+					const std::pair<size_t, size_t> jcontour_and_segment = this->contour_and_segment(m_cell_segments[j]);
+					const Slic3r::Points &jpts = *m_contours[jcontour_and_segment.first];
+					size_t 				  jpt  = jcontour_and_segment.second;
 					// End points of the line segment and their vector.
 					const Slic3r::Point  &jp1  = jpts[jpt];
 					const Slic3r::Point  &jp2  = jpts[(jpt + 1 == jpts.size()) ? 0 : jpt + 1];
@@ -1452,14 +1456,16 @@ bool EdgeGrid::Grid::has_intersecting_edges() const
 			const Cell &cell = m_cells[r * m_cols + c];
 			// For each pair of segments in the cell:
 			for (size_t i = cell.begin; i != cell.end; ++ i) {
-				const Slic3r::Points &ipts = *m_contours[m_cell_data[i].first];
-				size_t ipt = m_cell_data[i].second;
+				const std::pair<size_t, size_t> icontour_and_segment = this->contour_and_segment(m_cell_segments[i]);
+				const Slic3r::Points &ipts = *m_contours[icontour_and_segment.first];
+				size_t ipt = icontour_and_segment.second;
 				// End points of the line segment and their vector.
 				const Slic3r::Point &ip1 = ipts[ipt];
 				const Slic3r::Point &ip2 = ipts[(ipt + 1 == ipts.size()) ? 0 : ipt + 1];
 				for (size_t j = i + 1; j != cell.end; ++ j) {
-					const Slic3r::Points &jpts = *m_contours[m_cell_data[j].first];
-					size_t 				  jpt  = m_cell_data[j].second;
+					const std::pair<size_t, size_t> jcontour_and_segment = this->contour_and_segment(m_cell_segments[j]);
+					const Slic3r::Points &jpts = *m_contours[jcontour_and_segment.first];
+					size_t 				  jpt  = jcontour_and_segment.second;
 					// End points of the line segment and their vector.
 					const Slic3r::Point  &jp1  = jpts[jpt];
 					const Slic3r::Point  &jp2  = jpts[(jpt + 1 == jpts.size()) ? 0 : jpt + 1];
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <math.h>
 
+#include <algorithm>
+
 #include "Point.hpp"
 #include "BoundingBox.hpp"
 #include "ExPolygon.hpp"
@@ -228,27 +230,40 @@ public:
 					return;
 	}
 
-	std::pair<std::vector<std::pair<size_t, size_t>>::const_iterator, std::vector<std::pair<size_t, size_t>>::const_iterator> cell_data_range(coord_t row, coord_t col) const
+	// Range of the line segments crossing a cell. Each item is an index of the start point of a segment in m_contour_points,
+	// to be passed to segment() or contour_and_segment().
+	std::pair<std::vector<uint32_t>::const_iterator, std::vector<uint32_t>::const_iterator> cell_data_range(coord_t row, coord_t col) const
 	{
 		const EdgeGrid::Grid::Cell &cell = m_cells[row * m_cols + col];
-		return std::make_pair(m_cell_data.begin() + cell.begin, m_cell_data.begin() + cell.end);
+		return std::make_pair(m_cell_segments.begin() + cell.begin, m_cell_segments.begin() + cell.end);
+	}
+
+	std::pair<const Slic3r::Point&, const Slic3r::Point&> segment(uint32_t cell_segment) const
+	{
+		const Slic3r::Point *pts = m_contour_points.data() + cell_segment;
+		return std::pair<const Slic3r::Point&, const Slic3r::Point&>(pts[0], pts[1]);
 	}
 
-	std::pair<const Slic3r::Point&, const Slic3r::Point&> segment(const std::pair<size_t, size_t> &contour_and_segment_idx) const
+	// Index of the contour in contours() and index of the start point of the segment in that contour.
+	std::pair<size_t, size_t> contour_and_segment(uint32_t cell_segment) const
 	{
-		const Slic3r::Points &ipts = *m_contours[contour_and_segment_idx.first];
-		size_t ipt = contour_and_segment_idx.second;
-		return std::pair<const Slic3r::Point&, const Slic3r::Point&>(ipts[ipt], ipts[(ipt + 1 == ipts.size()) ? 0 : ipt + 1]);
+		auto it = std::upper_bound(m_contour_offsets.begin(), m_contour_offsets.end(), cell_segment);
+		assert(it != m_contour_offsets.begin());
+		size_t contour_idx = it - m_contour_offsets.begin() - 1;
+		return std::make_pair(contour_idx, size_t(cell_segment - m_contour_offsets[contour_idx]));
 	}
 
 protected:
 	struct Cell {
 		Cell() : begin(0), end(0) {}
-		size_t begin;
-		size_t end;
+		uint32_t begin;
+		uint32_t end;
 	};
 
 	void create_from_m_contours(coord_t resolution);
+	// Points of the line segment referenced by m_cell_segments[cell_data_idx]: [-1] the previous point on the contour,
+	// [0] the start point and [1] the end point of the segment.
+	const Slic3r::Point* segment_points(size_t cell_data_idx) const { return m_contour_points.data() + m_cell_segments[cell_data_idx]; }
 #if 0
 	bool line_cell_intersect(const Point &p1, const Point &p2, const Cell &cell);
 #endif
@@ -277,8 +292,13 @@ protected:
 	// (Polygon, ExPolygon, ExPolygonCollection etc).
 	std::vector<const Slic3r::Points*>			m_contours;
 
-	// Referencing a contour and a line segment of m_contours.
-	std::vector<std::pair<size_t, size_t> >		m_cell_data;
+	// Copy of the points of m_contours stored contiguously. Each contour is preceded by its last point and followed by its first point,
+	// thus the neighbor points of a line segment are accessed without a wrap around and without dereferencing m_contours.
+	Points 										m_contour_points;
+	// Index of the first point of each of m_contours in m_contour_points.
+	std::vector<uint32_t>						m_contour_offsets;
+	// Index of the start point of a line segment in m_contour_points, referenced by the cell ranges.
+	std::vector<uint32_t>						m_cell_segments;
 
 	// Full grid of cells.
 	std::vector<Cell> 							m_cells;
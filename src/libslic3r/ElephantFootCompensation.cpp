@@ -82,9 +82,9 @@ std::vector<float> contour_distance(const EdgeGrid::Grid &grid, const size_t idx
 				// Called with a row and colum of the grid cell, which is intersected by a line.
 				auto cell_data_range = this->grid.cell_data_range(iy, ix);
 				bool valid = true;
-				for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++ it_contour_and_segment) {
+				for (auto it_segment = cell_data_range.first; it_segment != cell_data_range.second; ++ it_segment) {
 					// End points of the line segment and their vector.
-					auto segment = this->grid.segment(*it_contour_and_segment);
+					auto segment = this->grid.segment(*it_segment);
 					if (Geometry::segments_intersect(segment.first, segment.second, this->pt_start, this->pt_end)) {
 						// The two segments intersect. Calculate the intersection.
 						Vec2d pt2 = segment.first.cast<double>();
@@ -96,7 +96,8 @@ std::vector<float> contour_distance(const EdgeGrid::Grid &grid, const size_t idx
 							double t = cross2(dir2, vptpt2) / denom;
 							assert(t > - EPSILON && t < 1. + EPSILON);
 							bool this_valid = true;
-							if (it_contour_and_segment->first == idx_contour) {
+							const std::pair<size_t, size_t> contour_and_segment = this->grid.contour_and_segment(*it_segment);
+							if (contour_and_segment.first == idx_contour) {
 								// The intersected segment originates from the same contour as the starting point.
 								// Reject the intersection if it is close to the starting point.
 								// Find the start and end points of this segment
@@ -104,8 +105,8 @@ std::vector<float> contour_distance(const EdgeGrid::Grid &grid, const size_t idx
 								double param_hi;
 								double param_end = resampled_point_parameters.back().curve_parameter;
 								{
-									const Slic3r::Points &ipts = *grid.contours()[it_contour_and_segment->first];
-									size_t ipt = it_contour_and_segment->second;
+									const Slic3r::Points &ipts = *grid.contours()[contour_and_segment.first];
+									size_t ipt = contour_and_segment.second;
 									ResampledPoint key(ipt, false, 0.);
 									auto lower = [](const ResampledPoint& l, const ResampledPoint r) { return l.idx_src < r.idx_src || (l.idx_src == r.idx_src && int(l.interpolated) > int(r.interpolated)); };
 									auto it = std::lower_bound(resampled_point_parameters.begin(), resampled_point_parameters.end(), key, lower);
@@ -263,9 +264,9 @@ std::vector<float> contour_distance2(const EdgeGrid::Grid &grid, const size_t id
 			bool operator()(coord_t iy, coord_t ix) {
 				// Called with a row and colum of the grid cell, which is intersected by a line.
 				auto cell_data_range = this->grid.cell_data_range(iy, ix);
-				for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++ it_contour_and_segment) {
+				for (auto it_segment = cell_data_range.first; it_segment != cell_data_range.second; ++ it_segment) {
 					// End points of the line segment and their vector.
-					std::pair<const Point&, const Point&> segment = this->grid.segment(*it_contour_and_segment);
+					std::pair<const Point&, const Point&> segment = this->grid.segment(*it_segment);
 				    const Vec2d   v  = (segment.second - segment.first).cast<double>();
 				    const Vec2d   va = (this->point - segment.first).cast<double>();
 				    const double  l2 = v.squaredNorm();  // avoid a sqrt
@@ -276,14 +277,15 @@ std::vector<float> contour_distance2(const EdgeGrid::Grid &grid, const size_t id
 					const double  dist = bisector.norm();
 				    if ((! this->found || dist < this->distance) && this->dir_inside.dot(bisector) > 0) {
 						bool	accept = true;
-					    if (it_contour_and_segment->first == idx_contour) {
+						const std::pair<size_t, size_t> contour_and_segment = this->grid.contour_and_segment(*it_segment);
+					    if (contour_and_segment.first == idx_contour) {
 							// Complex case: The closest segment originates from the same contour as the starting point.
 							// Reject the closest point if its distance along the contour is reasonable compared to the current contour bisector (this->pt, foot).
 							double param_lo = resampled_point_parameters[this->idx_point].curve_parameter;
 							double param_hi;
 							double param_end = resampled_point_parameters.back().curve_parameter;
-							const Slic3r::Points &ipts = *grid.contours()[it_contour_and_segment->first];
-							const size_t		  ipt  = it_contour_and_segment->second;
+							const Slic3r::Points &ipts = *grid.contours()[contour_and_segment.first];
+							const size_t		  ipt  = contour_and_segment.second;
 							{
 								ResampledPoint key(ipt, false, 0.);
 								auto lower = [](const ResampledPoint& l, const ResampledPoint r) { return l.idx_src < r.idx_src || (l.idx_src == r.idx_src && int(l.interpolated) > int(r.interpolated)); };
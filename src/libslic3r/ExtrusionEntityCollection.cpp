@@ -86,7 +86,7 @@ void ExtrusionEntityCollection::remove(size_t i)
     this->entities.erase(this->entities.begin() + i);
 }
 
-ExtrusionEntityCollection ExtrusionEntityCollection::chained_path_from(const ExtrusionEntitiesPtr& extrusion_entities, const Point &start_near, ExtrusionRole role)
+ExtrusionEntityCollection ExtrusionEntityCollection::chained_path_from(const ExtrusionEntitiesPtr& extrusion_entities, const Point &start_near, ExtrusionRole role, size_t cluster_size)
 {
 	// Return a filtered copy of the collection.
     ExtrusionEntityCollection out;
@@ -94,7 +94,7 @@ ExtrusionEntityCollection ExtrusionEntityCollection::chained_path_from(const Ext
 	// Clone the extrusion entities.
 	for (auto &ptr : out.entities)
 		ptr = ptr->clone();
-	chain_and_reorder_extrusion_entities(out.entities, &start_near);
+	chain_and_reorder_extrusion_entities(out.entities, &start_near, cluster_size);
     return out;
 }
 
@@ -723,14 +723,15 @@ void mark_boundary_segments_touching_infill(
 		bool operator()(coord_t iy, coord_t ix) {
 			// Called with a row and colum of the grid cell, which is intersected by a line.
 			auto cell_data_range = this->grid.cell_data_range(iy, ix);
-			for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++ it_contour_and_segment) {
+			for (auto it_segment = cell_data_range.first; it_segment != cell_data_range.second; ++ it_segment) {
 				// End points of the line segment and their vector.
-				auto segment = this->grid.segment(*it_contour_and_segment);
+				auto segment = this->grid.segment(*it_segment);
 				const Vec2d seg_pt1 = segment.first.cast<double>();
 				const Vec2d seg_pt2 = segment.second.cast<double>();
 				if (min_distance_of_segments(seg_pt1, seg_pt2, *this->pt1, *this->pt2) < this->dist2_max) {
 					// Mark this boundary segment as touching the infill line.
-					ContourPointData &bdp = boundary_data[it_contour_and_segment->first][it_contour_and_segment->second];
+					const std::pair<size_t, size_t> contour_and_segment = this->grid.contour_and_segment(*it_segment);
+					ContourPointData &bdp = boundary_data[contour_and_segment.first][contour_and_segment.second];
 					bdp.segment_consumed = true;
 					// There is no need for checking seg_pt2 as it will be checked the next time.
 					bool point_touching = false;
@@ -9,6 +9,7 @@
 #include "libslic3r/SLAPrint.hpp"
 
 #include <sstream>
+#include <unordered_map>
 
 #include "libslic3r/SlicesToTriangleMesh.hpp"
 #include "libslic3r/MarchingSquares.hpp"
@@ -23,6 +24,9 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
+
 namespace marchsq {
 
 template<> struct _RasterTraits<Slic3r::png::ImageGreyscale> {
@@ -431,7 +435,7 @@ uqptr<sla::RasterBase> SL1Archive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    return sla::create_raster_grayscale_aa_rle(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder SL1Archive::get_encoder() const
@@ -439,35 +443,65 @@ sla::RasterEncoder SL1Archive::get_encoder() const
     return sla::PNGRasterEncoder{};
 }
 
-void SL1Archive::export_print(Zipper& zipper,
-                              const SLAPrint &print,
-                              const std::string &prjname)
+static std::string get_project_name(const Zipper &zipper, const std::string &prjname)
+{
+    return prjname.empty() ?
+               boost::filesystem::path(zipper.get_filename()).stem().string() :
+               prjname;
+}
+
+static void write_config_entries(Zipper &zipper, const SLAPrint &print, const std::string &project)
 {
-    std::string project =
-        prjname.empty() ?
-            boost::filesystem::path(zipper.get_filename()).stem().string() :
-            prjname;
-    
     ConfMap iniconf, slicerconf;
     fill_iniconf(iniconf, print);
-    
+
     iniconf["jobDir"] = project;
 
     fill_slicerconf(slicerconf, print);
 
+    zipper.add_entry("config.ini");
+    zipper << to_ini(iniconf);
+    zipper.add_entry("prusaslicer.ini");
+    zipper << to_ini(slicerconf);
+}
+
+static std::string layer_image_name(const std::string &project, size_t layer_id, const std::string &extension)
+{
+    return project + string_printf("%.5d", layer_id) + "." + extension;
+}
+
+void SL1Archive::export_print(Zipper& zipper,
+                              const SLAPrint &print,
+                              const std::string &prjname)
+{
+    std::string project = get_project_name(zipper, prjname);
+
+    // Identical layers share their encoded raster, it is compressed only once.
+    std::unordered_map<const void*, size_t> num_shared;
+    for (const sla::EncodedRaster &rst : m_layers)
+        ++ num_shared[rst.data()];
+    std::unordered_map<const void*, Zipper::CompressedEntry> compressed;
+
     try {
-        zipper.add_entry("config.ini");
-        zipper << to_ini(iniconf);
-        zipper.add_entry("prusaslicer.ini");
-        zipper << to_ini(slicerconf);
+        write_config_entries(zipper, print, project);
         
         size_t i = 0;
         for (const sla::EncodedRaster &rst : m_layers) {
 
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
-                                  rst.extension();
+            std::string imgname = layer_image_name(project, i++, rst.extension());
             
-            zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            size_t &remaining = num_shared[rst.data()];
+            if (remaining == 1 && compressed.find(rst.data()) == compressed.end())
+                zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            else {
+                auto it = compressed.find(rst.data());
+                if (it == compressed.end())
+                    it = compressed.emplace(rst.data(), zipper.compress_entry(rst.data(), rst.size())).first;
+                zipper.add_entry(imgname, it->second);
+                if (remaining == 1)
+                    compressed.erase(it);
+            }
+            -- remaining;
         }
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
@@ -476,4 +510,90 @@ void SL1Archive::export_print(Zipper& zipper,
     }
 }
 
+void SL1Archive::export_print_streaming(Zipper& zipper,
+                                        const SLAPrint &print,
+                                        const std::string &prjname)
+{
+    std::string project = get_project_name(zipper, prjname);
+
+    // The print may have been processed without this archive set as its printer.
+    this->apply(print.printer_config());
+    // Any layers rasterized before are not valid for this export.
+    m_layers = {};
+
+    const std::vector<SLAPrint::PrintLayer> &layers = print.print_layers();
+    // Layers identical to a previous one reuse its compressed image, they are not drawn.
+    const std::vector<size_t> identical = print.identical_print_layers();
+    // Last layer sharing the image of each layer, after which the image is released.
+    std::vector<size_t> last_identical(identical.size());
+    for (size_t idx = 0; idx < identical.size(); ++ idx)
+        last_identical[identical[idx]] = idx;
+
+    try {
+        write_config_entries(zipper, print, project);
+
+        // Image of a single layer, compressed and ready to be appended to the archive,
+        // null for a layer sharing the image of a previous layer.
+        struct LayerImage {
+            size_t                                         layer_id;
+            std::string                                    extension;
+            std::shared_ptr<const Zipper::CompressedEntry> entry;
+        };
+        // Images of the layers already written, to be written again for their identical layers.
+        std::unordered_map<size_t, LayerImage> shared_images;
+
+        BOOST_LOG_TRIVIAL(debug) << "Exporting SLA layers in parallel - start";
+
+        size_t layer_id = 0;
+        const auto layer_source = tbb::make_filter<void, size_t>(tbb::filter::serial_in_order,
+            [&layers, &layer_id](tbb::flow_control& fc) -> size_t {
+                if (layer_id == layers.size()) {
+                    fc.stop();
+                    return 0;
+                }
+                return layer_id ++;
+            });
+        // Draw, encode and compress the layers in parallel, the archive is not touched.
+        const auto rasterize = tbb::make_filter<size_t, LayerImage>(tbb::filter::parallel,
+            [this, &print, &layers, &identical, &zipper](size_t idx) -> LayerImage {
+                if (print.canceled())
+                    throw CanceledException();
+                if (identical[idx] != idx)
+                    return { idx, {}, nullptr };
+                uqptr<sla::RasterBase> raster = create_raster();
+                for (const ClipperLib::Polygon& poly : layers[idx].transformed_slices())
+                    raster->draw(poly);
+                sla::EncodedRaster rst = raster->encode(get_encoder());
+                // Release the raster before compressing the encoded image.
+                raster.reset();
+                return { idx, rst.extension(), std::make_shared<const Zipper::CompressedEntry>(zipper.compress_entry(rst.data(), rst.size())) };
+            });
+        const auto output = tbb::make_filter<LayerImage, void>(tbb::filter::serial_in_order,
+            [&zipper, &project, &identical, &last_identical, &shared_images](LayerImage img) {
+                const size_t source = identical[img.layer_id];
+                if (! img.entry) {
+                    // The source layer was written already.
+                    const LayerImage &shared = shared_images.at(source);
+                    img.extension = shared.extension;
+                    img.entry     = shared.entry;
+                }
+                zipper.add_entry(layer_image_name(project, img.layer_id, img.extension), *img.entry);
+                if (last_identical[source] == img.layer_id)
+                    shared_images.erase(source);
+                else if (source == img.layer_id)
+                    shared_images.emplace(source, img);
+            });
+
+        // The number of layers in flight limits the memory consumption, it only needs to be high enough
+        // to keep all the workers busy while the layers are written out in order.
+        tbb::parallel_pipeline(size_t(2 * tbb::task_scheduler_init::default_num_threads()), layer_source & rasterize & output);
+
+        BOOST_LOG_TRIVIAL(debug) << "Exporting SLA layers in parallel - end";
+    } catch(std::exception& e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+        // Rethrow the exception
+        throw;
+    }
+}
+
 } // namespace Slic3r
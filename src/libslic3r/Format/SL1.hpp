@@ -27,6 +27,17 @@ public:
         Zipper zipper(fname);
         export_print(zipper, print, projectname);
     }
+
+    // Rasterize the layers of the print and export them without keeping the rasters in memory:
+    // The layers are drawn, encoded and compressed in parallel and appended to the archive in order,
+    // with a bounded number of layers in flight. The print does not need to be rasterized,
+    // thus the SLAPrint may be processed without a printer set.
+    void export_print_streaming(Zipper &zipper, const SLAPrint &print, const std::string &projectname = "");
+    void export_print_streaming(const std::string &fname, const SLAPrint &print, const std::string &projectname = "")
+    {
+        Zipper zipper(fname);
+        export_print_streaming(zipper, print, projectname);
+    }
     
     void apply(const SLAPrinterConfig &cfg) override
     {
@@ -12,6 +12,7 @@
 #include "libslic3r.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <math.h>
 #include <string_view>
@@ -30,6 +31,7 @@
 #include "SVG.hpp"
 
 #include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
 
 #include <Shiny/Shiny.h>
 
@@ -93,6 +95,16 @@ namespace Slic3r {
         m_external_mp = Slic3r::make_unique<MotionPlanner>(union_ex(this->collect_contours_all_layers(print.objects())));
     }
 
+    void AvoidCrossingPerimeters::init_layer_mp(ExPolygons &&islands)
+    {
+        // Consecutive layers of prismatic objects or copies of the same object share the same islands.
+        // Keep the motion planner of the previous layer together with the graphs it has already constructed.
+        if (islands == m_layer_islands)
+            return;
+        m_layer_islands = std::move(islands);
+        m_layer_mp.reset();
+    }
+
     // Plan a travel move while minimizing the number of perimeter crossings.
     // point is in unscaled coordinates, in the coordinate system of the current active object
     // (set by gcodegen.set_origin()).
@@ -102,6 +114,8 @@ namespace Slic3r {
         // Otherwise perform the path planning in the coordinate system of the active object.
         bool  use_external = this->use_external_mp || this->use_external_mp_once;
         Point scaled_origin = use_external ? Point::new_scale(gcodegen.origin()(0), gcodegen.origin()(1)) : Point(0, 0);
+        if (! use_external && ! m_layer_mp)
+            m_layer_mp = Slic3r::make_unique<MotionPlanner>(m_layer_islands);
         Polyline result = (use_external ? m_external_mp.get() : m_layer_mp.get())->
             shortest_path(gcodegen.last_pos() + scaled_origin, point + scaled_origin);
         if (use_external)
@@ -714,8 +728,19 @@ std::vector<std::pair<coordf_t, std::vector<GCode::LayerToPrint>>> GCode::collec
     return layers_to_print;
 }
 
-#if ENABLE_GCODE_VIEWER
 // free functions called by GCode::do_export()
+namespace DoExport {
+    static void update_print_export_throughput_stats(size_t bytes_written, std::chrono::steady_clock::duration export_time, PrintStatistics& print_statistics)
+    {
+        double seconds = std::chrono::duration<double>(export_time).count();
+        print_statistics.gcode_export_bytes            = bytes_written;
+        print_statistics.gcode_export_bytes_per_second = seconds > 0. ? double(bytes_written) / seconds : 0.;
+        BOOST_LOG_TRIVIAL(info) << "G-code written: " << format_memsize_MB(bytes_written) << " at " <<
+            print_statistics.gcode_export_bytes_per_second / (1024. * 1024.) << " MB/s";
+    }
+} // namespace DoExport
+
+#if ENABLE_GCODE_VIEWER
 namespace DoExport {
     static void update_print_estimated_times_stats(const GCodeProcessor& processor, PrintStatistics& print_statistics)
     {
@@ -747,31 +772,33 @@ void GCode::do_export(Print* print, const char* path, GCodePreviewData* preview_
     std::string path_tmp(path);
     path_tmp += ".tmp";
 
-    FILE *file = boost::nowide::fopen(path_tmp.c_str(), "wb");
-    if (file == nullptr)
+    GCodeOutputStream file(boost::nowide::fopen(path_tmp.c_str(), "wb"));
+    if (! file.is_open())
         throw std::runtime_error(std::string("G-code export to ") + path + " failed.\nCannot open the file for writing.\n");
 
 #if !ENABLE_GCODE_VIEWER
     m_enable_analyzer = preview_data != nullptr;
 #endif // !ENABLE_GCODE_VIEWER
 
+    auto export_start = std::chrono::steady_clock::now();
     try {
         m_placeholder_parser_failed_templates.clear();
         this->_do_export(*print, file, thumbnail_cb);
-        fflush(file);
-        if (ferror(file)) {
-            fclose(file);
+        file.flush();
+        if (file.is_error()) {
+            file.close();
             boost::nowide::remove(path_tmp.c_str());
             throw std::runtime_error(std::string("G-code export to ") + path + " failed\nIs the disk full?\n");
         }
     } catch (std::exception & /* ex */) {
         // Rethrow on any exception. std::runtime_exception and CanceledException are expected to be thrown.
         // Close and remove the file.
-        fclose(file);
+        file.close();
         boost::nowide::remove(path_tmp.c_str());
         throw;
     }
-    fclose(file);
+    file.close();
+    DoExport::update_print_export_throughput_stats(file.bytes_written(), std::chrono::steady_clock::now() - export_start, print->m_print_statistics);
 
     if (! m_placeholder_parser_failed_templates.empty()) {
         // G-code export proceeded, but some of the PlaceholderParser substitutions failed.
@@ -787,7 +814,9 @@ void GCode::do_export(Print* print, const char* path, GCodePreviewData* preview_
     }
 
 #if ENABLE_GCODE_VIEWER
-    m_processor.process_file(path_tmp, [print]() { print->throw_if_canceled(); });
+    // The G-code has already been processed while being exported, only calculate the times and add the M73 lines.
+    BOOST_LOG_TRIVIAL(debug) << "Time estimator post processing" << log_memory_info();
+    m_processor.finalize(path_tmp);
     DoExport::update_print_estimated_times_stats(m_processor, print->m_print_statistics);
     if (result != nullptr)
         *result = std::move(m_processor.extract_result());
@@ -1167,13 +1196,16 @@ std::vector<const PrintInstance*> sort_object_instances_by_model_order(const Pri
     return instances;
 }
 
-void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thumbnail_cb)
+void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_FUNC();
 
 #if ENABLE_GCODE_VIEWER
     // modifies m_silent_time_estimator_enabled
     DoExport::init_gcode_processor(print.config(), m_processor, m_silent_time_estimator_enabled);
+    // the processor is fed with the G-code as it is being written
+    m_processor.initialize();
+    file.set_processor(&m_processor);
 #else
     DoExport::init_time_estimators(print.config(),
         // modifies the following:
@@ -1231,7 +1263,6 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     m_volumetric_speed = DoExport::autospeed_volumetric_limit(print);
     print.throw_if_canceled();
 
-    m_cooling_buffer = make_unique<CoolingBuffer>(*this);
     if (print.config().spiral_vase.value)
         m_spiral_vase = make_unique<SpiralVase>(print.config());
 #ifdef HAS_PRESSURE_EQUALIZER
@@ -1247,7 +1278,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     _write_format(file, "; %s\n\n", Slic3r::header_slic3r_generated().c_str());
 
     DoExport::export_thumbnails_to_file(thumbnail_cb, print.full_print_config().option<ConfigOptionPoints>("thumbnails")->values, 
-        [this, file](const char* sz) { this->_write(file, sz); }, 
+        [this, &file](const char* sz) { this->_write(file, sz); }, 
         [&print]() { print.throw_if_canceled(); });
 
     // Write notes (content of the Print Settings tab -> Notes)
@@ -1349,6 +1380,8 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     }
     print.throw_if_canceled();
 
+    // The cooling buffer captures the set of extruders, therefore it has to be created after set_extruders() was called.
+    m_cooling_buffer = make_unique<CoolingBuffer>(*this);
     m_cooling_buffer->set_current_extruder(initial_extruder_id);
 
     // Emit machine envelope limits for the Marlin firmware.
@@ -1484,13 +1517,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
             m_cooling_buffer->reset();
             m_cooling_buffer->set_current_extruder(initial_extruder_id);
             // Pair the object layers with the support layers by z, extrude them.
-            std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-            for (const LayerToPrint &ltp : layers_to_print) {
-                std::vector<LayerToPrint> lrs;
-                lrs.emplace_back(std::move(ltp));
-                this->process_layer(file, print, lrs, tool_ordering.tools_for_layer(ltp.print_z()), nullptr, *print_object_instance_sequential_active - object.instances().data());
-                print.throw_if_canceled();
-            }
+            this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file);
 #ifdef HAS_PRESSURE_EQUALIZER
             if (m_pressure_equalizer)
                 _write(file, m_pressure_equalizer->process("", true));
@@ -1536,13 +1563,7 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
             print.throw_if_canceled();
         }
         // Extrude the layers.
-        for (auto &layer : layers_to_print) {
-            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
-            if (m_wipe_tower && layer_tools.has_wipe_tower)
-                m_wipe_tower->next_layer();
-            this->process_layer(file, print, layer.second, layer_tools, &print_object_instances_ordering, size_t(-1));
-            print.throw_if_canceled();
-        }
+        this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, file);
 #ifdef HAS_PRESSURE_EQUALIZER
         if (m_pressure_equalizer)
             _write(file, m_pressure_equalizer->process("", true));
@@ -1642,6 +1663,135 @@ void GCode::_do_export(Print& print, FILE* file, ThumbnailsGeneratorCallback thu
     print.throw_if_canceled();
 }
 
+// Process all layers of all objects (non-sequential mode) with a parallel pipeline:
+// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
+// and export G-code into file.
+void GCode::process_layers(
+    const Print                                                         &print,
+    const ToolOrdering                                                  &tool_ordering,
+    const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
+    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+    GCodeOutputStream                                                   &file)
+{
+    // The pipeline is variable: The vase mode filter is optional.
+    size_t layer_to_print_idx = 0;
+    const auto layer_source = tbb::make_filter<void, size_t>(tbb::filter::serial_in_order,
+        [&layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            if (layer_to_print_idx == layers_to_print.size()) {
+                fc.stop();
+                return 0;
+            }
+            return layer_to_print_idx ++;
+        });
+    // Group the extrusions of the upcoming layers in parallel, the G-code generator state is not touched.
+    const auto grouping = tbb::make_filter<size_t, std::pair<size_t, ObjectsByExtruder>>(tbb::filter::parallel,
+        [&print, &tool_ordering, &layers_to_print](size_t idx) -> std::pair<size_t, ObjectsByExtruder> {
+            const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[idx];
+            print.throw_if_canceled();
+            return { idx, group_extrusions_by_extruder(print, layer.second, tool_ordering.tools_for_layer(layer.first)) };
+        });
+    const auto generator = tbb::make_filter<std::pair<size_t, ObjectsByExtruder>, GCode::LayerResult>(tbb::filter::serial_in_order,
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print](std::pair<size_t, ObjectsByExtruder> in) -> GCode::LayerResult {
+            const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[in.first];
+            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
+            if (m_wipe_tower && layer_tools.has_wipe_tower)
+                m_wipe_tower->next_layer();
+            print.throw_if_canceled();
+            return this->process_layer(print, layer.second, layer_tools, in.second, &print_object_instances_ordering, size_t(-1));
+        });
+    const auto post_process = tbb::make_filter<GCode::LayerResult, std::string>(tbb::filter::serial_in_order,
+        [this](GCode::LayerResult in) -> std::string { return this->post_process_layer(std::move(in)); });
+    const auto output = tbb::make_filter<std::string, void>(tbb::filter::serial_in_order,
+        [this, &file](const std::string &s) { _write(file, s); });
+
+    // The pipeline elements are joined using const references, thus no copying is performed.
+    tbb::parallel_pipeline(12, layer_source & grouping & generator & post_process & output);
+}
+
+// Process all layers of a single object instance (sequential mode) with a parallel pipeline:
+// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
+// and export G-code into file.
+void GCode::process_layers(
+    const Print                             &print,
+    const ToolOrdering                      &tool_ordering,
+    const std::vector<LayerToPrint>         &layers_to_print,
+    const size_t                             single_object_idx,
+    GCodeOutputStream                       &file)
+{
+    size_t layer_to_print_idx = 0;
+    const auto layer_source = tbb::make_filter<void, size_t>(tbb::filter::serial_in_order,
+        [&layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            if (layer_to_print_idx == layers_to_print.size()) {
+                fc.stop();
+                return 0;
+            }
+            return layer_to_print_idx ++;
+        });
+    // Group the extrusions of the upcoming layers in parallel, the G-code generator state is not touched.
+    const auto grouping = tbb::make_filter<size_t, std::pair<size_t, ObjectsByExtruder>>(tbb::filter::parallel,
+        [&print, &tool_ordering, &layers_to_print](size_t idx) -> std::pair<size_t, ObjectsByExtruder> {
+            const LayerToPrint &layer = layers_to_print[idx];
+            print.throw_if_canceled();
+            return { idx, group_extrusions_by_extruder(print, { layer }, tool_ordering.tools_for_layer(layer.print_z())) };
+        });
+    const auto generator = tbb::make_filter<std::pair<size_t, ObjectsByExtruder>, GCode::LayerResult>(tbb::filter::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, single_object_idx](std::pair<size_t, ObjectsByExtruder> in) -> GCode::LayerResult {
+            const LayerToPrint &layer = layers_to_print[in.first];
+            print.throw_if_canceled();
+            return this->process_layer(print, { layer }, tool_ordering.tools_for_layer(layer.print_z()), in.second, nullptr, single_object_idx);
+        });
+    const auto post_process = tbb::make_filter<GCode::LayerResult, std::string>(tbb::filter::serial_in_order,
+        [this](GCode::LayerResult in) -> std::string { return this->post_process_layer(std::move(in)); });
+    const auto output = tbb::make_filter<std::string, void>(tbb::filter::serial_in_order,
+        [this, &file](const std::string &s) { _write(file, s); });
+
+    // The pipeline elements are joined using const references, thus no copying is performed.
+    tbb::parallel_pipeline(12, layer_source & grouping & generator & post_process & output);
+}
+
+// Run the G-code filters requiring a complete layer: spiral vase, cooling buffer and pressure equalizer.
+// The filters are stateful, therefore this function has to be called for all layers in the print order.
+std::string GCode::post_process_layer(LayerResult &&layer_result)
+{
+    if (layer_result.empty())
+        // Nothing was generated for this layer.
+        return std::string();
+
+    std::string gcode = std::move(layer_result.gcode);
+
+    // Apply spiral vase post-processing if this layer contains suitable geometry
+    // (we must feed all the G-code into the post-processor, including the first 
+    // bottom non-spiral layers otherwise it will mess with positions)
+    // we apply spiral vase at this stage because it requires a full layer.
+    // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
+    if (m_spiral_vase) {
+        m_spiral_vase->enable(layer_result.spiral_vase_enable);
+        gcode = m_spiral_vase->process_layer(gcode);
+    }
+
+    // Apply cooling logic; this may alter speeds.
+    if (m_cooling_buffer)
+        gcode = m_cooling_buffer->process_layer(gcode, layer_result.layer_id);
+
+#if !ENABLE_GCODE_VIEWER
+    // add tag for analyzer
+    if (gcode.find(GCodeAnalyzer::Pause_Print_Tag) != gcode.npos)
+        gcode += "\n; " + GCodeAnalyzer::End_Pause_Print_Or_Custom_Code_Tag + "\n";
+    else if (gcode.find(GCodeAnalyzer::Custom_Code_Tag) != gcode.npos)
+        gcode += "\n; " + GCodeAnalyzer::End_Pause_Print_Or_Custom_Code_Tag + "\n";
+#endif // !ENABLE_GCODE_VIEWER
+
+#ifdef HAS_PRESSURE_EQUALIZER
+    // Apply pressure equalization if enabled;
+    // printf("G-code before filter:\n%s\n", gcode.c_str());
+    if (m_pressure_equalizer)
+        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
+    // printf("G-code after filter:\n%s\n", out.c_str());
+#endif /* HAS_PRESSURE_EQUALIZER */
+
+    return gcode;
+}
+
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
 {
     try {
@@ -1713,29 +1863,29 @@ static bool custom_gcode_sets_temperature(const std::string &gcode, const int mc
 
 // Print the machine envelope G-code for the Marlin firmware based on the "machine_max_xxx" parameters.
 // Do not process this piece of G-code by the time estimator, it already knows the values through another sources.
-void GCode::print_machine_envelope(FILE *file, Print &print)
+void GCode::print_machine_envelope(GCodeOutputStream &file, Print &print)
 {
     if (print.config().gcode_flavor.value == gcfMarlin) {
-        fprintf(file, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
+        file.write_format("M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
             int(print.config().machine_max_acceleration_x.values.front() + 0.5),
             int(print.config().machine_max_acceleration_y.values.front() + 0.5),
             int(print.config().machine_max_acceleration_z.values.front() + 0.5),
             int(print.config().machine_max_acceleration_e.values.front() + 0.5));
-        fprintf(file, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
+        file.write_format("M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
             int(print.config().machine_max_feedrate_x.values.front() + 0.5),
             int(print.config().machine_max_feedrate_y.values.front() + 0.5),
             int(print.config().machine_max_feedrate_z.values.front() + 0.5),
             int(print.config().machine_max_feedrate_e.values.front() + 0.5));
-        fprintf(file, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
+        file.write_format("M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5),
             int(print.config().machine_max_acceleration_retracting.values.front() + 0.5),
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5));
-        fprintf(file, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
+        file.write_format("M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
             print.config().machine_max_jerk_x.values.front(),
             print.config().machine_max_jerk_y.values.front(),
             print.config().machine_max_jerk_z.values.front(),
             print.config().machine_max_jerk_e.values.front());
-        fprintf(file, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
+        file.write_format("M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
             int(print.config().machine_min_extruding_rate.values.front() + 0.5),
             int(print.config().machine_min_travel_rate.values.front() + 0.5));
     }
@@ -1745,7 +1895,7 @@ void GCode::print_machine_envelope(FILE *file, Print &print)
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M140 - Set Extruder Temperature
 // M190 - Set Extruder Temperature and Wait
-void GCode::_print_first_layer_bed_temperature(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+void GCode::_print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
     // Initial bed temperature based on the first extruder.
     int  temp = print.config().first_layer_bed_temperature.get_at(first_printing_extruder_id);
@@ -1765,7 +1915,7 @@ void GCode::_print_first_layer_bed_temperature(FILE *file, Print &print, const s
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M104 - Set Extruder Temperature
 // M109 - Set Extruder Temperature and Wait
-void GCode::_print_first_layer_extruder_temperatures(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+void GCode::_print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
     // Is the bed temperature set by the provided custom G-code?
     int  temp_by_gcode     = -1;
@@ -2031,136 +2181,20 @@ namespace Skirt {
 
 } // namespace Skirt
 
-// In sequential mode, process_layer is called once per each object and its copy, 
-// therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
-// In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
-// For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
-// and performing the extruder specific extrusions together.
-void GCode::process_layer(
-    // Write into the output file.
-    FILE                            		*file,
-    const Print                    			&print,
-    // Set of object & print layers of the same PrintObject and with the same print_z.
-    const std::vector<LayerToPrint> 		&layers,
-    const LayerTools        		        &layer_tools,
-	// Pairs of PrintObject index and its instance index.
-	const std::vector<const PrintInstance*> *ordering,
-    // If set to size_t(-1), then print all copies of all objects.
-    // Otherwise print a single copy of a single object.
-    const size_t                     		 single_object_instance_idx)
+// Group extrusions by an extruder, then by an object, an island and a region.
+// The G-code generator state is not touched, therefore this function may run for multiple layers in parallel.
+// The extruder overrides of layer_tools are finalized here, but only for the extrusions of these layers.
+GCode::ObjectsByExtruder GCode::group_extrusions_by_extruder(
+    const Print                             &print,
+    const std::vector<LayerToPrint>         &layers,
+    const LayerTools                        &layer_tools)
 {
-    assert(! layers.empty());
-    // Either printing all copies of all objects, or just a single copy of a single object.
-    assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
-
+    ObjectsByExtruder by_extruder;
     if (layer_tools.extruders.empty())
         // Nothing to extrude.
-        return;
-
-    // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
-    const Layer         *object_layer  = nullptr;
-    const SupportLayer  *support_layer = nullptr;
-    for (const LayerToPrint &l : layers) {
-        if (l.object_layer != nullptr && object_layer == nullptr)
-            object_layer = l.object_layer;
-        if (l.support_layer != nullptr && support_layer == nullptr)
-            support_layer = l.support_layer;
-    }
-    const Layer         &layer         = (object_layer != nullptr) ? *object_layer : *support_layer;
-    coordf_t             print_z       = layer.print_z;
-    bool                 first_layer   = layer.id() == 0;
-    unsigned int         first_extruder_id = layer_tools.extruders.front();
-
-    // Initialize config with the 1st object to be printed at this layer.
-    m_config.apply(layer.object()->config(), true);
+        return by_extruder;
 
-    // Check whether it is possible to apply the spiral vase logic for this layer.
-    // Just a reminder: A spiral vase mode is allowed for a single object, single material print only.
-    if (m_spiral_vase && layers.size() == 1 && support_layer == nullptr) {
-        bool enable = (layer.id() > 0 || print.config().brim_width.value == 0.) && (layer.id() >= (size_t)print.config().skirt_height.value && ! print.has_infinite_skirt());
-        if (enable) {
-            for (const LayerRegion *layer_region : layer.regions())
-                if (size_t(layer_region->region()->config().bottom_solid_layers.value) > layer.id() ||
-                    layer_region->perimeters.items_count() > 1u ||
-                    layer_region->fills.items_count() > 0) {
-                    enable = false;
-                    break;
-                }
-        }
-        m_spiral_vase->enable = enable;
-    }
-    // If we're going to apply spiralvase to this layer, disable loop clipping
-    m_enable_loop_clipping = ! m_spiral_vase || ! m_spiral_vase->enable;
-    
-    std::string gcode;
-
-#if ENABLE_GCODE_VIEWER
-    // add tag for processor
-    gcode += "; " + GCodeProcessor::Layer_Change_Tag + "\n";
-    // export layer z
-    char buf[64];
-    sprintf(buf, ";Z:%g\n", print_z);
-    gcode += buf;
-    // export layer height
-    float height = first_layer ? static_cast<float>(print_z) : static_cast<float>(print_z) - m_last_layer_z;
-    sprintf(buf, ";%s%g\n", GCodeProcessor::Height_Tag.c_str(), height);
-    gcode += buf;
-    // update caches
-    m_last_layer_z = static_cast<float>(print_z);
-    m_last_height = height;
-#endif // ENABLE_GCODE_VIEWER
-
-    // Set new layer - this will change Z and force a retraction if retract_layer_change is enabled.
-    if (! print.config().before_layer_gcode.value.empty()) {
-        DynamicConfig config;
-        config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index + 1));
-        config.set_key_value("layer_z",   new ConfigOptionFloat(print_z));
-        gcode += this->placeholder_parser_process("before_layer_gcode",
-            print.config().before_layer_gcode.value, m_writer.extruder()->id(), &config)
-            + "\n";
-    }
-    gcode += this->change_layer(print_z);  // this will increase m_layer_index
-	m_layer = &layer;
-    if (! print.config().layer_gcode.value.empty()) {
-        DynamicConfig config;
-        config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index));
-        config.set_key_value("layer_z",   new ConfigOptionFloat(print_z));
-        gcode += this->placeholder_parser_process("layer_gcode",
-            print.config().layer_gcode.value, m_writer.extruder()->id(), &config)
-            + "\n";
-    }
-
-    if (! first_layer && ! m_second_layer_things_done) {
-        // Transition from 1st to 2nd layer. Adjust nozzle temperatures as prescribed by the nozzle dependent
-        // first_layer_temperature vs. temperature settings.
-        for (const Extruder &extruder : m_writer.extruders()) {
-            if (print.config().single_extruder_multi_material.value && extruder.id() != m_writer.extruder()->id())
-                // In single extruder multi material mode, set the temperature for the current extruder only.
-                continue;
-            int temperature = print.config().temperature.get_at(extruder.id());
-            if (temperature > 0 && temperature != print.config().first_layer_temperature.get_at(extruder.id()))
-                gcode += m_writer.set_temperature(temperature, false, extruder.id());
-        }
-        gcode += m_writer.set_bed_temperature(print.config().bed_temperature.get_at(first_extruder_id));
-        // Mark the temperature transition from 1st to 2nd layer to be finished.
-        m_second_layer_things_done = true;
-    }
-
-    // Map from extruder ID to <begin, end> index of skirt loops to be extruded with that extruder.
-    std::map<unsigned int, std::pair<size_t, size_t>> skirt_loops_per_extruder;
-
-    if (single_object_instance_idx == size_t(-1)) {
-        // Normal (non-sequential) print.
-        gcode += ProcessLayer::emit_custom_gcode_per_print_z(layer_tools.custom_gcode, first_extruder_id, print.config());
-    }
-    // Extrude skirt at the print_z of the raft layers and normal object layers
-    // not at the print_z of the interlaced support material layers.
-    skirt_loops_per_extruder = first_layer ?
-        Skirt::make_skirt_loops_per_extruder_1st_layer(print, layers, layer_tools, m_skirt_done) :
-        Skirt::make_skirt_loops_per_extruder_other_layers(print, layers, layer_tools, support_layer, m_skirt_done);
-
-    // Group extrusions by an extruder, then by an object, an island and a region.
-    std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
+    unsigned int first_extruder_id = layer_tools.extruders.front();
     bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
     for (const LayerToPrint &layer_to_print : layers) {
         if (layer_to_print.support_layer != nullptr) {
@@ -2315,6 +2349,141 @@ void GCode::process_layer(
         }
     } // for objects
 
+    return by_extruder;
+}
+
+// In sequential mode, process_layer is called once per each object and its copy, 
+// therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
+// In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
+// For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
+// and performing the extruder specific extrusions together.
+GCode::LayerResult GCode::process_layer(
+    const Print                    			&print,
+    // Set of object & print layers of the same PrintObject and with the same print_z.
+    const std::vector<LayerToPrint> 		&layers,
+    const LayerTools        		        &layer_tools,
+    // Extrusions of layers grouped by group_extrusions_by_extruder().
+    ObjectsByExtruder                       &by_extruder,
+	// Pairs of PrintObject index and its instance index.
+	const std::vector<const PrintInstance*> *ordering,
+    // If set to size_t(-1), then print all copies of all objects.
+    // Otherwise print a single copy of a single object.
+    const size_t                     		 single_object_instance_idx)
+{
+    assert(! layers.empty());
+    // Either printing all copies of all objects, or just a single copy of a single object.
+    assert(single_object_instance_idx == size_t(-1) || layers.size() == 1);
+
+    if (layer_tools.extruders.empty())
+        // Nothing to extrude.
+        return LayerResult::make_nop_layer_result();
+
+    // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
+    const Layer         *object_layer  = nullptr;
+    const SupportLayer  *support_layer = nullptr;
+    for (const LayerToPrint &l : layers) {
+        if (l.object_layer != nullptr && object_layer == nullptr)
+            object_layer = l.object_layer;
+        if (l.support_layer != nullptr && support_layer == nullptr)
+            support_layer = l.support_layer;
+    }
+    const Layer         &layer         = (object_layer != nullptr) ? *object_layer : *support_layer;
+    coordf_t             print_z       = layer.print_z;
+    bool                 first_layer   = layer.id() == 0;
+    unsigned int         first_extruder_id = layer_tools.extruders.front();
+
+    // Initialize config with the 1st object to be printed at this layer.
+    m_config.apply(layer.object()->config(), true);
+
+    LayerResult   result { std::string(), layer.id(), false };
+    std::string  &gcode = result.gcode;
+
+    // Check whether it is possible to apply the spiral vase logic for this layer.
+    // Just a reminder: A spiral vase mode is allowed for a single object, single material print only.
+    if (m_spiral_vase && layers.size() == 1 && support_layer == nullptr) {
+        bool enable = (layer.id() > 0 || print.config().brim_width.value == 0.) && (layer.id() >= (size_t)print.config().skirt_height.value && ! print.has_infinite_skirt());
+        if (enable) {
+            for (const LayerRegion *layer_region : layer.regions())
+                if (size_t(layer_region->region()->config().bottom_solid_layers.value) > layer.id() ||
+                    layer_region->perimeters.items_count() > 1u ||
+                    layer_region->fills.items_count() > 0) {
+                    enable = false;
+                    break;
+                }
+        }
+        // If we're going to apply spiralvase to this layer, disable loop clipping
+        m_enable_loop_clipping = ! enable;
+    }
+    // The spiral vase state is kept from the previous layer if it was not reevaluated above.
+    result.spiral_vase_enable = m_spiral_vase && ! m_enable_loop_clipping;
+
+#if ENABLE_GCODE_VIEWER
+    // add tag for processor
+    gcode += "; " + GCodeProcessor::Layer_Change_Tag + "\n";
+    // export layer z
+    char buf[64];
+    sprintf(buf, ";Z:%g\n", print_z);
+    gcode += buf;
+    // export layer height
+    float height = first_layer ? static_cast<float>(print_z) : static_cast<float>(print_z) - m_last_layer_z;
+    sprintf(buf, ";%s%g\n", GCodeProcessor::Height_Tag.c_str(), height);
+    gcode += buf;
+    // update caches
+    m_last_layer_z = static_cast<float>(print_z);
+    m_last_height = height;
+#endif // ENABLE_GCODE_VIEWER
+
+    // Set new layer - this will change Z and force a retraction if retract_layer_change is enabled.
+    if (! print.config().before_layer_gcode.value.empty()) {
+        DynamicConfig config;
+        config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index + 1));
+        config.set_key_value("layer_z",   new ConfigOptionFloat(print_z));
+        gcode += this->placeholder_parser_process("before_layer_gcode",
+            print.config().before_layer_gcode.value, m_writer.extruder()->id(), &config)
+            + "\n";
+    }
+    gcode += this->change_layer(print_z);  // this will increase m_layer_index
+	m_layer = &layer;
+    if (! print.config().layer_gcode.value.empty()) {
+        DynamicConfig config;
+        config.set_key_value("layer_num", new ConfigOptionInt(m_layer_index));
+        config.set_key_value("layer_z",   new ConfigOptionFloat(print_z));
+        gcode += this->placeholder_parser_process("layer_gcode",
+            print.config().layer_gcode.value, m_writer.extruder()->id(), &config)
+            + "\n";
+    }
+
+    if (! first_layer && ! m_second_layer_things_done) {
+        // Transition from 1st to 2nd layer. Adjust nozzle temperatures as prescribed by the nozzle dependent
+        // first_layer_temperature vs. temperature settings.
+        for (const Extruder &extruder : m_writer.extruders()) {
+            if (print.config().single_extruder_multi_material.value && extruder.id() != m_writer.extruder()->id())
+                // In single extruder multi material mode, set the temperature for the current extruder only.
+                continue;
+            int temperature = print.config().temperature.get_at(extruder.id());
+            if (temperature > 0 && temperature != print.config().first_layer_temperature.get_at(extruder.id()))
+                gcode += m_writer.set_temperature(temperature, false, extruder.id());
+        }
+        gcode += m_writer.set_bed_temperature(print.config().bed_temperature.get_at(first_extruder_id));
+        // Mark the temperature transition from 1st to 2nd layer to be finished.
+        m_second_layer_things_done = true;
+    }
+
+    // Map from extruder ID to <begin, end> index of skirt loops to be extruded with that extruder.
+    std::map<unsigned int, std::pair<size_t, size_t>> skirt_loops_per_extruder;
+
+    if (single_object_instance_idx == size_t(-1)) {
+        // Normal (non-sequential) print.
+        gcode += ProcessLayer::emit_custom_gcode_per_print_z(layer_tools.custom_gcode, first_extruder_id, print.config());
+    }
+    // Extrude skirt at the print_z of the raft layers and normal object layers
+    // not at the print_z of the interlaced support material layers.
+    skirt_loops_per_extruder = first_layer ?
+        Skirt::make_skirt_loops_per_extruder_1st_layer(print, layers, layer_tools, m_skirt_done) :
+        Skirt::make_skirt_loops_per_extruder_other_layers(print, layers, layer_tools, support_layer, m_skirt_done);
+
+    bool is_anything_overridden = const_cast<LayerTools&>(layer_tools).wiping_extrusions().is_anything_overridden();
+
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
     std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
     for (unsigned int extruder_id : layer_tools.extruders)
@@ -2423,35 +2592,6 @@ void GCode::process_layer(
         }
     }
 
-    // Apply spiral vase post-processing if this layer contains suitable geometry
-    // (we must feed all the G-code into the post-processor, including the first 
-    // bottom non-spiral layers otherwise it will mess with positions)
-    // we apply spiral vase at this stage because it requires a full layer.
-    // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
-    if (m_spiral_vase)
-        gcode = m_spiral_vase->process_layer(gcode);
-
-    // Apply cooling logic; this may alter speeds.
-    if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(gcode, layer.id());
-
-#if !ENABLE_GCODE_VIEWER
-    // add tag for analyzer
-    if (gcode.find(GCodeAnalyzer::Pause_Print_Tag) != gcode.npos)
-        gcode += "\n; " + GCodeAnalyzer::End_Pause_Print_Or_Custom_Code_Tag + "\n";
-    else if (gcode.find(GCodeAnalyzer::Custom_Code_Tag) != gcode.npos)
-        gcode += "\n; " + GCodeAnalyzer::End_Pause_Print_Or_Custom_Code_Tag + "\n";
-#endif // !ENABLE_GCODE_VIEWER
-
-#ifdef HAS_PRESSURE_EQUALIZER
-    // Apply pressure equalization if enabled;
-    // printf("G-code before filter:\n%s\n", gcode.c_str());
-    if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
-    // printf("G-code after filter:\n%s\n", out.c_str());
-#endif /* HAS_PRESSURE_EQUALIZER */
-    
-    _write(file, gcode);
 #if !ENABLE_GCODE_VIEWER
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
         ", time estimator memory: " <<
@@ -2460,6 +2600,8 @@ void GCode::process_layer(
             format_memsize_MB(m_analyzer.memory_used()) <<
             log_memory_info();
 #endif // !ENABLE_GCODE_VIEWER
+
+    return result;
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
@@ -3047,11 +3189,12 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
         			extrusions.emplace_back(ee);
         	if (! extrusions.empty()) {
 	            m_config.apply(print.regions()[&region - &by_region.front()]->config());
-			    chain_and_reorder_extrusion_entities(extrusions, &m_last_pos);
+	            size_t cluster_size = size_t(m_config.chain_cluster_size.value);
+			    chain_and_reorder_extrusion_entities(extrusions, &m_last_pos, cluster_size);
 	            for (const ExtrusionEntity *fill : extrusions) {
 	                auto *eec = dynamic_cast<const ExtrusionEntityCollection*>(fill);
 	                if (eec) {
-					    for (ExtrusionEntity *ee : eec->chained_path_from(m_last_pos).entities)
+					    for (ExtrusionEntity *ee : eec->chained_path_from(m_last_pos, erMixed, cluster_size).entities)
 	                        gcode += this->extrude_entity(*ee, extrusion_name);
 	                } else
 	                    gcode += this->extrude_entity(*fill, extrusion_name);
@@ -3088,7 +3231,84 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
     return gcode;
 }
 
-void GCode::_write(FILE* file, const char *what)
+bool GCode::GCodeOutputStream::flush()
+{
+    this->flush_buffer();
+    return f != nullptr && ::fflush(f) == 0;
+}
+
+void GCode::GCodeOutputStream::close()
+{
+    if (f != nullptr) {
+        this->flush_buffer();
+        ::fclose(f);
+        f = nullptr;
+    }
+}
+
+bool GCode::GCodeOutputStream::is_error() const
+{
+    return f != nullptr && ::ferror(f);
+}
+
+void GCode::GCodeOutputStream::write(const char *what, size_t len)
+{
+    if (len == 0)
+        return;
+    m_bytes_written += len;
+#if ENABLE_GCODE_VIEWER
+    if (m_processor != nullptr)
+        m_processor->process_buffer(what, len);
+#endif // ENABLE_GCODE_VIEWER
+    if (m_buffer.size() + len > m_buffer.capacity()) {
+        this->flush_buffer();
+        if (len >= m_buffer.capacity()) {
+            // Large block, write it directly without copying it into the buffer.
+            ::fwrite(what, 1, len, f);
+            return;
+        }
+    }
+    m_buffer.insert(m_buffer.end(), what, what + len);
+}
+
+void GCode::GCodeOutputStream::write_format(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char buffer[1024];
+    va_list args2;
+    va_copy(args2, args);
+    int res = ::vsnprintf(buffer, sizeof(buffer), format, args2);
+    va_end(args2);
+    if (res >= int(sizeof(buffer))) {
+        // The formatted string does not fit the stack buffer.
+        std::string s(res, 0);
+        ::vsnprintf(s.data(), size_t(res) + 1, format, args);
+        this->write(s);
+    } else if (res > 0)
+        this->write(buffer, size_t(res));
+    va_end(args);
+}
+
+void GCode::GCodeOutputStream::flush_buffer()
+{
+    if (! m_buffer.empty()) {
+        ::fwrite(m_buffer.data(), 1, m_buffer.size(), f);
+        m_buffer.clear();
+    }
+}
+
+void GCode::_write(GCodeOutputStream &file, const std::string &what)
+{
+#if ENABLE_GCODE_VIEWER
+    // The length of the string is known, don't scan for the terminating zero.
+    file.write(what);
+#else
+    this->_write(file, what.c_str());
+#endif // ENABLE_GCODE_VIEWER
+}
+
+void GCode::_write(GCodeOutputStream &file, const char *what)
 {
     if (what != nullptr) {
 #if ENABLE_GCODE_VIEWER
@@ -3099,7 +3319,7 @@ void GCode::_write(FILE* file, const char *what)
 #endif // !ENABLE_GCODE_VIEWER
 
         // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), file);
+        file.write(gcode);
 #if !ENABLE_GCODE_VIEWER
         // updates time estimator and gcode lines vector
         m_normal_time_estimator.add_gcode_block(gcode);
@@ -3109,13 +3329,13 @@ void GCode::_write(FILE* file, const char *what)
     }
 }
 
-void GCode::_writeln(FILE* file, const std::string &what)
+void GCode::_writeln(GCodeOutputStream &file, const std::string &what)
 {
     if (! what.empty())
         _write(file, (what.back() == '\n') ? what : (what + '\n'));
 }
 
-void GCode::_write_format(FILE* file, const char* format, ...)
+void GCode::_write_format(GCodeOutputStream &file, const char* format, ...)
 {
     va_list args;
     va_start(args, format);
@@ -22,6 +22,8 @@
 #include "EdgeGrid.hpp"
 #include "GCode/ThumbnailData.hpp"
 
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -55,9 +57,9 @@ public:
     AvoidCrossingPerimeters() : use_external_mp(false), use_external_mp_once(false), disable_once(true) {}
     ~AvoidCrossingPerimeters() {}
 
-    void reset() { m_external_mp.reset(); m_layer_mp.reset(); }
+    void reset() { m_external_mp.reset(); m_layer_mp.reset(); m_layer_islands.clear(); }
 	void init_external_mp(const Print &print);
-    void init_layer_mp(const ExPolygons &islands) { m_layer_mp = Slic3r::make_unique<MotionPlanner>(islands); }
+    void init_layer_mp(ExPolygons &&islands);
 
     Polyline travel_to(const GCode &gcodegen, const Point &point);
 
@@ -67,6 +69,8 @@ private:
 
     std::unique_ptr<MotionPlanner> m_external_mp;
     std::unique_ptr<MotionPlanner> m_layer_mp;
+    // Islands of the current layer. The layer motion planner is created from them lazily on the first travel move planned over the layer.
+    ExPolygons                     m_layer_islands;
 };
 
 class OozePrevention {
@@ -238,17 +242,99 @@ public:
     };
 
 private:
-    void            _do_export(Print &print, FILE *file, ThumbnailsGeneratorCallback thumbnail_cb);
+    // Buffered output of the G-code into a file.
+    // The G-code is collected into a large memory buffer, which is written into the file in big blocks,
+    // so that the export is not dominated by many small fwrite() calls of single lines.
+    class GCodeOutputStream {
+    public:
+        GCodeOutputStream(FILE *f, size_t buffer_size = 4 * 1024 * 1024) : f(f) { m_buffer.reserve(buffer_size); }
+        ~GCodeOutputStream() { this->close(); }
+
+        bool is_open() const { return f; }
+        // Flushes the internal buffer and the stdio buffer of the file.
+        bool flush();
+        // Flushes the internal buffer and closes the file.
+        void close();
+        // Returns true if writing into the file failed.
+        bool is_error() const;
+
+        // Write a string into the output buffer.
+        void write(const std::string &what) { this->write(what.data(), what.size()); }
+        void write(const char *what) { if (what != nullptr) this->write(what, ::strlen(what)); }
+        void write(const char *what, size_t len);
+        // Formats and writes into the output buffer the given data.
+        void write_format(const char* format, ...);
+        // Number of bytes written into this stream since it has been opened.
+        size_t bytes_written() const { return m_bytes_written; }
+#if ENABLE_GCODE_VIEWER
+        // All the G-code written into this stream is passed to the processor as well,
+        // so that the G-code does not need to be read back from the file to estimate the print time.
+        void set_processor(GCodeProcessor *processor) { m_processor = processor; }
+#endif // ENABLE_GCODE_VIEWER
+
+    private:
+        FILE                *f = nullptr;
+        // Block of G-code not yet written into the file.
+        std::vector<char>    m_buffer;
+        size_t               m_bytes_written { 0 };
+#if ENABLE_GCODE_VIEWER
+        GCodeProcessor      *m_processor { nullptr };
+#endif // ENABLE_GCODE_VIEWER
+
+        void flush_buffer();
+    };
+
+    void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
-    void            process_layer(
-        // Write into the output file.
-        FILE                            *file,
+
+    // G-code of a single layer as produced by process_layer(), before being post-processed
+    // by the spiral vase, the cooling buffer and the pressure equalizer.
+    struct LayerResult {
+        std::string gcode;
+        // Index of the layer, passed to the CoolingBuffer. size_t(-1) if nothing was generated for this layer.
+        size_t      layer_id;
+        // Is spiral vase post-processing enabled for this layer?
+        bool        spiral_vase_enable { false };
+        bool        empty() const { return layer_id == size_t(-1); }
+        static LayerResult make_nop_layer_result() { return { std::string(), size_t(-1), false }; }
+    };
+    // Export layers in a pipeline: G-code generation by process_layer(), post-processing (spiral vase, cooling buffer,
+    // pressure equalizer) and writing into the output file run concurrently, each stage processing the layers in order.
+    // Normal (non-sequential) print: all objects with the same print_z are printed together.
+    void            process_layers(
+        const Print                                                         &print,
+        const ToolOrdering                                                  &tool_ordering,
+        const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
+        const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+        GCodeOutputStream                                                   &file);
+    // Sequential print: a single instance of a single object is printed.
+    void            process_layers(
+        const Print                                                         &print,
+        const ToolOrdering                                                  &tool_ordering,
+        const std::vector<LayerToPrint>                                     &layers_to_print,
+        const size_t                                                         single_object_idx,
+        GCodeOutputStream                                                   &file);
+    // Post-process the G-code of a single layer, to be called in the layer order.
+    std::string     post_process_layer(LayerResult &&layer_result);
+    // Extrusions of a single print_z grouped by an extruder, then by an object, an island and a region.
+    struct ObjectByExtruder;
+    using ObjectsByExtruder = std::map<unsigned int, std::vector<ObjectByExtruder>>;
+    // The grouping does not depend on the state of the G-code generator, therefore process_layers() calculates it
+    // for the upcoming layers in parallel, while process_layer() emits the preceding layers.
+    static ObjectsByExtruder group_extrusions_by_extruder(
+        const Print                     &print,
+        // Set of object & print layers of the same PrintObject and with the same print_z.
+        const std::vector<LayerToPrint> &layers,
+        const LayerTools                &layer_tools);
+    LayerResult     process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
         const LayerTools  				&layer_tools,
+        // Extrusions of layers grouped by group_extrusions_by_extruder().
+        ObjectsByExtruder               &by_extruder,
 		// Pairs of PrintObject index and its instance index.
 		const std::vector<const PrintInstance*> *ordering,
         // If set to size_t(-1), then print all copies of all objects.
@@ -430,21 +516,21 @@ private:
 #endif // ENABLE_GCODE_VIEWER
 
     // Write a string into a file.
-    void _write(FILE* file, const std::string& what) { this->_write(file, what.c_str()); }
-    void _write(FILE* file, const char *what);
+    void _write(GCodeOutputStream &file, const std::string& what);
+    void _write(GCodeOutputStream &file, const char *what);
 
     // Write a string into a file. 
     // Add a newline, if the string does not end with a newline already.
     // Used to export a custom G-code section processed by the PlaceholderParser.
-    void _writeln(FILE* file, const std::string& what);
+    void _writeln(GCodeOutputStream &file, const std::string& what);
 
     // Formats and write into a file the given data. 
-    void _write_format(FILE* file, const char* format, ...);
+    void _write_format(GCodeOutputStream &file, const char* format, ...);
 
     std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
-    void print_machine_envelope(FILE *file, Print &print);
-    void _print_first_layer_bed_temperature(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
-    void _print_first_layer_extruder_temperatures(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    void print_machine_envelope(GCodeOutputStream &file, Print &print);
+    void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    void _print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
     // this flag triggers first layer speeds
     bool                                on_first_layer() const { return m_layer != nullptr && m_layer->id() == 0; }
 
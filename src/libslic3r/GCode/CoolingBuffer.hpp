@@ -2,6 +2,7 @@
 #define slic3r_CoolingBuffer_hpp_
 
 #include "../libslic3r.h"
+#include "../PrintConfig.hpp"
 #include <map>
 #include <string>
 
@@ -20,6 +21,11 @@ struct PerExtruderAdjustments;
 // For example, some materials may not like to print too slowly, while with some materials 
 // we may slow down significantly.
 //
+// The CoolingBuffer is run as a post-processing stage of the G-code export pipeline, concurrently with the G-code
+// generator working on the following layers. Therefore the configuration, the extruder IDs and the toolchange prefix
+// are captured at construction and the generator state is not read while processing a layer.
+// The only shared state is the fan speed of GCodeWriter, which is not touched by the generator while exporting layers.
+//
 class CoolingBuffer {
 public:
     CoolingBuffer(GCode &gcodegen);
@@ -37,6 +43,14 @@ private:
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
 
     GCode&              m_gcodegen;
+    // Copy of the G-code generator configuration at the time the CoolingBuffer was created.
+    const FullPrintConfig m_config;
+    // Prefix of the toolchange G-code line, see GCodeWriter::toolchange_prefix().
+    const std::string   m_toolchange_prefix;
+    // IDs of the extruders used by the print, sorted in an increasing order.
+    std::vector<unsigned int> m_extruder_ids;
+    // Maximum extruder ID + 1.
+    unsigned int        m_num_extruders { 0 };
     std::string         m_gcode;
     // Internal data.
     // X,Y,Z,E,F
@@ -4,7 +4,6 @@
 #include "GCodeProcessor.hpp"
 
 #include <boost/log/trivial.hpp>
-#include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
 
 #include <float.h>
@@ -12,6 +11,7 @@
 
 #if ENABLE_GCODE_VIEWER
 #include <chrono>
+#include <string_view>
 
 static const float INCHES_TO_MM = 25.4f;
 static const float MMMIN_TO_MMSEC = 1.0f / 60.0f;
@@ -317,15 +317,17 @@ void GCodeProcessor::TimeProcessor::reset()
 
 void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
 {
-    boost::nowide::ifstream in(filename);
-    if (!in.good())
+    FILE* in = boost::nowide::fopen(filename.c_str(), "rb");
+    if (in == nullptr)
         throw std::runtime_error(std::string("Time estimator post process export failed.\nCannot open file for reading.\n"));
 
     // temporary file to contain modified gcode
     std::string out_path = filename + ".postprocess";
     FILE* out = boost::nowide::fopen(out_path.c_str(), "wb");
-    if (out == nullptr)
+    if (out == nullptr) {
+        fclose(in);
         throw std::runtime_error(std::string("Time estimator post process export failed.\nCannot open file for writing.\n"));
+    }
 
     auto time_in_minutes = [](float time_in_seconds) {
         return int(::roundf(time_in_seconds / 60.0f));
@@ -339,8 +341,6 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
         return std::string(line_M73);
     };
 
-    GCodeReader parser;
-    std::string gcode_line;
     size_t g1_lines_counter = 0;
     // keeps track of last exported pair <percent, remaining time>
     std::array<std::pair<int, int>, static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count)> last_exported;
@@ -352,10 +352,8 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
     std::string export_line;
 
     // replace placeholder lines with the proper final value
-    auto process_placeholders = [&](const std::string& gcode_line) {
-        // remove trailing '\n'
-        std::string line = gcode_line.substr(0, gcode_line.length() - 1);
-
+    // line does not contain the trailing '\n'
+    auto process_placeholders = [&](const std::string_view line) {
         std::string ret;
 
         if (line == First_Line_M73_Placeholder_Tag || line == Last_Line_M73_Placeholder_Tag) {
@@ -381,17 +379,26 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
             }
         }
 
-        return std::make_pair(!ret.empty(), ret.empty() ? gcode_line : ret);
+        return ret;
     };
 
     // check for temporary lines
-    auto is_temporary_decoration = [](const std::string& gcode_line) {
-        // remove trailing '\n'
-        std::string line = gcode_line.substr(0, gcode_line.length() - 1);
-        if (line == "; " + Layer_Change_Tag)
-            return true;
-        else
+    const std::string layer_change_decoration = "; " + Layer_Change_Tag;
+    auto is_temporary_decoration = [&layer_change_decoration](const std::string_view line) {
+        return line == layer_change_decoration;
+    };
+
+    // same test as GCodeReader::GCodeLine::cmd_is("G1"), without parsing the whole line
+    auto is_G1 = [](const std::string_view line) {
+        size_t i = 0;
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t'))
+            ++i;
+        if (line.size() < i + 2 || line[i] != 'G' || line[i + 1] != '1')
             return false;
+        if (line.size() == i + 2)
+            return true;
+        char c = line[i + 2];
+        return c == ' ' || c == '\t' || c == ';' || c == '\r' || c == '\n';
     };
 
     // add lines M73 to exported gcode
@@ -415,7 +422,7 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
     auto write_string = [&](const std::string& str) {
         fwrite((const void*)export_line.c_str(), 1, export_line.length(), out);
         if (ferror(out)) {
-            in.close();
+            fclose(in);
             fclose(out);
             boost::nowide::remove(out_path.c_str());
             throw std::runtime_error(std::string("Time estimator post process export failed.\nIs the disk full?\n"));
@@ -423,41 +430,67 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename)
         export_line.clear();
     };
 
-    while (std::getline(in, gcode_line)) {
-        if (!in.good()) {
-            fclose(out);
-            throw std::runtime_error(std::string("Time estimator post process export failed.\nError while reading from file.\n"));
-        }
-
-        gcode_line += "\n";
+    // the lines are split at '\n' the same way std::getline() does, each line is exported terminated by '\n'
+    auto process_line = [&](const std::string_view line) {
         // replace placeholder lines
-        auto [processed, result] = process_placeholders(gcode_line);
-        gcode_line = result;
-        if (!processed) {
+        std::string placeholder = process_placeholders(line);
+        if (!placeholder.empty())
+            export_line += placeholder;
+        else {
             // remove temporary lines
-            if (is_temporary_decoration(gcode_line))
-                continue;
+            if (is_temporary_decoration(line))
+                return;
 
             // add lines M73 where needed
-            parser.parse_line(gcode_line,
-                [&](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
-                    if (line.cmd_is("G1")) {
-                        process_line_G1();
-                        ++g1_lines_counter;
-                    }
-                });
-        }
+            if (is_G1(line)) {
+                process_line_G1();
+                ++g1_lines_counter;
+            }
 
-        export_line += gcode_line;
+            export_line.append(line.data(), line.size());
+            export_line += '\n';
+        }
         if (export_line.length() > 65535)
             write_string(export_line);
+    };
+
+    // the file is read in large blocks, thus there is no allocation per line
+    static constexpr const size_t block_size = 4 * 1024 * 1024;
+    std::vector<char> buffer(block_size);
+    // number of bytes of an incomplete line carried over from the previous block
+    size_t num_carried = 0;
+    for (;;) {
+        if (num_carried + block_size > buffer.size())
+            // a single line longer than the block
+            buffer.resize(num_carried + block_size);
+        size_t num_read = ::fread(buffer.data() + num_carried, 1, block_size, in);
+        if (num_read == 0) {
+            if (ferror(in)) {
+                fclose(in);
+                fclose(out);
+                boost::nowide::remove(out_path.c_str());
+                throw std::runtime_error(std::string("Time estimator post process export failed.\nError while reading from file.\n"));
+            }
+            // end of file, process the last line not terminated by a newline
+            if (num_carried > 0)
+                process_line(std::string_view(buffer.data(), num_carried));
+            break;
+        }
+        const char* begin = buffer.data();
+        const char* end = begin + num_carried + num_read;
+        for (const char* eol; (eol = static_cast<const char*>(memchr(begin, '\n', end - begin))) != nullptr; begin = eol + 1) {
+            process_line(std::string_view(begin, eol - begin));
+        }
+        // move the incomplete line to the start of the buffer
+        num_carried = end - begin;
+        memmove(buffer.data(), begin, num_carried);
     }
 
     if (!export_line.empty())
         write_string(export_line);
 
     fclose(out);
-    in.close();
+    fclose(in);
 
     if (rename_file(out_path, filename))
         throw std::runtime_error(std::string("Failed to rename the output G-code file from ") + out_path + " to " + filename + '\n' +
@@ -716,6 +749,7 @@ void GCodeProcessor::reset()
     m_producers_enabled = false;
 
     m_time_processor.reset();
+    m_unterminated_line.clear();
 
     m_result.reset();
     m_result.id = ++s_result_id;
@@ -758,9 +792,7 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     }
 
     // process gcode
-    m_result.id = ++s_result_id;
-    // 1st move must be a dummy move
-    m_result.moves.emplace_back(MoveVertex());
+    this->initialize();
     m_parser.parse_file(filename, [this, cancel_callback, &last_cancel_callback_time](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (cancel_callback != nullptr) {
             // call the cancel callback every 100 ms
@@ -772,6 +804,53 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
         }
         process_gcode_line(line);
         });
+    this->finalize(filename);
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+}
+
+void GCodeProcessor::initialize()
+{
+    m_result.id = ++s_result_id;
+    // 1st move must be a dummy move
+    m_result.moves.emplace_back(MoveVertex());
+    m_unterminated_line.clear();
+}
+
+void GCodeProcessor::process_buffer(const char* data, size_t length)
+{
+    auto process_line = [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); };
+    const char* end = data + length;
+    GCodeReader::GCodeLine gline;
+    if (!m_unterminated_line.empty()) {
+        // complete the line started by the previous block
+        const char* eol = static_cast<const char*>(memchr(data, '\n', length));
+        if (eol == nullptr) {
+            m_unterminated_line.append(data, end);
+            return;
+        }
+        m_unterminated_line.append(data, eol + 1);
+        m_parser.parse_line(m_unterminated_line.c_str(), gline, process_line);
+        m_unterminated_line.clear();
+        data = eol + 1;
+    }
+    // the lines are parsed in place, the parser stops at the end of each line
+    for (const char* eol; (eol = static_cast<const char*>(memchr(data, '\n', end - data))) != nullptr; data = eol + 1) {
+        gline.reset();
+        m_parser.parse_line(data, gline, process_line);
+    }
+    m_unterminated_line.assign(data, end);
+}
+
+void GCodeProcessor::finalize(const std::string& filename)
+{
+    // process the last line, if not terminated by a newline
+    if (!m_unterminated_line.empty()) {
+        m_parser.parse_line(m_unterminated_line, [this](GCodeReader& reader, const GCodeReader::GCodeLine& line) { process_gcode_line(line); });
+        m_unterminated_line.clear();
+    }
 
     // process the time blocks
     for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedTimeStatistics::ETimeMode::Count); ++i) {
@@ -794,10 +873,6 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_height_compare.output();
     m_width_compare.output();
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
-
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    m_result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
 }
 
 float GCodeProcessor::get_time(PrintEstimatedTimeStatistics::ETimeMode mode) const
@@ -352,6 +352,8 @@ namespace Slic3r {
 
     private:
         GCodeReader m_parser;
+        // Tail of the last block passed to process_buffer(), which was not terminated by a newline yet.
+        std::string m_unterminated_line;
 
         EUnits m_units;
         EPositioningType m_global_positioning_type;
@@ -422,6 +424,15 @@ namespace Slic3r {
         // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
         void process_file(const std::string& filename, std::function<void()> cancel_callback = nullptr);
 
+        // Process the gcode while it is being generated, without reading it back from the file:
+        // initialize() is to be called after reset() and apply_config(), then process_buffer() with consecutive blocks of the gcode
+        // as they are written into the file. Blocks do not need to be aligned to lines.
+        // finalize() calculates the times and post-processes the file with the given filename to add lines M73 into it.
+        void initialize();
+        void process_buffer(const char* data, size_t length);
+        void process_buffer(const std::string& data) { this->process_buffer(data.data(), data.size()); }
+        void finalize(const std::string& filename);
+
         float get_time(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::string get_time_dhm(PrintEstimatedTimeStatistics::ETimeMode mode) const;
         std::vector<std::pair<CustomGCode::Type, std::pair<float, float>>> get_custom_gcode_times(PrintEstimatedTimeStatistics::ETimeMode mode, bool include_remaining) const;
@@ -16,7 +16,7 @@ std::string SpiralVase::process_layer(const std::string &gcode)
     
     // If we're not going to modify G-code, just feed it to the reader
     // in order to update positions.
-    if (! this->enable) {
+    if (! m_enabled) {
         m_reader.parse_buffer(gcode);
         return gcode;
     }
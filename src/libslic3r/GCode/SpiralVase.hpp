@@ -8,17 +8,19 @@ namespace Slic3r {
 
 class SpiralVase {
 public:
-    bool enable = false;
-    
     SpiralVase(const PrintConfig &config) : m_config(&config)
     {
         m_reader.z() = (float)m_config->z_offset;
         m_reader.apply_config(*m_config);
     };
+    // Enable or disable the spiral vase post-processing of the following layers.
+    // Set by the post-processing stage of the G-code export pipeline from GCode::LayerResult.
+    void        enable(bool en) { m_enabled = en; }
     std::string process_layer(const std::string &gcode);
     
 private:
     const PrintConfig  *m_config;
+    bool                m_enabled = false;
     GCodeReader 		m_reader;
 };
 
@@ -1,7 +1,8 @@
 #include "GCodeReader.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
-#include <fstream>
+#include <boost/nowide/cstdio.hpp>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
@@ -21,6 +22,47 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = m_config.get_extrusion_axis()[0];
 }
 
+// Parse a decimal number of the form [+-]digits[.digits], as emitted by the G-code generators, without calling strtod().
+// If the mantissa fits 53 bits and there are at most 22 decimal digits, both the mantissa and the power of ten
+// are exact doubles and their quotient is correctly rounded, therefore the result is the same as that of strtod().
+// Returns a pointer past the number, or nullptr if the number is not in the simple format or it is not followed
+// by the end of a word. Then the caller shall fall back to strtod().
+static const char* parse_decimal_fast(const char *c, double &out)
+{
+    static constexpr const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    bool negative = false;
+    if (*c == '-' || *c == '+')
+        negative = *c ++ == '-';
+    uint64_t mantissa   = 0;
+    int      num_digits = 0;
+    int      num_decimals = 0;
+    for (; *c >= '0' && *c <= '9'; ++ c, ++ num_digits)
+        mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (*c == '.')
+        for (++ c; *c >= '0' && *c <= '9'; ++ c, ++ num_digits, ++ num_decimals)
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (num_digits == 0 || num_digits > 15 || num_decimals > 22 ||
+        ! (*c == ' ' || *c == '\t' || *c == ';' || *c == '\r' || *c == '\n' || *c == 0))
+        // Empty, too long for the mantissa to fit 53 bits, exponential format or not terminated by the end of a word.
+        return nullptr;
+    double v = double(mantissa) / pow10[num_decimals];
+    out = negative ? - v : v;
+    return c;
+}
+
+const char* GCodeReader::parse_axis_value(const char *c, double &out)
+{
+    if (const char *end = parse_decimal_fast(c, out); end != nullptr)
+        return end;
+    // strtod() skips leading whitespaces including newlines, thus it would parse the next line of "G1 X\n",
+    // possibly past the end of the block being parsed. Parse a zero terminated copy of the word instead.
+    std::string word(c, skip_word(c));
+    char *pend = nullptr;
+    out = strtod(word.c_str(), &pend);
+    return c + (pend - word.c_str());
+}
+
 const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
@@ -56,8 +98,8 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
             }
             if (axis != NUM_AXES_WITH_UNKNOWN) {
                 // Try to parse the numeric value.
-                char   *pend = nullptr;
-                double  v = strtod(++ c, &pend);
+                double      v;
+                const char *pend = parse_axis_value(++ c, v);
                 if (pend != nullptr && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
@@ -113,15 +155,65 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 
 void GCodeReader::parse_file(const std::string &file, callback_t callback)
 {
-    std::ifstream f(file);
-    std::string line;
+    FILE *f = boost::nowide::fopen(file.c_str(), "rb");
+    if (f == nullptr)
+        return;
+
+    // The file is read in large blocks. The lines are split at '\n' the same way std::getline() does
+    // and they are parsed in place, reusing a single GCodeLine, thus there is no allocation per line.
+    static constexpr const size_t block_size = 4 * 1024 * 1024;
+    // One more character for the terminating zero of the last line, if the file does not end with a newline.
+    std::vector<char> buffer(block_size + 1);
+    // Number of bytes of an incomplete line carried over from the previous block.
+    size_t            num_carried = 0;
+    GCodeLine         gline;
+    std::pair<const char*, const char*> cmd;
+    auto parse_one_line = [this, &gline, &cmd, &callback](const char *line) {
+        gline.reset();
+        this->parse_line_internal(line, gline, cmd);
+        callback(*this, gline);
+        this->update_coordinates(gline, cmd);
+    };
 #if ENABLE_GCODE_VIEWER
     m_parsing_file = true;
-    while (m_parsing_file && std::getline(f, line))
-#else
-    while (std::getline(f, line))
 #endif // ENABLE_GCODE_VIEWER
-        this->parse_line(line, callback);
+    for (;;) {
+        if (num_carried + block_size + 1 > buffer.size())
+            // The buffer has to hold the incomplete line carried over from the previous block, followed by the next block
+            // and by the terminating zero of the last line. The carried line only grows past the initial buffer size
+            // if a single line is longer than a block.
+            buffer.resize(num_carried + block_size + 1);
+        size_t      num_read = ::fread(buffer.data() + num_carried, 1, block_size, f);
+        const char *begin    = buffer.data();
+        const char *end      = begin + num_carried + num_read;
+        if (num_read == 0) {
+            // End of file. Parse the last line not terminated by a newline.
+            if (num_carried > 0
+#if ENABLE_GCODE_VIEWER
+                && m_parsing_file
+#endif // ENABLE_GCODE_VIEWER
+                ) {
+                buffer[num_carried] = 0;
+                parse_one_line(begin);
+            }
+            break;
+        }
+        for (const char *eol; (eol = static_cast<const char*>(memchr(begin, '\n', end - begin))) != nullptr; begin = eol + 1) {
+#if ENABLE_GCODE_VIEWER
+            if (! m_parsing_file)
+                break;
+#endif // ENABLE_GCODE_VIEWER
+            parse_one_line(begin);
+        }
+#if ENABLE_GCODE_VIEWER
+        if (! m_parsing_file)
+            break;
+#endif // ENABLE_GCODE_VIEWER
+        // Move the incomplete line to the start of the buffer.
+        num_carried = end - begin;
+        memmove(buffer.data(), begin, num_carried);
+    }
+    ::fclose(f);
 }
 
 bool GCodeReader::GCodeLine::has(char axis) const
@@ -162,8 +254,8 @@ bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
         // Check the name of the axis.
         if (*c == axis) {
             // Try to parse the numeric value.
-            char   *pend = nullptr;
-            double  v = strtod(++ c, &pend);
+            double      v;
+            const char *pend = parse_axis_value(++ c, v);
             if (pend != nullptr && is_end_of_word(*pend)) {
                 // The axis value has been parsed correctly.
                 value = float(v);
@@ -143,6 +143,8 @@ private:
             ; // silence -Wempty-body
         return c;
     }
+    // Parse the numeric value of an axis up to the end of the word, return a pointer past the number.
+    static const char*  parse_axis_value(const char *c, double &out);
 
     GCodeConfig m_config;
     char        m_extrusion_axis;
@@ -1,6 +1,7 @@
 #include "GCodeWriter.hpp"
 #include "CustomGCode.hpp"
 #include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -9,12 +10,87 @@
 #define FLAVOR_IS(val) this->config.gcode_flavor == val
 #define FLAVOR_IS_NOT(val) this->config.gcode_flavor != val
 #define COMMENT(comment) if (this->config.gcode_comments && !comment.empty()) gcode << " ; " << comment;
-#define PRECISION(val, precision) std::fixed << std::setprecision(precision) << val
+#define PRECISION(val, precision) FixedNumber{ val, precision }
 #define XYZF_NUM(val) PRECISION(val, 3)
 #define E_NUM(val) PRECISION(val, 5)
 
 namespace Slic3r {
 
+void append_fixed(std::string &out, double value, int precision)
+{
+    static constexpr const double pow10[] = { 1., 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    assert(precision >= 0 && precision <= 9);
+    double scaled = std::abs(value) * pow10[precision];
+    // Up to 1e9, the error of the scaled value is below 1e-7, thus the last digit is rounded correctly
+    // unless the scaled value is very close to a tie. Ties and large or non-finite numbers are formatted by the stream.
+    if (scaled < 1e9) {
+        double ipart = std::floor(scaled);
+        double frac  = scaled - ipart;
+        if (std::abs(frac - 0.5) > 1e-6) {
+            uint64_t n = uint64_t(ipart) + (frac > 0.5 ? 1 : 0);
+            // Collect the digits in a reverse order, at least one digit before the decimal point.
+            char  digits[24];
+            char *d = digits;
+            for (int i = 0; i <= precision || n > 0; ++ i) {
+                *d ++ = char('0' + n % 10);
+                n /= 10;
+            }
+            char  buf[32];
+            char *ptr = buf;
+            if (std::signbit(value))
+                *ptr ++ = '-';
+            while (d > digits + precision)
+                *ptr ++ = *(-- d);
+            if (precision > 0) {
+                *ptr ++ = '.';
+                while (d > digits)
+                    *ptr ++ = *(-- d);
+            }
+            out.append(buf, ptr - buf);
+            return;
+        }
+    }
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << std::fixed << std::setprecision(precision) << value;
+    out += ss.str();
+}
+
+namespace {
+    struct FixedNumber {
+        double value;
+        int    precision;
+    };
+
+    // Formatter of the G-code emitted for the moves. Much cheaper than std::ostringstream,
+    // which formats the numbers through the locale facets of the stream.
+    class GCodeFormatter {
+    public:
+        GCodeFormatter() { m_str.reserve(64); }
+        GCodeFormatter& operator<<(const char *s) { m_str += s; return *this; }
+        GCodeFormatter& operator<<(const std::string &s) { m_str += s; return *this; }
+        GCodeFormatter& operator<<(char c) { m_str += c; return *this; }
+        GCodeFormatter& operator<<(const FixedNumber &num) { append_fixed(m_str, num.value, num.precision); return *this; }
+        // Same output as std::ostream << float with the default formatting (6 significant digits).
+        GCodeFormatter& operator<<(float v) {
+            if (v == std::floor(v) && v < 1e6f && ! std::signbit(v))
+                // Whole numbers (typically retract speeds) are printed without a decimal point.
+                m_str += std::to_string(long(v));
+            else {
+                std::ostringstream ss;
+                ss.imbue(std::locale::classic());
+                ss << v;
+                m_str += ss.str();
+            }
+            return *this;
+        }
+        std::string str() { return std::move(m_str); }
+
+    private:
+        std::string m_str;
+    };
+}
+
 void GCodeWriter::apply_print_config(const PrintConfig &print_config)
 {
     this->config.apply(print_config, true);
@@ -270,7 +346,7 @@ std::string GCodeWriter::set_speed(double F, const std::string &comment, const s
 {
     assert(F > 0.);
     assert(F < 100000.);
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 F" << XYZF_NUM(F);
     COMMENT(comment);
     gcode << cooling_marker;
@@ -283,7 +359,7 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &com
     m_pos(0) = point(0);
     m_pos(1) = point(1);
     
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 X" << XYZF_NUM(point(0))
           <<   " Y" << XYZF_NUM(point(1))
           <<   " F" << XYZF_NUM(this->config.travel_speed.value * 60.0);
@@ -313,7 +389,7 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
     m_lifted = 0;
     m_pos = point;
     
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 X" << XYZF_NUM(point(0))
           <<   " Y" << XYZF_NUM(point(1))
           <<   " Z" << XYZF_NUM(point(2))
@@ -346,7 +422,7 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
 {
     m_pos(2) = z;
     
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 Z" << XYZF_NUM(z)
           <<   " F" << XYZF_NUM(this->config.travel_speed.value * 60.0);
     COMMENT(comment);
@@ -372,7 +448,7 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
     m_pos(1) = point(1);
     m_extruder->extrude(dE);
     
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 X" << XYZF_NUM(point(0))
           <<   " Y" << XYZF_NUM(point(1))
           <<    " " << m_extrusion_axis << E_NUM(m_extruder->E());
@@ -387,7 +463,7 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
     m_lifted = 0;
     m_extruder->extrude(dE);
     
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     gcode << "G1 X" << XYZF_NUM(point(0))
           <<   " Y" << XYZF_NUM(point(1))
           <<   " Z" << XYZF_NUM(point(2))
@@ -421,7 +497,7 @@ std::string GCodeWriter::retract_for_toolchange(bool before_wipe)
 
 std::string GCodeWriter::_retract(double length, double restart_extra, const std::string &comment)
 {
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     
     /*  If firmware retraction is enabled, we use a fake value of 1
         since we ignore the actual configured retract_length which 
@@ -459,7 +535,7 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
 
 std::string GCodeWriter::unretract()
 {
-    std::ostringstream gcode;
+    GCodeFormatter gcode;
     
     if (FLAVOR_IS(gcfMakerWare))
         gcode << "M101 ; extruder on\n";
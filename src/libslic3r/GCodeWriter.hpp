@@ -88,6 +88,12 @@ private:
     std::string _retract(double length, double restart_extra, const std::string &comment);
 };
 
+// Append a number as text with a fixed number of decimal digits, producing the same text as
+// std::ostream << std::fixed << std::setprecision(precision) << value in the "C" locale.
+// Numbers of the magnitude emitted into G-code are formatted through an integer scaled fast path,
+// other numbers are formatted through std::ostringstream. Precision has to be in <0, 9>.
+void append_fixed(std::string &out, double value, int precision);
+
 } /* namespace Slic3r */
 
 #endif /* slic3r_GCodeWriter_hpp_ */
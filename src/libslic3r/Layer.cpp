@@ -243,4 +243,149 @@ void Layer::export_region_fill_surfaces_to_svg_debug(const char *name) const
     this->export_region_fill_surfaces_to_svg(debug_out_path("Layer-fill_surfaces-%s-%d.svg", name, idx ++).c_str());
 }
 
+const char* layer_data_type_name(LayerDataType type)
+{
+    switch (type) {
+    case ldtLayers:         return "layers";
+    case ldtLSlices:        return "lslices";
+    case ldtRegionSlices:   return "region slices";
+    case ldtFillExPolygons: return "fill expolygons";
+    case ldtFillSurfaces:   return "fill surfaces";
+    case ldtBridged:        return "bridged";
+    case ldtPerimeters:     return "perimeters";
+    case ldtThinFills:      return "thin fills";
+    case ldtFills:          return "fills";
+    case ldtSupportIslands: return "support islands";
+    case ldtSupportFills:   return "support fills";
+    default:                assert(false); return "";
+    }
+}
+
+// Heap memory held by the containers, not counting the size of the container object itself.
+static size_t memory_used(const Points &points) { return SLIC3R_STDVEC_MEMSIZE(points, Point); }
+
+static size_t memory_used(const ExPolygon &expolygon)
+{
+    size_t out = memory_used(expolygon.contour.points) + SLIC3R_STDVEC_MEMSIZE(expolygon.holes, Polygon);
+    for (const Polygon &hole : expolygon.holes)
+        out += memory_used(hole.points);
+    return out;
+}
+
+static size_t memory_used(const ExPolygons &expolygons)
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(expolygons, ExPolygon);
+    for (const ExPolygon &expolygon : expolygons)
+        out += memory_used(expolygon);
+    return out;
+}
+
+static size_t memory_used(const SurfaceCollection &surfaces)
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(surfaces.surfaces, Surface);
+    for (const Surface &surface : surfaces.surfaces)
+        out += memory_used(surface.expolygon);
+    return out;
+}
+
+template<typename TPolylines>
+static size_t memory_used_polylines(const TPolylines &polylines)
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(polylines, typename TPolylines::value_type);
+    for (const auto &polyline : polylines)
+        out += memory_used(polyline.points);
+    return out;
+}
+
+static size_t memory_used(const ExtrusionPaths &paths)
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(paths, ExtrusionPath);
+    for (const ExtrusionPath &path : paths)
+        out += memory_used(path.polyline.points);
+    return out;
+}
+
+static size_t memory_used(const ExtrusionEntityCollection &collection);
+
+// Including the heap allocated ExtrusionEntity itself.
+static size_t memory_used(const ExtrusionEntity *entity)
+{
+    if (const ExtrusionEntityCollection *collection = dynamic_cast<const ExtrusionEntityCollection*>(entity))
+        return sizeof(ExtrusionEntityCollection) + memory_used(*collection);
+    if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(entity))
+        return sizeof(ExtrusionPath) + memory_used(path->polyline.points);
+    if (const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(entity))
+        return sizeof(ExtrusionMultiPath) + memory_used(multipath->paths);
+    if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(entity))
+        return sizeof(ExtrusionLoop) + memory_used(loop->paths);
+    return 0;
+}
+
+static size_t memory_used(const ExtrusionEntityCollection &collection)
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(collection.entities, ExtrusionEntity*);
+    for (const ExtrusionEntity *entity : collection.entities)
+        out += memory_used(entity);
+    return out;
+}
+
+LayerMemoryUsed LayerRegion::memory_used() const
+{
+    LayerMemoryUsed out;
+    out[ldtLayers]          = sizeof(LayerRegion);
+    out[ldtRegionSlices]    = Slic3r::memory_used(this->slices);
+    out[ldtFillExPolygons]  = Slic3r::memory_used(this->fill_expolygons);
+    out[ldtFillSurfaces]    = Slic3r::memory_used(this->fill_surfaces);
+    out[ldtBridged]         = memory_used_polylines(this->bridged) + memory_used_polylines(this->unsupported_bridge_edges);
+    out[ldtPerimeters]      = Slic3r::memory_used(this->perimeters);
+    out[ldtThinFills]       = Slic3r::memory_used(this->thin_fills);
+    out[ldtFills]           = Slic3r::memory_used(this->fills);
+    return out;
+}
+
+void LayerRegion::release_intermediates()
+{
+    // The internal region slices are kept, GCode::needs_retraction() does not retract over them.
+    Surfaces internal;
+    internal.reserve(std::count_if(this->slices.surfaces.begin(), this->slices.surfaces.end(), [](const Surface &s) { return s.is_internal(); }));
+    for (Surface &surface : this->slices.surfaces)
+        if (surface.is_internal())
+            internal.emplace_back(std::move(surface));
+    this->slices.surfaces.swap(internal);
+    // Swap with empty containers, clear() would keep the memory allocated.
+    ExPolygons().swap(this->fill_expolygons);
+    Surfaces().swap(this->fill_surfaces.surfaces);
+    Polygons().swap(this->bridged);
+    Polylines().swap(this->unsupported_bridge_edges);
+    // The thin fills were copied to this->fills by the infill generator.
+    this->thin_fills.clear();
+    ExtrusionEntitiesPtr().swap(this->thin_fills.entities);
+}
+
+LayerMemoryUsed Layer::memory_used() const
+{
+    LayerMemoryUsed out;
+    out[ldtLayers]  = sizeof(Layer) + SLIC3R_STDVEC_MEMSIZE(m_regions, LayerRegion*);
+    out[ldtLSlices] = Slic3r::memory_used(this->lslices) + SLIC3R_STDVEC_MEMSIZE(this->lslices_bboxes, BoundingBox);
+    for (const LayerRegion *layerm : m_regions)
+        out += layerm->memory_used();
+    return out;
+}
+
+void Layer::release_intermediates()
+{
+    // Layer::lslices are kept, they are used by the G-code export to order the extrusions by islands.
+    for (LayerRegion *layerm : m_regions)
+        layerm->release_intermediates();
+}
+
+LayerMemoryUsed SupportLayer::memory_used() const
+{
+    LayerMemoryUsed out = Layer::memory_used();
+    out[ldtLayers]        += sizeof(SupportLayer) - sizeof(Layer);
+    out[ldtSupportIslands] = Slic3r::memory_used(this->support_islands.expolygons);
+    out[ldtSupportFills]   = Slic3r::memory_used(this->support_fills);
+    return out;
+}
+
 }
@@ -13,6 +13,39 @@ class Layer;
 class PrintRegion;
 class PrintObject;
 
+// Kinds of data held by the layers, for the accounting of the memory used by the layers.
+enum LayerDataType {
+    // Layer, SupportLayer and LayerRegion objects themselves.
+    ldtLayers,
+    // Layer::lslices and Layer::lslices_bboxes.
+    ldtLSlices,
+    ldtRegionSlices,
+    ldtFillExPolygons,
+    ldtFillSurfaces,
+    // LayerRegion::bridged and LayerRegion::unsupported_bridge_edges.
+    ldtBridged,
+    ldtPerimeters,
+    ldtThinFills,
+    ldtFills,
+    ldtSupportIslands,
+    ldtSupportFills,
+    ldtCount,
+};
+
+// Human readable name of the data type, for reporting.
+const char* layer_data_type_name(LayerDataType type);
+
+// Heap memory in bytes held by a layer or by a set of layers, split by the data type.
+struct LayerMemoryUsed
+{
+    size_t  bytes[ldtCount] = { 0 };
+
+    size_t  operator[](LayerDataType type) const { return bytes[type]; }
+    size_t& operator[](LayerDataType type)       { return bytes[type]; }
+    size_t  total() const { size_t out = 0; for (size_t b : bytes) out += b; return out; }
+    LayerMemoryUsed& operator+=(const LayerMemoryUsed &rhs) { for (size_t i = 0; i < ldtCount; ++ i) bytes[i] += rhs.bytes[i]; return *this; }
+};
+
 class LayerRegion
 {
 public:
@@ -72,6 +105,12 @@ public:
     // Is there any valid extrusion assigned to this LayerRegion?
     bool    has_extrusions() const { return ! this->perimeters.entities.empty() || ! this->fills.entities.empty(); }
 
+    // Heap memory held by this LayerRegion.
+    LayerMemoryUsed memory_used() const;
+    // Release the data, which is only needed to calculate the extrusions. The perimeters, fills and the internal slices,
+    // which are read by the G-code export, are kept.
+    void    release_intermediates();
+
 protected:
     friend class Layer;
 
@@ -146,6 +185,11 @@ public:
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool            has_extrusions() const { for (auto layerm : m_regions) if (layerm->has_extrusions()) return true; return false; }
 
+    // Heap memory held by this layer and its regions.
+    virtual LayerMemoryUsed memory_used() const;
+    // Release the data of this layer and its regions, which is not needed by the G-code export.
+    void                    release_intermediates();
+
 protected:
     friend class PrintObject;
 
@@ -174,6 +218,8 @@ public:
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool                has_extrusions() const { return ! support_fills.empty(); }
 
+    LayerMemoryUsed             memory_used() const override;
+
 protected:
     friend class PrintObject;
 
@@ -228,6 +228,7 @@ const MotionPlannerGraph& MotionPlanner::init_graph(int island_idx)
                 graph->add_edge(v0_idx, v1_idx, (p1 - p0).cast<double>().norm());
             }
         }
+        graph->build_nodes_index();
     }
 
     return *graph;
@@ -305,7 +306,18 @@ void MotionPlannerGraph::add_edge(size_t from, size_t to, double weight)
     m_adjacency_list[from].emplace_back(Neighbor(node_t(to), weight));
 }
 
-// Dijkstra's shortest path in a weighted graph from node_start to node_end.
+size_t MotionPlannerGraph::find_closest_node(const Point &point) const
+{
+    if (m_nodes_kdtree.empty())
+        // The index was not built yet.
+        return point.nearest_point_index(m_nodes);
+    return find_closest_point(m_nodes_kdtree, point.cast<double>());
+}
+
+// A* shortest path in a weighted graph from node_start to node_end.
+// The edge weights are Euclidean lengths of the edges, therefore the Euclidean distance to node_end
+// is a consistent heuristic and the path found is the same length as the one found by the Dijkstra algorithm,
+// while only the nodes in the direction towards node_end are visited.
 // The returned path contains the end points.
 // If no path exists from node_start to node_end, a straight segment is returned.
 Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) const
@@ -314,45 +326,51 @@ Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) c
     if (this->empty())
         return Polyline();
 
-    // Dijkstra algorithm, previous node of the current node 'u' in the shortest path towards node_start.
+    // Previous node of the current node 'u' in the shortest path towards node_start.
     std::vector<node_t>   previous(m_adjacency_list.size(), -1);
+    // Length of the shortest path from node_start found so far.
     std::vector<weight_t> distance(m_adjacency_list.size(), std::numeric_limits<weight_t>::infinity());
+    // distance + the estimated distance to node_end, the queue is sorted by this value.
+    std::vector<weight_t> estimate(m_adjacency_list.size(), std::numeric_limits<weight_t>::infinity());
     std::vector<size_t>   map_node_to_queue_id(m_adjacency_list.size(), size_t(-1));
-    distance[node_start] = 0.;
+    const Vec2d           pt_end = m_nodes[node_end].cast<double>();
+    auto                  heuristic = [this, &pt_end](node_t node) { return (m_nodes[node].cast<double>() - pt_end).norm(); };
 
-    auto queue = make_mutable_priority_queue<node_t, false>(
+    auto queue = make_mutable_priority_queue<node_t, true>(
         [&map_node_to_queue_id](const node_t node, size_t idx) { map_node_to_queue_id[node] = idx; },
-        [&distance](const node_t node1, const node_t node2) { return distance[node1] < distance[node2]; });
-    queue.reserve(m_adjacency_list.size());
-    for (size_t i = 0; i < m_adjacency_list.size(); ++ i)
-        queue.push(node_t(i));
+        [&estimate](const node_t node1, const node_t node2) { return estimate[node1] < estimate[node2]; });
+    distance[node_start] = 0.;
+    estimate[node_start] = heuristic(node_t(node_start));
+    queue.push(node_t(node_start));
 
     while (! queue.empty()) {
-        // Get the next node with the lowest distance to node_start.
+        // Get the next node with the lowest estimate of the path length through it.
         node_t u = node_t(queue.top());
         queue.pop();
-        map_node_to_queue_id[u] = size_t(-1);
         // Stop searching if we reached our destination.
         if (size_t(u) == node_end)
             break;
         // Visit each edge starting at node u.
-        for (const Neighbor& neighbor : m_adjacency_list[u])
-            if (map_node_to_queue_id[neighbor.target] != size_t(-1)) {
-                weight_t alt = distance[u] + neighbor.weight;
-                // If total distance through u is shorter than the previous
-                // distance (if any) between node_start and neighbor.target, replace it.
-                if (alt < distance[neighbor.target]) {
-                    distance[neighbor.target] = alt;
-                    previous[neighbor.target] = u;
+        for (const Neighbor& neighbor : m_adjacency_list[u]) {
+            weight_t alt = distance[u] + neighbor.weight;
+            // If total distance through u is shorter than the previous
+            // distance (if any) between node_start and neighbor.target, replace it.
+            if (alt < distance[neighbor.target]) {
+                distance[neighbor.target] = alt;
+                estimate[neighbor.target] = alt + heuristic(neighbor.target);
+                previous[neighbor.target] = u;
+                if (map_node_to_queue_id[neighbor.target] == size_t(-1))
+                    // Not queued yet, or reopened due to the numerical inaccuracy of the heuristic.
+                    queue.push(neighbor.target);
+                else
                     queue.update(map_node_to_queue_id[neighbor.target]);
-                }
             }
+        }
     }
 
     // In case the end point was not reached, previous[node_end] contains -1
     // and a straight line from node_start to node_end is returned.
     Polyline polyline;
-    polyline.points.reserve(m_adjacency_list.size());
     for (node_t vertex = node_t(node_end); vertex != -1; vertex = previous[vertex])
         polyline.points.emplace_back(m_nodes[vertex]);
     polyline.points.emplace_back(m_nodes[node_start]);
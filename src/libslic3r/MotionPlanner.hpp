@@ -5,6 +5,7 @@
 #include "BoundingBox.hpp"
 #include "ClipperUtils.hpp"
 #include "ExPolygonCollection.hpp"
+#include "KDTreeIndirect.hpp"
 #include "Polyline.hpp"
 #include <map>
 #include <utility>
@@ -38,14 +39,21 @@ private:
     ExPolygonCollection m_env;
 };
 
-// A 2D directed graph for searching a shortest path using the famous Dijkstra algorithm.
+// A 2D directed graph for searching a shortest path using the A* algorithm.
 class MotionPlannerGraph
 {    
 public:
+    MotionPlannerGraph() : m_nodes_kdtree(NodeCoordinateFn(&m_nodes)) {}
+    // The spatial index references m_nodes.
+    MotionPlannerGraph(const MotionPlannerGraph &rhs) = delete;
+    MotionPlannerGraph& operator=(const MotionPlannerGraph &rhs) = delete;
+
     // Add a directed edge into the graph.
     size_t   add_node(const Point &p) { m_nodes.emplace_back(p); return m_nodes.size() - 1; }
     void     add_edge(size_t from, size_t to, double weight);
-    size_t   find_closest_node(const Point &point) const { return point.nearest_point_index(m_nodes); }
+    // To be called after all the nodes were added to speed up find_closest_node().
+    void     build_nodes_index() { m_nodes_kdtree.build(m_nodes.size()); }
+    size_t   find_closest_node(const Point &point) const;
 
     bool     empty() const { return m_adjacency_list.empty(); }
     Polyline shortest_path(size_t from, size_t to) const;
@@ -60,8 +68,15 @@ private:
         node_t   target;
         weight_t weight;
     };
+    struct NodeCoordinateFn {
+        NodeCoordinateFn(const Points *nodes) : nodes(nodes) {}
+        double operator()(size_t idx, size_t dimension) const { return double((*nodes)[idx](dimension)); }
+        const Points *nodes;
+    };
     Points                              m_nodes;
     std::vector<std::vector<Neighbor>>  m_adjacency_list;
+    // Spatial index over m_nodes.
+    KDTreeIndirect<2, double, NodeCoordinateFn> m_nodes_kdtree;
 };
 
 class MotionPlanner
@@ -284,19 +284,22 @@ void PerimeterGenerator::process()
             std::vector<PerimeterGeneratorLoops> contours(loop_number+1);    // depth => loops
             std::vector<PerimeterGeneratorLoops> holes(loop_number+1);       // depth => loops
             ThickPolylines thin_walls;
+            // Offsets the current shell, which is stored into last at the end of each iteration, by all the deltas
+            // needed to produce the next shell and the gaps between the shells.
+            const ExPolygonsOffsetter last_offsetter(last);
             // we loop one time more than needed in order to find gaps after the last perimeter was applied
             for (int i = 0;; ++ i) {  // outer loop is 0
                 // Calculate next onion shell of perimeters.
                 ExPolygons offsets;
+                const ExPolygonsOffsetter offsets_offsetter(offsets);
                 if (i == 0) {
                     // the minimum thickness of a single loop is:
                     // ext_width/2 + ext_spacing/2 + spacing/2 + width/2
                     offsets = this->config->thin_walls ? 
-                        offset2_ex(
-                            last,
+                        last_offsetter.offset2_ex(
                             - float(ext_perimeter_width / 2. + ext_min_spacing / 2. - 1),
                             + float(ext_min_spacing / 2. - 1)) :
-                        offset_ex(last, - float(ext_perimeter_width / 2.));
+                        last_offsetter.offset_ex(- float(ext_perimeter_width / 2.));
                     // look for thin walls
                     if (this->config->thin_walls) {
                         // the following offset2 ensures almost nothing in @thin_walls is narrower than $min_width
@@ -305,7 +308,7 @@ void PerimeterGenerator::process()
                         ExPolygons expp = offset2_ex(
                             // medial axis requires non-overlapping geometry
                             diff_ex(to_polygons(last),
-                                    offset(offsets, float(ext_perimeter_width / 2.)),
+                                    offsets_offsetter.offset(float(ext_perimeter_width / 2.)),
                                     true),
                             - float(min_width / 2.), float(min_width / 2.));
                         // the maximum thickness of our thin wall area is equal to the minimum thickness of a single loop
@@ -327,20 +330,20 @@ void PerimeterGenerator::process()
                         // reliable gap fill algorithm.
                         // Also the offset2(perimeter, -x, x) may sometimes lead to a perimeter, which is larger than
                         // the original.
-                        offset2_ex(last,
+                        last_offsetter.offset2_ex(
                                 - float(distance + min_spacing / 2. - 1.),
                                 float(min_spacing / 2. - 1.)) :
                         // If "detect thin walls" is not enabled, this paths will be entered, which 
                         // leads to overflows, as in prusa3d/Slic3r GH #32
-                        offset_ex(last, - float(distance));
+                        last_offsetter.offset_ex(- float(distance));
                     // look for gaps
                     if (has_gap_fill)
                         // not using safety offset here would "detect" very narrow gaps
                         // (but still long enough to escape the area threshold) that gap fill
                         // won't be able to fill but we'd still remove from infill area
                         append(gaps, diff_ex(
-                            offset(last,    - float(0.5 * distance)),
-                            offset(offsets,   float(0.5 * distance + 10))));  // safety offset
+                            last_offsetter.offset(- float(0.5 * distance)),
+                            offsets_offsetter.offset(float(0.5 * distance + 10))));  // safety offset
                 }
                 if (offsets.empty()) {
                     // Store the number of loops actually generated.
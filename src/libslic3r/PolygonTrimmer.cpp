@@ -19,9 +19,9 @@ TrimmedLoop trim_loop(const Polygon &loop, const EdgeGrid::Grid &grid)
 			bool operator()(coord_t iy, coord_t ix) {
 				// Called with a row and colum of the grid cell, which is intersected by a line.
 				auto cell_data_range = grid.cell_data_range(iy, ix);
-				for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++ it_contour_and_segment) {
+				for (auto it_segment = cell_data_range.first; it_segment != cell_data_range.second; ++ it_segment) {
 					// End points of the line segment and their vector.
-					auto segment = grid.segment(*it_contour_and_segment);
+					auto segment = grid.segment(*it_segment);
 					if (Geometry::segments_intersect(segment.first, segment.second, *pt_prev, *pt_this)) {
 						// The two segments intersect. Add them to the output.
 					}
@@ -75,6 +75,7 @@ bool Print::invalidate_state_by_config_options(const std::vector<t_config_option
         "between_objects_gcode",
         "bridge_acceleration",
         "bridge_fan_speed",
+        "chain_cluster_size",
         "colorprint_heights",
         "cooling",
         "default_acceleration",
@@ -845,7 +846,6 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
         bool support_enforcers_differ   = model_volume_list_changed(model_object, model_object_new, ModelVolumeType::SUPPORT_ENFORCER);
         if (model_parts_differ || modifiers_differ || 
             model_object.origin_translation         != model_object_new.origin_translation   ||
-            model_object.layer_height_profile       != model_object_new.layer_height_profile ||
             ! layer_height_ranges_equal(model_object.layer_config_ranges, model_object_new.layer_config_ranges, model_object_new.layer_height_profile.empty())) {
             // The very first step (the slicing step) is invalidated. One may freely remove all associated PrintObjects.
             auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
@@ -855,17 +855,30 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             }
             // Copy content of the ModelObject including its ID, do not change the parent.
             model_object.assign_copy(model_object_new);
-        } else if (support_blockers_differ || support_enforcers_differ || model_custom_supports_data_changed(model_object, model_object_new)) {
-            // First stop background processing before shuffling or deleting the ModelVolumes in the ModelObject's list.
-            this->call_cancel_callback();
-            update_apply_status(false);
-            // Invalidate just the supports step.
-            auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
-            for (auto it = range.first; it != range.second; ++ it)
-                update_apply_status(it->print_object->invalidate_step(posSupportMaterial));
-            if (support_enforcers_differ || support_blockers_differ) {
-                // Copy just the support volumes.
-                model_volume_list_update_supports(model_object, model_object_new);
+        } else {
+            if (model_object.layer_height_profile != model_object_new.layer_height_profile) {
+                // Just the layer height profile was edited, for example by the variable layer height tool.
+                // First stop background processing before changing the layer height profile read by the slicing.
+                this->call_cancel_callback();
+                update_apply_status(false);
+                // Invalidate the slicing step, but keep the PrintObjects. The next slicing will reuse the layers at unchanged Z.
+                auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
+                for (auto it = range.first; it != range.second; ++ it)
+                    update_apply_status(it->print_object->invalidate_layer_height_profile());
+                model_object.layer_height_profile = model_object_new.layer_height_profile;
+            }
+            if (support_blockers_differ || support_enforcers_differ || model_custom_supports_data_changed(model_object, model_object_new)) {
+                // First stop background processing before shuffling or deleting the ModelVolumes in the ModelObject's list.
+                this->call_cancel_callback();
+                update_apply_status(false);
+                // Invalidate just the supports step.
+                auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
+                for (auto it = range.first; it != range.second; ++ it)
+                    update_apply_status(it->print_object->invalidate_step(posSupportMaterial));
+                if (support_enforcers_differ || support_blockers_differ) {
+                    // Copy just the support volumes.
+                    model_volume_list_update_supports(model_object, model_object_new);
+                }
             }
         }
         if (model_custom_seam_data_changed(model_object, model_object_new)) {
@@ -1066,8 +1079,13 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
             if (! diff.empty()) {
                 region.config_apply_only(this_region_config, diff, false);
                 for (PrintObject *print_object : m_objects)
-                    if (region_id < print_object->region_volumes.size() && ! print_object->region_volumes[region_id].empty())
-                        update_apply_status(print_object->invalidate_state_by_config_options(diff));
+                    if (region_id < print_object->region_volumes.size() && ! print_object->region_volumes[region_id].empty()) {
+                        // Just the layers in the Z ranges of the region (layer config ranges) are affected.
+                        std::vector<t_layer_height_range> ranges;
+                        for (const std::pair<t_layer_height_range, int> &volume_and_range : print_object->region_volumes[region_id])
+                            ranges.emplace_back(volume_and_range.first);
+                        update_apply_status(print_object->invalidate_state_by_config_options(diff, &ranges));
+                    }
             }
         }
     }
@@ -1588,11 +1606,21 @@ void Print::process()
         obj->make_perimeters();
     this->set_status(70, L("Infilling layers"));
     for (PrintObject *obj : m_objects)
-        obj->infill();
+        if (m_release_intermediates && ! obj->has_support_material())
+            obj->infill_ironing_and_release();
+        else
+            obj->infill();
     for (PrintObject *obj : m_objects)
         obj->ironing();
     for (PrintObject *obj : m_objects)
         obj->generate_support_material();
+    if (m_release_intermediates) {
+        // The remaining steps and the G-code export only need the extrusions and Layer::lslices.
+        for (PrintObject *obj : m_objects)
+            if (! obj->m_intermediates_released)
+                obj->release_intermediates();
+        BOOST_LOG_TRIVIAL(info) << "Released intermediate layer data." << log_memory_info();
+    }
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
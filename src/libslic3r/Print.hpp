@@ -6,6 +6,7 @@
 #include "BoundingBox.hpp"
 #include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
+#include "Layer.hpp"
 #include "Point.hpp"
 #include "Slicing.hpp"
 #include "GCode/ToolOrdering.hpp"
@@ -112,6 +113,21 @@ struct PrintInstance
 
 typedef std::vector<PrintInstance> PrintInstances;
 
+// Heap memory held by the layers of a PrintObject, see PrintObject::memory_used().
+struct PrintObjectMemoryUsed
+{
+    // Indexed by the layer index.
+    std::vector<LayerMemoryUsed>    layers;
+    std::vector<LayerMemoryUsed>    support_layers;
+
+    // Sum over the object and support layers.
+    LayerMemoryUsed                 total() const;
+    // Memory held by the data produced by the step.
+    size_t                          step(PrintObjectStep step) const;
+    // The step producing the data type.
+    static PrintObjectStep          producing_step(LayerDataType type);
+};
+
 class PrintObject : public PrintObjectBaseWithState<Print, PrintObjectStep, posCount>
 {
 private: // Prevents erroneous use by other classes.
@@ -194,6 +210,9 @@ public:
     // Helpers to project custom facets on slices
     void project_and_append_custom_facets(bool seam, EnforcerBlockerType type, std::vector<ExPolygons>& expolys) const;
 
+    // Heap memory held by the layers and support layers, per layer and per data type.
+    PrintObjectMemoryUsed memory_used() const;
+
 private:
     // to be called from Print only.
     friend class Print;
@@ -206,10 +225,17 @@ private:
     PrintBase::ApplyStatus  set_instances(PrintInstances &&instances);
     // Invalidates the step, and its depending steps in PrintObject and Print.
     bool                    invalidate_step(PrintObjectStep step);
+    // Invalidates the step for the layers intersecting the Z ranges (unscaled, in object coordinates) only, and its depending steps.
+    // Only posPerimeters is processed per layer, the other steps are invalidated as a whole.
+    bool                    invalidate_step_ranges(PrintObjectStep step, const std::vector<t_layer_height_range> &ranges);
     // Invalidates all PrintObject and Print steps.
     bool                    invalidate_all_steps();
+    // Invalidates the slicing step after just the layer height profile changed.
+    // The next slicing will keep the layers, which are sliced at the same Z with the same height.
+    bool                    invalidate_layer_height_profile();
     // Invalidate steps based on a set of parameters changed.
-    bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
+    // If ranges are provided, the parameters changed for the layers intersecting these Z ranges only.
+    bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys, const std::vector<t_layer_height_range> *ranges = nullptr);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -220,12 +246,19 @@ private:
     void make_perimeters();
     void prepare_infill();
     void infill();
+    // Generates the infill and the ironing of each layer in a single pass over the layers and releases the layer data
+    // not needed by the G-code export right after, so that the intermediate data of all the layers are never held at once.
+    // Only valid without support material, which needs the region slices of all the layers.
+    void infill_ironing_and_release();
     void ironing();
     void generate_support_material();
+    // Release the layer data, which is not needed by the G-code export. Called by Print::process() if enabled.
+    void release_intermediates();
 
-    void _slice(const std::vector<coordf_t> &layer_height_profile);
+    // Returns the layers, which were sliced. Layers kept from the previous slicing are not returned.
+    LayerPtrs _slice(const std::vector<coordf_t> &layer_height_profile);
     std::string _fix_slicing_errors();
-    void simplify_slices(double distance);
+    void simplify_slices(double distance, const LayerPtrs &layers);
     bool has_support_material() const;
     void detect_surfaces_type();
     void process_external_surfaces();
@@ -254,10 +287,30 @@ private:
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
-
-    std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode) const;
-    std::vector<ExPolygons> slice_modifiers(size_t region_id, const std::vector<float> &z) const;
+    // Set by invalidate_layer_height_profile(), the layers of the previous slicing at unchanged Z are reused by the next slicing.
+    bool                                    m_reuse_layers = false;
+    // Set by release_intermediates(), invalidation of any step requires slicing the object again.
+    bool                                    m_intermediates_released = false;
+    // Set by _slice() if some of the layers were kept from the previous slicing, thus just some Z ranges are sliced.
+    bool                                    m_slicing_subrange = false;
+
+    // Meshes composed from the sets of volumes sliced by _slice() and their slicers with the facet Z index. They are created
+    // by the partial re-slicing after the layer height profile was edited and kept for the next re-slicing of that kind,
+    // a full slicing or an invalidation of posSlice for any other reason drops them.
+    struct CachedSlicer {
+        std::vector<ObjectID>               volume_ids;
+        std::unique_ptr<TriangleMesh>       mesh;
+        // nullptr if the volumes have no facets.
+        std::unique_ptr<TriangleMeshSlicer> slicer;
+    };
+    std::vector<CachedSlicer>               m_cached_slicers;
+
+    std::vector<ExPolygons> slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode);
+    std::vector<ExPolygons> slice_modifiers(size_t region_id, const std::vector<float> &z);
+    TriangleMesh            volumes_mesh(const std::vector<const ModelVolume*> &volumes) const;
     std::vector<ExPolygons> slice_volumes(const std::vector<float> &z, SlicingMode mode, const std::vector<const ModelVolume*> &volumes) const;
+    // Like slice_volumes(), using m_cached_slicers when re-slicing just some Z ranges.
+    std::vector<ExPolygons> slice_volumes_cached(const std::vector<float> &z, SlicingMode mode, const std::vector<const ModelVolume*> &volumes);
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const std::vector<t_layer_height_range> &ranges, SlicingMode mode, const ModelVolume &volume) const;
 };
@@ -315,6 +368,9 @@ struct PrintStatistics
     double                          total_wipe_tower_cost;
     double                          total_wipe_tower_filament;
     std::map<size_t, float>         filament_stats;
+    // Size of the exported G-code file and the throughput of the G-code export.
+    size_t                          gcode_export_bytes;
+    double                          gcode_export_bytes_per_second;
 
     // Config with the filled in print statistics.
     DynamicConfig           config() const;
@@ -338,6 +394,8 @@ struct PrintStatistics
         total_wipe_tower_cost  = 0.;
         total_wipe_tower_filament = 0.;
         filament_stats.clear();
+        gcode_export_bytes     = 0;
+        gcode_export_bytes_per_second = 0.;
     }
 };
 
@@ -375,6 +433,14 @@ public:
     std::string         export_gcode(const std::string& path_template, GCodePreviewData* preview_data, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
 #endif // ENABLE_GCODE_VIEWER
 
+    // Release the layer data not needed by the G-code export (external region slices, fill surfaces, thin fills...) during process().
+    // The objects without support material release the data of each layer as soon as its infill is generated,
+    // the other objects after their support material is generated.
+    // Reduces the memory footprint of a large print, at the cost of slicing the objects again after any of their steps is invalidated,
+    // thus it is meant for the command line slicing.
+    void                set_release_intermediates(bool release) { m_release_intermediates = release; }
+    bool                release_intermediates() const { return m_release_intermediates; }
+
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
     // Returns true if an object step is done on all objects and there's at least one object.    
@@ -496,6 +562,9 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // See set_release_intermediates().
+    bool                                    m_release_intermediates = false;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
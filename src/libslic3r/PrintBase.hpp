@@ -164,6 +164,8 @@ public:
         state.state = DONE;
         state.timestamp = ++ g_last_timestamp;
         m_step_active = -1;
+        m_partially_invalid[step] = false;
+        m_invalid_ranges[step].clear();
         // Remove all non-current warnings.
     	auto it = std::remove_if(state.warnings.begin(), state.warnings.end(), [](const auto &w) { return ! w.current; });
     	bool update_warning_ui = false;
@@ -200,9 +202,59 @@ public:
             state.mark_warnings_non_current();
             m_step_active = -1;
         }
+        // A step invalidated as a whole has to be processed as a whole, even if it was invalidated partially before.
+        m_partially_invalid[step] = false;
+        m_invalid_ranges[step].clear();
         return invalidated;
     }
 
+    // Make the step invalid for the layers intersecting the Z ranges only, the results of the step
+    // for the other layers remain valid. The ranges may be empty, further ranges may be added with add_invalid_range().
+    // PrintBase::m_state_mutex should be locked at this point, guarding access to m_state.
+    // A finished step becomes partially invalid, ranges are added to a partially invalid step.
+    // A step invalidated as a whole stays invalid as a whole. A step being processed
+    // is invalidated as a whole, as its results may be incomplete.
+    template<typename CancelationCallback>
+    bool invalidate_ranges(StepType step, const std::vector<t_layer_height_range> &ranges, CancelationCallback cancel) {
+        switch (m_state[step].state) {
+        case DONE:
+        {
+            PrintStateBase::StateWithWarnings &state = m_state[step];
+            state.state = INVALID;
+            state.timestamp = ++ g_last_timestamp;
+            cancel();
+            state.mark_warnings_non_current();
+            m_step_active = -1;
+            m_partially_invalid[step] = true;
+            m_invalid_ranges[step] = ranges;
+            return true;
+        }
+        case STARTED:
+            return this->invalidate(step, cancel);
+        default:
+            if (m_partially_invalid[step])
+                append(m_invalid_ranges[step], ranges);
+            return false;
+        }
+    }
+
+    // Add an invalid Z range to a partially invalid step, to be called by the worker thread
+    // when it finds out which layers need to be processed again, see invalidate_ranges().
+    // Does nothing if the step was invalidated as a whole.
+    void add_invalid_range(StepType step, const t_layer_height_range &range, tbb::mutex &mtx) {
+        tbb::mutex::scoped_lock lock(mtx);
+        if (m_partially_invalid[step] && m_state[step].state != DONE)
+            m_invalid_ranges[step].emplace_back(range);
+    }
+
+    // Returns true if the step was invalidated partially, filling in the invalid Z ranges.
+    // Returns false if the step has to be processed as a whole.
+    bool invalid_ranges(StepType step, std::vector<t_layer_height_range> &ranges, tbb::mutex &mtx) const {
+        tbb::mutex::scoped_lock lock(mtx);
+        ranges = m_invalid_ranges[step];
+        return m_partially_invalid[step];
+    }
+
     template<typename CancelationCallback, typename StepTypeIterator>
     bool invalidate_multiple(StepTypeIterator step_begin, StepTypeIterator step_end, CancelationCallback cancel) {
         bool invalidated = false;
@@ -231,6 +283,10 @@ public:
                 m_state[*it].mark_warnings_non_current();
             m_step_active = -1;
         }
+        for (StepTypeIterator it = step_begin; it != step_end; ++ it) {
+            m_partially_invalid[*it] = false;
+            m_invalid_ranges[*it].clear();
+        }
         return invalidated;
     }
 
@@ -257,6 +313,10 @@ public:
                 m_state[i].mark_warnings_non_current();
             m_step_active = -1;
         }
+        for (size_t i = 0; i < COUNT; ++ i) {
+            m_partially_invalid[i] = false;
+            m_invalid_ranges[i].clear();
+        }
         return invalidated;
     }
 
@@ -296,6 +356,10 @@ public:
 
 private:
     StateWithWarnings   m_state[COUNT];
+    // Steps invalidated for some layers only, see invalidate_ranges().
+    bool                               m_partially_invalid[COUNT] {};
+    // Z ranges of the layers to be processed again by a partially invalid step, in unscaled object coordinates.
+    std::vector<t_layer_height_range>  m_invalid_ranges[COUNT];
     // Active class StepType or -1 if none is active.
     // If the background processing is canceled, m_step_active may not be resetted
     // to -1, see the comment in this->set_started().
@@ -548,6 +612,10 @@ public:
     bool            is_step_done(PrintObjectStepEnum step) const { return m_state.is_done(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithTimeStamp step_state_with_timestamp(PrintObjectStepEnum step) const { return m_state.state_with_timestamp(step, PrintObjectBase::state_mutex(m_print)); }
     PrintStateBase::StateWithWarnings  step_state_with_warnings(PrintObjectStepEnum step) const { return m_state.state_with_warnings(step, PrintObjectBase::state_mutex(m_print)); }
+    // Returns true if the step was invalidated for some layers only, filling in the Z ranges of the layers to be processed again.
+    // Returns false if the step has to be processed for all layers.
+    bool            step_invalid_ranges(PrintObjectStepEnum step, std::vector<t_layer_height_range> &ranges) const
+        { return m_state.invalid_ranges(step, ranges, PrintObjectBase::state_mutex(m_print)); }
 
 protected:
 	PrintObjectBaseWithState(PrintType *print, ModelObject *model_object) : PrintObjectBase(model_object), m_print(print) {}
@@ -570,6 +638,10 @@ protected:
         { return m_state.invalidate_multiple(il.begin(), il.end(), PrintObjectBase::cancel_callback(m_print)); }
     bool            invalidate_all_steps() 
         { return m_state.invalidate_all(PrintObjectBase::cancel_callback(m_print)); }
+    bool            invalidate_step_ranges(PrintObjectStepEnum step, const std::vector<t_layer_height_range> &ranges)
+        { return m_state.invalidate_ranges(step, ranges, PrintObjectBase::cancel_callback(m_print)); }
+    void            add_step_invalid_range(PrintObjectStepEnum step, const t_layer_height_range &range)
+        { m_state.add_invalid_range(step, range, PrintObjectBase::state_mutex(m_print)); }
 
     bool            is_step_started_unguarded(PrintObjectStepEnum step) const { return m_state.is_started_unguarded(step); }
     bool            is_step_done_unguarded(PrintObjectStepEnum step) const { return m_state.is_done_unguarded(step); }
@@ -287,6 +287,18 @@ void PrintConfigDef::init_fff_params()
     def->mode = comSimple;
     def->set_default_value(new ConfigOptionFloat(0));
 
+    def = this->add("chain_cluster_size", coInt);
+    def->label = L("Chain infill in clusters of");
+    def->category = L("Advanced");
+    def->tooltip = L("When ordering the infill extrusions of a layer at G-code export, sets of more than twice this number "
+                   "of extrusions are split into spatially compact clusters of at most this number of extrusions, "
+                   "which are ordered in parallel and joined. This speeds up the export of layers with tens of thousands "
+                   "of short extrusions at the cost of slightly longer travels. Set zero to order all the extrusions at once.");
+    def->sidetext = L("extrusions");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("clip_multipart_objects", coBool);
     def->label = L("Clip multi-part objects");
     def->tooltip = L("When printing multi-material objects, this settings will make Slic3r "
@@ -3691,6 +3703,16 @@ CLIMiscConfigDef::CLIMiscConfigDef()
                      "For example. loglevel=2 logs fatal, error and warning level messages.");
     def->min = 0;
 
+    def = this->add("memory_report", coBool);
+    def->label = L("Memory report");
+    def->tooltip = L("After slicing, print the memory used by the layers of each object, by processing step and by kind of data.");
+
+    def = this->add("release_intermediates", coBool);
+    def->label = L("Release intermediate data");
+    def->tooltip = L("Release the layer data not needed by the G-code export (region slices, fill surfaces, thin fills, bridges) "
+                     "as soon as possible: for objects without support material right after the infill of each layer is generated, "
+                     "otherwise after the support material is generated. This reduces the memory used when slicing large prints.");
+
 #if (defined(_MSC_VER) || defined(__MINGW32__)) && defined(SLIC3R_GUI)
     def = this->add("sw_renderer", coBool);
     def->label = L("Render with a software renderer");
@@ -656,6 +656,7 @@ class GCodeConfig : public StaticPrintConfig
 public:
     ConfigOptionString              before_layer_gcode;
     ConfigOptionString              between_objects_gcode;
+    ConfigOptionInt                 chain_cluster_size;
     ConfigOptionFloats              deretract_speed;
     ConfigOptionString              end_gcode;
     ConfigOptionStrings             end_filament_gcode;
@@ -732,6 +733,7 @@ protected:
     {
         OPT_PTR(before_layer_gcode);
         OPT_PTR(between_objects_gcode);
+        OPT_PTR(chain_cluster_size);
         OPT_PTR(deretract_speed);
         OPT_PTR(end_gcode);
         OPT_PTR(end_filament_gcode);
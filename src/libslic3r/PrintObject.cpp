@@ -11,6 +11,7 @@
 #include "Utils.hpp"
 
 #include <utility>
+#include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 #include <float.h>
 
@@ -110,7 +111,7 @@ void PrintObject::slice()
     std::vector<coordf_t> layer_height_profile;
     this->update_layer_height_profile(*this->model_object(), m_slicing_params, layer_height_profile);
     m_print->throw_if_canceled();
-    this->_slice(layer_height_profile);
+    LayerPtrs sliced_layers = this->_slice(layer_height_profile);
     m_print->throw_if_canceled();
     // Fix the model.
     //FIXME is this the right place to do? It is done repeateadly at the UI and now here at the backend.
@@ -119,8 +120,20 @@ void PrintObject::slice()
     if (! warning.empty())
         BOOST_LOG_TRIVIAL(info) << warning;
     // Simplify slices if required.
-    if (m_print->config().resolution)
-        this->simplify_slices(scale_(this->print()->config().resolution));
+    if (m_print->config().resolution) {
+        if (sliced_layers.size() < m_layers.size()) {
+            // Some layers were kept from the previous slicing, their slices have already been simplified.
+            // _fix_slicing_errors() may have deleted some of the bottom layers, filter the layers still alive.
+            std::sort(sliced_layers.begin(), sliced_layers.end());
+            LayerPtrs layers;
+            for (Layer *layer : m_layers)
+                if (std::binary_search(sliced_layers.begin(), sliced_layers.end(), layer))
+                    layers.emplace_back(layer);
+            sliced_layers = std::move(layers);
+        } else
+            sliced_layers = m_layers;
+        this->simplify_slices(scale_(this->print()->config().resolution), sliced_layers);
+    }
     // Update bounding boxes
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
@@ -150,8 +163,37 @@ void PrintObject::make_perimeters()
     if (! this->set_started(posPerimeters))
         return;
 
-    m_print->set_status(20, L("Generating perimeters"));
-    BOOST_LOG_TRIVIAL(info) << "Generating perimeters..." << log_memory_info();
+    // If the perimeters were invalidated for some Z ranges only, the perimeters of the other layers are kept.
+    // A layer touching an invalid range is processed as well, as its perimeters depend on the slices of the neighbor layers.
+    std::vector<t_layer_height_range> invalid_ranges;
+    std::vector<char>                 layers_to_process(m_layers.size(), true);
+    if (this->step_invalid_ranges(posPerimeters, invalid_ranges)) {
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
+            const Layer *layer = m_layers[layer_idx];
+            coordf_t     lo    = layer->slice_z - 0.5 * layer->height;
+            coordf_t     hi    = layer->slice_z + 0.5 * layer->height;
+            layers_to_process[layer_idx] = std::any_of(invalid_ranges.begin(), invalid_ranges.end(),
+                [lo, hi](const t_layer_height_range &range) { return lo < range.second + EPSILON && hi > range.first - EPSILON; });
+        }
+        size_t num_layers = std::count(layers_to_process.begin(), layers_to_process.end(), true);
+        std::string ranges_str;
+        for (size_t layer_idx = 0; layer_idx < m_layers.size();)
+            if (layers_to_process[layer_idx]) {
+                size_t layer_end = layer_idx;
+                while (layer_end + 1 < m_layers.size() && layers_to_process[layer_end + 1])
+                    ++ layer_end;
+                ranges_str += (boost::format("%1%%2%-%3%") % (ranges_str.empty() ? "" : ", ") %
+                    (m_layers[layer_idx]->print_z - m_layers[layer_idx]->height) % m_layers[layer_end]->print_z).str();
+                layer_idx = layer_end + 1;
+            } else
+                ++ layer_idx;
+        m_print->set_status(20, (boost::format(L("Generating perimeters of %1% of %2% layers (%3% mm)")) % num_layers % m_layers.size() % 
+            (ranges_str.empty() ? std::string("-") : ranges_str)).str());
+        BOOST_LOG_TRIVIAL(info) << "Generating perimeters of " << num_layers << " of " << m_layers.size() << " layers, print_z " << ranges_str << log_memory_info();
+    } else {
+        m_print->set_status(20, L("Generating perimeters"));
+        BOOST_LOG_TRIVIAL(info) << "Generating perimeters..." << log_memory_info();
+    }
     
     // merge slices if they were split into types
     if (m_typed_slices) {
@@ -235,10 +277,16 @@ void PrintObject::make_perimeters()
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
+        [this, &layers_to_process](const tbb::blocked_range<size_t>& range) {
+            // The temporary data structures of the Clipper operations are released at once after each layer.
+            ClipperLib::Arena      arena;
+            ClipperLib::ArenaScope arena_scope(arena);
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
-                m_layers[layer_idx]->make_perimeters();
+                if (layers_to_process[layer_idx]) {
+                    m_layers[layer_idx]->make_perimeters();
+                    arena.release();
+                }
             }
         }
     );
@@ -373,9 +421,13 @@ void PrintObject::infill()
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
             [this](const tbb::blocked_range<size_t>& range) {
+                // The temporary data structures of the Clipper operations are released at once after each layer.
+                ClipperLib::Arena      arena;
+                ClipperLib::ArenaScope arena_scope(arena);
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->make_fills();
+                    arena.release();
                 }
             }
         );
@@ -388,6 +440,54 @@ void PrintObject::infill()
     }
 }
 
+void PrintObject::infill_ironing_and_release()
+{
+    assert(! this->has_support_material());
+    // prerequisites
+    this->prepare_infill();
+
+    bool infill  = this->set_started(posInfill);
+    bool ironing = this->set_started(posIroning);
+    if (infill || ironing) {
+        // Set before any layer is released, so that a cancellation in the middle of the loop
+        // leaves the object to be sliced again.
+        m_intermediates_released = true;
+        m_cached_slicers.clear();
+        BOOST_LOG_TRIVIAL(debug) << "Filling, ironing and releasing layers in parallel - start";
+        // The layers are processed in about ten batches, the progress is reported after each batch.
+        size_t batch_size = std::max<size_t>(1, (m_layers.size() + 9) / 10);
+        for (size_t batch_begin = 0; batch_begin < m_layers.size(); batch_begin += batch_size) {
+            size_t batch_end = std::min(batch_begin + batch_size, m_layers.size());
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(batch_begin, batch_end),
+                [this, infill, ironing](const tbb::blocked_range<size_t>& range) {
+                    ClipperLib::Arena      arena;
+                    ClipperLib::ArenaScope arena_scope(arena);
+                    for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                        m_print->throw_if_canceled();
+                        Layer *layer = m_layers[layer_idx];
+                        if (infill)
+                            layer->make_fills();
+                        // The first layer is not ironed, see PrintObject::ironing().
+                        if (ironing && layer_idx > 0)
+                            layer->make_ironing();
+                        // Neither the infill nor the ironing of the other layers read the data of this layer.
+                        layer->release_intermediates();
+                        arena.release();
+                    }
+                }
+            );
+            m_print->throw_if_canceled();
+            m_print->set_status(70, (boost::format(L("Infilling layers %1% of %2%")) % batch_end % m_layers.size()).str());
+        }
+        BOOST_LOG_TRIVIAL(debug) << "Filling, ironing and releasing layers in parallel - end";
+        if (infill)
+            this->set_done(posInfill);
+        if (ironing)
+            this->set_done(posIroning);
+    }
+}
+
 void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
@@ -428,6 +528,74 @@ void PrintObject::generate_support_material()
     }
 }
 
+void PrintObject::release_intermediates()
+{
+    assert(this->is_step_done_unguarded(posSupportMaterial));
+    BOOST_LOG_TRIVIAL(debug) << "Releasing intermediate layer data in parallel - start";
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                m_layers[layer_idx]->release_intermediates();
+        }
+    );
+    BOOST_LOG_TRIVIAL(debug) << "Releasing intermediate layer data in parallel - end";
+    m_intermediates_released = true;
+    // The object will be sliced from scratch.
+    m_cached_slicers.clear();
+}
+
+PrintObjectMemoryUsed PrintObject::memory_used() const
+{
+    PrintObjectMemoryUsed out;
+    out.layers.reserve(m_layers.size());
+    for (const Layer *layer : m_layers)
+        out.layers.emplace_back(layer->memory_used());
+    out.support_layers.reserve(m_support_layers.size());
+    for (const SupportLayer *layer : m_support_layers)
+        out.support_layers.emplace_back(layer->memory_used());
+    return out;
+}
+
+LayerMemoryUsed PrintObjectMemoryUsed::total() const
+{
+    LayerMemoryUsed out;
+    for (const LayerMemoryUsed &layer : this->layers)
+        out += layer;
+    for (const LayerMemoryUsed &layer : this->support_layers)
+        out += layer;
+    return out;
+}
+
+size_t PrintObjectMemoryUsed::step(PrintObjectStep step) const
+{
+    LayerMemoryUsed total = this->total();
+    size_t          out   = 0;
+    for (size_t type = 0; type < ldtCount; ++ type)
+        if (producing_step(LayerDataType(type)) == step)
+            out += total.bytes[type];
+    return out;
+}
+
+PrintObjectStep PrintObjectMemoryUsed::producing_step(LayerDataType type)
+{
+    switch (type) {
+    case ldtLayers:
+    case ldtLSlices:
+    case ldtRegionSlices:   return posSlice;
+    case ldtFillExPolygons:
+    case ldtFillSurfaces:
+    case ldtPerimeters:
+    case ldtThinFills:      return posPerimeters;
+    // LayerRegion::bridged and LayerRegion::unsupported_bridge_edges are produced by process_external_surfaces().
+    case ldtBridged:        return posPrepareInfill;
+    case ldtFills:          return posInfill;
+    case ldtSupportIslands:
+    case ldtSupportFills:   return posSupportMaterial;
+    default:                assert(false); return posCount;
+    }
+}
+
 void PrintObject::clear_layers()
 {
     for (Layer *l : m_layers)
@@ -461,7 +629,7 @@ SupportLayerPtrs::const_iterator PrintObject::insert_support_layer(SupportLayerP
 
 // Called by Print::apply().
 // This method only accepts PrintObjectConfig and PrintRegionConfig option keys.
-bool PrintObject::invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys)
+bool PrintObject::invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys, const std::vector<t_layer_height_range> *ranges)
 {
     if (opt_keys.empty())
         return false;
@@ -592,12 +760,19 @@ bool PrintObject::invalidate_state_by_config_options(const std::vector<t_config_
 
     sort_remove_duplicates(steps);
     for (PrintObjectStep step : steps)
-        invalidated |= this->invalidate_step(step);
+        invalidated |= (ranges == nullptr) ? this->invalidate_step(step) : this->invalidate_step_ranges(step, *ranges);
     return invalidated;
 }
 
 bool PrintObject::invalidate_step(PrintObjectStep step)
 {
+    if (m_intermediates_released) {
+        // The data needed to recalculate the step were released, the object has to be sliced again.
+        if (step != posSlice)
+            return this->invalidate_step(posSlice);
+        m_intermediates_released = false;
+    }
+
 	bool invalidated = Inherited::invalidate_step(step);
     
     // propagate to dependent steps
@@ -612,6 +787,8 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 		invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posSupportMaterial });
 		invalidated |= m_print->invalidate_steps({ psSkirt, psBrim });
         this->m_slicing_params.valid = false;
+        this->m_reuse_layers = false;
+        this->m_cached_slicers.clear();
     } else if (step == posSupportMaterial) {
         invalidated |= m_print->invalidate_steps({ psSkirt, psBrim });
         this->m_slicing_params.valid = false;
@@ -626,16 +803,47 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
     return invalidated;
 }
 
+bool PrintObject::invalidate_step_ranges(PrintObjectStep step, const std::vector<t_layer_height_range> &ranges)
+{
+    if (step != posPerimeters || m_intermediates_released)
+        return this->invalidate_step(step);
+
+    bool invalidated = Inherited::invalidate_step_ranges(step, ranges);
+    // propagate to dependent steps, the infill preparation works over many layers, it is processed as a whole.
+    invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill });
+    invalidated |= m_print->invalidate_steps({ psSkirt, psBrim });
+    invalidated |= m_print->invalidate_step(psWipeTower);
+    invalidated |= m_print->invalidate_step(psGCodeExport);
+    return invalidated;
+}
+
 bool PrintObject::invalidate_all_steps()
 {
 	// First call the "invalidate" functions, which may cancel background processing.
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	this->m_slicing_params.valid = false;
+	this->m_reuse_layers = false;
+	this->m_intermediates_released = false;
+	this->m_cached_slicers.clear();
 	this->region_volumes.clear();
 	return result;
 }
 
+bool PrintObject::invalidate_layer_height_profile()
+{
+    // Only the layers of a finished slicing may be reused, a canceled slicing may have left some of the layers empty.
+    if (! this->is_step_done_unguarded(posSlice) || m_intermediates_released)
+        return this->invalidate_step(posSlice);
+    // The reused layers keep their perimeters, the slicing marks the newly sliced layers for posPerimeters.
+    bool invalidated = this->invalidate_step_ranges(posPerimeters, {});
+    invalidated |= this->invalidate_step(posSupportMaterial);
+    invalidated |= Inherited::invalidate_step(posSlice);
+    m_slicing_params.valid = false;
+    m_reuse_layers = true;
+    return invalidated;
+}
+
 bool PrintObject::has_support_material() const
 {
     return m_config.support_material
@@ -1608,12 +1816,10 @@ bool PrintObject::update_layer_height_profile(const ModelObject &model_object, c
 // Resulting expolygons of layer regions are marked as Internal.
 //
 // this should be idempotent
-void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
+LayerPtrs PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
 {
     BOOST_LOG_TRIVIAL(info) << "Slicing objects..." << log_memory_info();
 
-    m_typed_slices = false;
-
 #ifdef SLIC3R_PROFILE
     // Disable parallelization so the Shiny profiler works
     static tbb::task_scheduler_init *tbb_init = nullptr;
@@ -1622,30 +1828,86 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
 
     // 1) Initialize layers and their slice heights.
     std::vector<float> slice_zs;
+    // Layers to be sliced, matching slice_zs. The other layers of m_layers were kept from the previous slicing.
+    LayerPtrs          new_layers;
     {
-        this->clear_layers();
+        // If just the layer height profile changed, the layers of the previous slicing at unchanged Z are reused.
+        LayerPtrs old_layers;
+        if (m_reuse_layers) {
+            old_layers = std::move(m_layers);
+            m_layers.clear();
+            if (m_typed_slices)
+                for (Layer *layer : old_layers)
+                    layer->merge_slices();
+        } else
+            this->clear_layers();
+        m_reuse_layers = false;
+        m_typed_slices = false;
         // Object layers (pairs of bottom/top Z coordinate), without the raft.
         std::vector<coordf_t> object_layers = generate_object_layers(m_slicing_params, layer_height_profile);
         // Reserve object layers for the raft. Last layer of the raft is the contact layer.
         int id = int(m_slicing_params.raft_layers());
         slice_zs.reserve(object_layers.size());
-        Layer *prev = nullptr;
+        new_layers.reserve(object_layers.size() / 2);
+        auto   it_old = old_layers.begin();
+        Layer *prev   = nullptr;
+        // Z ranges of the newly sliced layers, in object coordinates.
+        std::vector<t_layer_height_range> new_layers_ranges;
         for (size_t i_layer = 0; i_layer < object_layers.size(); i_layer += 2) {
             coordf_t lo = object_layers[i_layer];
             coordf_t hi = object_layers[i_layer + 1];
             coordf_t slice_z = 0.5 * (lo + hi);
-            Layer *layer = this->add_layer(id ++, hi - lo, hi + m_slicing_params.object_print_z_min, slice_z);
-            slice_zs.push_back(float(slice_z));
+            coordf_t print_z = hi + m_slicing_params.object_print_z_min;
+            // Both the old and the new layers are sorted by print_z.
+            while (it_old != old_layers.end() && (*it_old)->print_z < print_z - EPSILON)
+                ++ it_old;
+            Layer *layer = nullptr;
+            if (it_old != old_layers.end() && std::abs((*it_old)->print_z - print_z) < EPSILON && std::abs((*it_old)->height - (hi - lo)) < EPSILON) {
+                // Keep the layer of the previous slicing.
+                layer = *it_old;
+                *it_old ++ = nullptr;
+                layer->set_id(id ++);
+                layer->height      = hi - lo;
+                layer->print_z     = print_z;
+                layer->slice_z     = slice_z;
+                layer->upper_layer = nullptr;
+                layer->lower_layer = nullptr;
+                m_layers.emplace_back(layer);
+            } else {
+                layer = this->add_layer(id ++, hi - lo, print_z, slice_z);
+                slice_zs.push_back(float(slice_z));
+                new_layers.emplace_back(layer);
+                // Extend the invalid range of perimeters over consecutive newly sliced layers.
+                if (! new_layers_ranges.empty() && std::abs(new_layers_ranges.back().second - lo) < EPSILON)
+                    new_layers_ranges.back().second = hi;
+                else
+                    new_layers_ranges.emplace_back(lo, hi);
+                // Make sure all layers contain layer region objects for all regions.
+                for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id)
+                    layer->add_region(this->print()->regions()[region_id]);
+            }
             if (prev != nullptr) {
                 prev->upper_layer = layer;
                 layer->lower_layer = prev;
             }
-            // Make sure all layers contain layer region objects for all regions.
-            for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id)
-                layer->add_region(this->print()->regions()[region_id]);
             prev = layer;
         }
+        // Release the layers of the previous slicing, which were not reused.
+        for (Layer *layer : old_layers)
+            delete layer;
+        // If just some of the layers were invalidated for the perimeters, add the newly sliced layers.
+        for (const t_layer_height_range &range : new_layers_ranges)
+            this->add_step_invalid_range(posPerimeters, range);
+        if (! old_layers.empty())
+            BOOST_LOG_TRIVIAL(info) << "Slicing objects - " << m_layers.size() - new_layers.size() << " of " << m_layers.size() << " layers kept from the previous slicing";
+        m_slicing_subrange = new_layers.size() < m_layers.size();
+        if (! m_slicing_subrange)
+            // The slicers are cached for the partial re-slicing only.
+            m_cached_slicers.clear();
     }
+    if (new_layers.empty())
+        // All layers were kept from the previous slicing.
+        return new_layers;
 
     // Count model parts and modifier meshes, check whether the model parts are of the same region.
     int              all_volumes_single_region = -2; // not set yet
@@ -1690,7 +1952,7 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
             m_print->throw_if_canceled();
             BOOST_LOG_TRIVIAL(debug) << "Slicing objects - append slices " << region_id << " start";
             for (size_t layer_id = 0; layer_id < expolygons_by_layer.size(); ++ layer_id)
-                m_layers[layer_id]->regions()[region_id]->slices.append(std::move(expolygons_by_layer[layer_id]), stInternal);
+                new_layers[layer_id]->regions()[region_id]->slices.append(std::move(expolygons_by_layer[layer_id]), stInternal);
             m_print->throw_if_canceled();
             BOOST_LOG_TRIVIAL(debug) << "Slicing objects - append slices " << region_id << " end";
         }
@@ -1734,7 +1996,7 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
         BOOST_LOG_TRIVIAL(debug) << "Slicing objects - parallel clipping - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, slice_zs.size()),
-            [this, &sliced_volumes, num_modifiers](const tbb::blocked_range<size_t>& range) {
+            [this, &sliced_volumes, &new_layers, num_modifiers](const tbb::blocked_range<size_t>& range) {
                 float delta   = float(scale_(m_config.xy_size_compensation.value));
                 // Only upscale together with clipping if there are no modifiers, as the modifiers shall be applied before upscaling
                 // (upscaling may grow the object outside of the modifier mesh).
@@ -1770,7 +2032,7 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
                         if (num_volumes > 1)
                             // Merge the islands using a positive / negative offset.
                             expolygons = offset_ex(offset_ex(expolygons, float(scale_(EPSILON))), -float(scale_(EPSILON)));
-                        m_layers[layer_id]->regions()[region_id]->slices.append(std::move(expolygons), stInternal);
+                        new_layers[layer_id]->regions()[region_id]->slices.append(std::move(expolygons), stInternal);
                     }
                 }
             });
@@ -1791,13 +2053,13 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
             // loop through the other regions and 'steal' the slices belonging to this one
             BOOST_LOG_TRIVIAL(debug) << "Slicing modifier volumes - stealing " << region_id << " start";
             tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, m_layers.size()),
-				[this, &expolygons_by_layer, region_id](const tbb::blocked_range<size_t>& range) {
+                tbb::blocked_range<size_t>(0, new_layers.size()),
+				[this, &new_layers, &expolygons_by_layer, region_id](const tbb::blocked_range<size_t>& range) {
                     for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
                         for (size_t other_region_id = 0; other_region_id < this->region_volumes.size(); ++ other_region_id) {
                             if (region_id == other_region_id)
                                 continue;
-                            Layer       *layer = m_layers[layer_id];
+                            Layer       *layer = new_layers[layer_id];
                             LayerRegion *layerm = layer->m_regions[region_id];
                             LayerRegion *other_layerm = layer->m_regions[other_region_id];
                             if (layerm == nullptr || other_layerm == nullptr || other_layerm->slices.empty() || expolygons_by_layer[layer_id].empty())
@@ -1820,9 +2082,10 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
     
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - removing top empty layers";
     while (! m_layers.empty()) {
-        const Layer *layer = m_layers.back();
+        Layer *layer = m_layers.back();
         if (! layer->empty())
             goto end;
+        new_layers.erase(std::remove(new_layers.begin(), new_layers.end(), layer), new_layers.end());
         delete layer;
         m_layers.pop_back();
 		if (! m_layers.empty())
@@ -1842,15 +2105,17 @@ end:
         	0.f;
         // Uncompensated slices for the first layer in case the Elephant foot compensation is applied.
 	    ExPolygons  lslices_1st_layer;
+	    // Is the first layer being sliced, or was it kept from the previous slicing?
+	    const bool  first_layer_sliced = ! new_layers.empty() && new_layers.front() == m_layers.front();
 	    tbb::parallel_for(
-	        tbb::blocked_range<size_t>(0, m_layers.size()),
-			[this, upscaled, clipped, xy_compensation_scaled, elephant_foot_compensation_scaled, &lslices_1st_layer]
+	        tbb::blocked_range<size_t>(0, new_layers.size()),
+			[this, &new_layers, first_layer_sliced, upscaled, clipped, xy_compensation_scaled, elephant_foot_compensation_scaled, &lslices_1st_layer]
 				(const tbb::blocked_range<size_t>& range) {
 	            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
 	                m_print->throw_if_canceled();
-	                Layer *layer = m_layers[layer_id];
+	                Layer *layer = new_layers[layer_id];
 	                // Apply size compensation and perform clipping of multi-part objects.
-	                float elfoot = (layer_id == 0) ? elephant_foot_compensation_scaled : 0.f;
+	                float elfoot = (layer_id == 0 && first_layer_sliced) ? elephant_foot_compensation_scaled : 0.f;
 	                if (layer->m_regions.size() == 1) {
 	                	assert(! upscaled);
 	                	assert(! clipped);
@@ -1919,7 +2184,7 @@ end:
 	                layer->make_slices();
 	            }
 	        });
-	    if (elephant_foot_compensation_scaled > 0.f) {
+	    if (elephant_foot_compensation_scaled > 0.f && first_layer_sliced) {
 	    	// The Elephant foot has been compensated, therefore the 1st layer's lslices are shrank with the Elephant foot compensation value.
 	    	// Store the uncompensated value there.
 	    	assert(! m_layers.empty());
@@ -1930,10 +2195,11 @@ end:
 
     m_print->throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - make_slices in parallel - end";
+    return new_layers;
 }
 
 // To be used only if there are no layer span specific configurations applied, which would lead to z ranges being generated for this region.
-std::vector<ExPolygons> PrintObject::slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode) const
+std::vector<ExPolygons> PrintObject::slice_region(size_t region_id, const std::vector<float> &z, SlicingMode mode)
 {
 	std::vector<const ModelVolume*> volumes;
     if (region_id < this->region_volumes.size()) {
@@ -1943,11 +2209,11 @@ std::vector<ExPolygons> PrintObject::slice_region(size_t region_id, const std::v
 				volumes.emplace_back(volume);
 		}
     }
-	return this->slice_volumes(z, mode, volumes);
+	return this->slice_volumes_cached(z, mode, volumes);
 }
 
 // Z ranges are not applicable to modifier meshes, therefore a sinle volume will be found in volume_and_range at most once.
-std::vector<ExPolygons> PrintObject::slice_modifiers(size_t region_id, const std::vector<float> &slice_zs) const
+std::vector<ExPolygons> PrintObject::slice_modifiers(size_t region_id, const std::vector<float> &slice_zs)
 {
 	std::vector<ExPolygons> out;
     if (region_id < this->region_volumes.size())
@@ -1993,7 +2259,7 @@ std::vector<ExPolygons> PrintObject::slice_modifiers(size_t region_id, const std
 					if (volume->is_modifier())
 						volumes.emplace_back(volume);
 				}
-				out = this->slice_volumes(slice_zs, SlicingMode::Regular, volumes);
+				out = this->slice_volumes_cached(slice_zs, SlicingMode::Regular, volumes);
 			} else {
 				// Some modifier in this region was split to layer spans.
 				std::vector<char> merge;
@@ -2053,29 +2319,37 @@ std::vector<ExPolygons> PrintObject::slice_support_volumes(const ModelVolumeType
     return this->slice_volumes(zs, SlicingMode::Regular, volumes);
 }
 
+// Compose the mesh of the volumes in the coordinate system of the object slices.
+TriangleMesh PrintObject::volumes_mesh(const std::vector<const ModelVolume*> &volumes) const
+{
+    //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
+	TriangleMesh mesh(volumes.front()->mesh());
+    mesh.transform(volumes.front()->get_matrix(), true);
+	assert(mesh.repaired);
+	if (volumes.size() == 1 && mesh.repaired) {
+		//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
+		stl_check_facets_exact(&mesh.stl);
+	}
+    for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
+        const ModelVolume &model_volume = *volumes[idx_volume];
+        TriangleMesh vol_mesh(model_volume.mesh());
+        vol_mesh.transform(model_volume.get_matrix(), true);
+        mesh.merge(vol_mesh);
+    }
+    if (mesh.stl.stats.number_of_facets > 0) {
+        mesh.transform(m_trafo, true);
+        // apply XY shift
+        mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
+    }
+    return mesh;
+}
+
 std::vector<ExPolygons> PrintObject::slice_volumes(const std::vector<float> &z, SlicingMode mode, const std::vector<const ModelVolume*> &volumes) const
 {
     std::vector<ExPolygons> layers;
     if (! volumes.empty()) {
-        // Compose mesh.
-        //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-		TriangleMesh mesh(volumes.front()->mesh());
-        mesh.transform(volumes.front()->get_matrix(), true);
-		assert(mesh.repaired);
-		if (volumes.size() == 1 && mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-        for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
-            const ModelVolume &model_volume = *volumes[idx_volume];
-            TriangleMesh vol_mesh(model_volume.mesh());
-            vol_mesh.transform(model_volume.get_matrix(), true);
-            mesh.merge(vol_mesh);
-        }
+        TriangleMesh mesh = this->volumes_mesh(volumes);
         if (mesh.stl.stats.number_of_facets > 0) {
-            mesh.transform(m_trafo, true);
-            // apply XY shift
-            mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
             // perform actual slicing
             const Print *print = this->print();
             auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
@@ -2090,6 +2364,41 @@ std::vector<ExPolygons> PrintObject::slice_volumes(const std::vector<float> &z,
     return layers;
 }
 
+std::vector<ExPolygons> PrintObject::slice_volumes_cached(const std::vector<float> &z, SlicingMode mode, const std::vector<const ModelVolume*> &volumes)
+{
+    if (! m_slicing_subrange || volumes.empty())
+        return this->slice_volumes(z, mode, volumes);
+
+    std::vector<ObjectID> volume_ids;
+    volume_ids.reserve(volumes.size());
+    for (const ModelVolume *volume : volumes)
+        volume_ids.emplace_back(volume->id());
+    const Print *print = this->print();
+    auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
+    auto it = std::find_if(m_cached_slicers.begin(), m_cached_slicers.end(), [&volume_ids](const CachedSlicer &cached) { return cached.volume_ids == volume_ids; });
+    if (it == m_cached_slicers.end()) {
+        CachedSlicer cached;
+        cached.volume_ids = std::move(volume_ids);
+        cached.mesh       = std::make_unique<TriangleMesh>(this->volumes_mesh(volumes));
+        if (cached.mesh->stl.stats.number_of_facets > 0) {
+            // TriangleMeshSlicer needs shared vertices, also this calls the repair() function.
+            cached.mesh->require_shared_vertices();
+            cached.slicer = std::make_unique<TriangleMeshSlicer>();
+            cached.slicer->init(cached.mesh.get(), callback);
+            BOOST_LOG_TRIVIAL(debug) << "Slicing objects - building the facet Z index";
+            cached.slicer->build_facet_z_index();
+        }
+        m_cached_slicers.emplace_back(std::move(cached));
+        it = m_cached_slicers.end() - 1;
+    }
+    std::vector<ExPolygons> layers;
+    if (it->slicer) {
+        it->slicer->slice(z, mode, float(m_config.slice_closing_radius.value), &layers, callback);
+        m_print->throw_if_canceled();
+    }
+    return layers;
+}
+
 std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float> &z, SlicingMode mode, const ModelVolume &volume) const
 {
     std::vector<ExPolygons> layers;
@@ -2241,15 +2550,15 @@ std::string PrintObject::_fix_slicing_errors()
 // Simplify the sliced model, if "resolution" configuration parameter > 0.
 // The simplification is problematic, because it simplifies the slices independent from each other,
 // which makes the simplified discretization visible on the object surface.
-void PrintObject::simplify_slices(double distance)
+void PrintObject::simplify_slices(double distance, const LayerPtrs &layers)
 {
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - siplifying slices in parallel - begin";
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this, distance](const tbb::blocked_range<size_t>& range) {
+        tbb::blocked_range<size_t>(0, layers.size()),
+        [this, distance, &layers](const tbb::blocked_range<size_t>& range) {
             for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                 m_print->throw_if_canceled();
-                Layer *layer = m_layers[layer_idx];
+                Layer *layer = layers[layer_idx];
                 for (size_t region_idx = 0; region_idx < layer->m_regions.size(); ++ region_idx)
                     layer->m_regions[region_idx]->slices.simplify(distance);
 				{
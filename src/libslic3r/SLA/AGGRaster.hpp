@@ -36,30 +36,16 @@ template<class Color> struct Colors {
 template<class Color> const Color Colors<Color>::White = Color{255};
 template<class Color> const Color Colors<Color>::Black = Color{0};
 
-template<class PixelRenderer,
-         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
-         class Rasterizer = agg::rasterizer_scanline_aa<>,
+// Transformation of the polygons into the raster coordinates and their
+// scanline rasterization, independent of how the pixels are stored.
+template<class Rasterizer = agg::rasterizer_scanline_aa<>,
          class Scanline   = agg::scanline_p8>
-class AGGRaster: public RasterBase {
-public:
-    using TColor = typename PixelRenderer::color_type;
-    using TValue = typename TColor::value_type;
-    using TPixel = typename PixelRenderer::pixel_type;
-    using TRawBuffer = agg::rendering_buffer;
-    
+class AGGRasterizer: public RasterBase {
 protected:
     
     Resolution m_resolution;
     PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
     
-    std::vector<TPixel> m_buf;
-    agg::rendering_buffer m_rbuf;
-    
-    PixelRenderer m_pixrenderer;
-    
-    agg::renderer_base<PixelRenderer> m_raw_renderer;
-    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
-    
     Trafo m_trafo;
     Scanline m_scanlines;
     Rasterizer m_rasterizer;
@@ -117,16 +103,66 @@ protected:
         return path;
     }
     
-    template<class P> void _draw(const P &poly)
+    // The renderer receives the scanlines of the polygon, see agg::render_scanlines().
+    template<class P, class ScanlineRenderer>
+    void _draw(const P &poly, ScanlineRenderer &renderer)
     {
         m_rasterizer.reset();
         
         m_rasterizer.add_path(to_path(contour(poly)));
         for(auto& h : holes(poly)) m_rasterizer.add_path(to_path(h));
         
-        agg::render_scanlines(m_rasterizer, m_scanlines, m_renderer);
+        agg::render_scanlines(m_rasterizer, m_scanlines, renderer);
     }
     
+public:
+    template<class GammaFn>
+    AGGRasterizer(const Resolution &res,
+                  const PixelDim &  pd,
+                  const Trafo &     trafo,
+                  GammaFn &&        gammafn)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm)
+        , m_trafo(trafo)
+    {
+        m_rasterizer.gamma(gammafn);
+    }
+    
+    Trafo trafo() const override { return m_trafo; }
+    Resolution resolution() const override { return m_resolution; }
+    PixelDim   pixel_dimensions() const override
+    {
+        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+    }
+};
+
+template<class PixelRenderer,
+         template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
+         class Rasterizer = agg::rasterizer_scanline_aa<>,
+         class Scanline   = agg::scanline_p8>
+class AGGRaster: public AGGRasterizer<Rasterizer, Scanline> {
+    using Base = AGGRasterizer<Rasterizer, Scanline>;
+    
+public:
+    using TColor = typename PixelRenderer::color_type;
+    using TValue = typename TColor::value_type;
+    using TPixel = typename PixelRenderer::pixel_type;
+    using TRawBuffer = agg::rendering_buffer;
+    using typename Base::Resolution;
+    using typename Base::PixelDim;
+    using typename Base::Trafo;
+    
+protected:
+    
+    std::vector<TPixel> m_buf;
+    agg::rendering_buffer m_rbuf;
+    
+    PixelRenderer m_pixrenderer;
+    
+    agg::renderer_base<PixelRenderer> m_raw_renderer;
+    Renderer<agg::renderer_base<PixelRenderer>> m_renderer;
+    
 public:
     template<class GammaFn>
     AGGRaster(const Resolution &res,
@@ -135,8 +171,7 @@ public:
               const TColor &    foreground,
               const TColor &    background,
               GammaFn &&        gammafn)
-        : m_resolution(res)
-        , m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm)
+        : Base(res, pd, trafo, std::forward<GammaFn>(gammafn))
         , m_buf(res.pixels())
         , m_rbuf(reinterpret_cast<TValue *>(m_buf.data()),
                  unsigned(res.width_px),
@@ -145,28 +180,17 @@ public:
         , m_pixrenderer(m_rbuf)
         , m_raw_renderer(m_pixrenderer)
         , m_renderer(m_raw_renderer)
-        , m_trafo(trafo)
     {
         m_renderer.color(foreground);
         clear(background);
-        
-        m_rasterizer.gamma(gammafn);
-    }
-    
-    Trafo trafo() const override { return m_trafo; }
-    Resolution resolution() const override { return m_resolution; }
-    PixelDim   pixel_dimensions() const override
-    {
-        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
-                SCALING_FACTOR / m_pxdim_scaled.h_mm};
     }
     
-    void draw(const ExPolygon &poly) override { _draw(poly); }
-    void draw(const ClipperLib::Polygon &poly) override { _draw(poly); }
+    void draw(const ExPolygon &poly) override { this->_draw(poly, m_renderer); }
+    void draw(const ClipperLib::Polygon &poly) override { this->_draw(poly, m_renderer); }
     
     EncodedRaster encode(RasterEncoder encoder) const override
     {
-        return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);    
+        return encoder(m_buf.data(), this->m_resolution.width_px, this->m_resolution.height_px, 1);    
     }
     
     void clear(const TColor color) { m_raw_renderer.clear(color); }
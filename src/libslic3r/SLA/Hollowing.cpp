@@ -1,4 +1,7 @@
 #include <functional>
+#include <map>
+#include <array>
+#include <limits>
 
 #include <libslic3r/OpenVDBUtils.hpp>
 #include <libslic3r/TriangleMesh.hpp>
@@ -26,23 +29,27 @@ inline void _scale(S s, TriangleMesh &m) { m.scale(float(s)); }
 template<class S, class = FloatingOnly<S>>
 inline void _scale(S s, Contour3D &m) { for (auto &p : m.points) p *= s; }
 
-static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
-                                       const JobController &ctl,
-                                       double               min_thickness,
-                                       double               voxel_scale,
-                                       double               closing_dist)
+// Interior surface of a mesh scaled up by voxel_scale, in the voxel space.
+static Contour3D _grid_interior(const TriangleMesh  &imesh,
+                                const JobController &ctl,
+                                double               min_thickness,
+                                double               voxel_scale,
+                                double               closing_dist,
+                                unsigned             status_begin = 0,
+                                unsigned             status_end   = 100)
 {
-    TriangleMesh imesh{mesh};
-    
-    _scale(voxel_scale, imesh);
-    
     double offset = voxel_scale * min_thickness;
     double D = voxel_scale * closing_dist;
     float  out_range = 0.1f * float(offset);
     float  in_range = 1.1f * float(offset + D);
     
+    auto status = [&ctl, status_begin, status_end](unsigned st) {
+        ctl.statuscb(status_begin + (status_end - status_begin) * st / 100,
+                     L("Hollowing"));
+    };
+    
     if (ctl.stopcondition()) return {};
-    else ctl.statuscb(0, L("Hollowing"));
+    else status(0);
     
     auto gridptr = mesh_to_grid(imesh, {}, out_range, in_range);
     
@@ -53,21 +60,274 @@ static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
         return {};
     }
     
+    BOOST_LOG_TRIVIAL(debug) << "Hollowing: level set of "
+                             << gridptr->activeVoxelCount() << " voxels, "
+                             << gridptr->memUsage() / 1048576 << " MB";
+    
     if (ctl.stopcondition()) return {};
-    else ctl.statuscb(30, L("Hollowing"));
+    else status(30);
     
     if (closing_dist > .0) {
-        gridptr = redistance_grid(*gridptr, -(offset + D), double(in_range));
+        auto redistanced = redistance_grid(*gridptr, -(offset + D), double(in_range));
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: redistanced level set of "
+                                 << redistanced->activeVoxelCount() << " voxels, "
+                                 << redistanced->memUsage() / 1048576 << " MB";
+        gridptr = std::move(redistanced);
     } else {
         D = -offset;
     }
     
     if (ctl.stopcondition()) return {};
-    else ctl.statuscb(70, L("Hollowing"));
+    else status(70);
     
     double iso_surface = D;
     double adaptivity = 0.;
-    auto omesh = grid_to_mesh(*gridptr, iso_surface, adaptivity);
+    return grid_to_contour3d(*gridptr, iso_surface, adaptivity);
+}
+
+// Rough estimate of the memory taken by the narrow band level set of a
+// surface, both the area and the band width in voxels. The band is stored
+// in leaf nodes of 8^3 float voxels, and redistancing holds two such grids.
+static double estimate_grid_memory(double area, double band_width)
+{
+    return 2. * area * (band_width + 8.) * sizeof(float);
+}
+
+// Surface area of the mesh binned along Z into bins of unit height
+// starting at zmin, the area of a facet is split evenly among the bins
+// it spans.
+static std::vector<double> facet_area_histogram(const TriangleMesh &mesh,
+                                                double zmin, size_t nbins)
+{
+    std::vector<double> bins(nbins, 0.);
+    auto bin = [zmin, nbins](float z) {
+        return std::min(size_t(std::max(0., std::floor(double(z) - zmin))), nbins - 1);
+    };
+    for (const stl_facet &f : mesh.stl.facet_start) {
+        double area = 0.5 * (f.vertex[1] - f.vertex[0]).cast<double>().cross(
+                                (f.vertex[2] - f.vertex[0]).cast<double>()).norm();
+        size_t b0 = bin(std::min({f.vertex[0].z(), f.vertex[1].z(), f.vertex[2].z()}));
+        size_t b1 = bin(std::max({f.vertex[0].z(), f.vertex[1].z(), f.vertex[2].z()}));
+        for (size_t b = b0; b <= b1; ++b) bins[b] += area / double(b1 - b0 + 1);
+    }
+    return bins;
+}
+
+// Z coordinates of the seams between the slabs in which the mesh is to be
+// processed, so that the grids of each slab including its margins fit into
+// max_memory. Slabs are not made thinner than their margin, so the limit
+// may not be met for meshes with a dense surface.
+static std::vector<double> plan_slabs(const TriangleMesh &imesh,
+                                      double margin, double band_width,
+                                      size_t max_memory)
+{
+    BoundingBoxf3 bb = imesh.bounding_box();
+    double zmin = bb.min.z(), height = bb.size().z();
+    size_t nbins = size_t(std::ceil(height)) + 1;
+    
+    std::vector<double> area_below(nbins + 1, 0.);
+    std::vector<double> bins = facet_area_histogram(imesh, zmin, nbins);
+    for (size_t b = 0; b < nbins; ++b) area_below[b + 1] = area_below[b] + bins[b];
+    
+    // Area of the facets overlapping the Z range, rounded outwards to bins.
+    auto area_between = [&area_below, zmin, nbins](double lo, double hi) {
+        auto idx = [zmin, nbins](double z) {
+            return std::min(size_t(std::max(0., z - zmin)), nbins);
+        };
+        return area_below[idx(std::ceil(hi))] - area_below[idx(std::floor(lo))];
+    };
+    
+    double total = estimate_grid_memory(area_below.back(), band_width);
+    BOOST_LOG_TRIVIAL(info) << "Hollowing: estimated grid memory "
+                            << size_t(total) / 1048576 << " MB";
+    
+    if (max_memory == 0 || total <= double(max_memory))
+        return {};
+    
+    size_t max_slabs = std::max(size_t(1), size_t(height / margin));
+    size_t n = 2;
+    double peak = total;
+    for (; n <= max_slabs; ++n) {
+        double h = height / n;
+        peak = 0.;
+        for (size_t k = 0; k < n; ++k)
+            peak = std::max(peak, estimate_grid_memory(
+                area_between(zmin + k * h - margin, zmin + (k + 1) * h + margin),
+                band_width));
+        if (peak <= double(max_memory)) break;
+    }
+    
+    if (n > max_slabs) {
+        n = max_slabs;
+        BOOST_LOG_TRIVIAL(warning)
+            << "Hollowing: the grid memory can not be reduced below "
+            << size_t(peak) / 1048576 << " MB";
+    }
+    
+    BOOST_LOG_TRIVIAL(info) << "Hollowing: processing in " << n << " slabs";
+    
+    std::vector<double> seams;
+    for (size_t k = 1; k < n; ++k) seams.emplace_back(zmin + k * height / n);
+    
+    return seams;
+}
+
+// Part of the mesh between zlo and zhi, closed by the cutting planes.
+static TriangleMesh cut_slab(const TriangleMesh &mesh, double zlo, double zhi)
+{
+    BoundingBoxf3 bb = mesh.bounding_box();
+    
+    TriangleMesh lower = mesh;
+    if (zhi < bb.max.z()) {
+        TriangleMesh upper;
+        lower = {};
+        TriangleMeshSlicer{&mesh}.cut(float(zhi), &upper, &lower);
+        lower.repair();
+    }
+    
+    if (zlo <= bb.min.z() || lower.empty())
+        return lower;
+    
+    TriangleMesh slab, below;
+    TriangleMeshSlicer{&lower}.cut(float(zlo), &slab, &below);
+    slab.repair();
+    
+    return slab;
+}
+
+// Key of a point on a grid of cells of size tol.
+using WeldKey = std::array<int64_t, 3>;
+static WeldKey weld_key(const Vec3d &p, double tol, const Vec3i &d = Vec3i::Zero())
+{
+    return {int64_t(std::floor(p.x() / tol)) + d.x(),
+            int64_t(std::floor(p.y() / tol)) + d.y(),
+            int64_t(std::floor(p.z() / tol)) + d.z()};
+}
+
+// The interior is generated slab by slab: Each slab is cut from the mesh
+// with a margin wide enough for the grid values inside the slab not to be
+// influenced by the cutting planes, its interior surface is generated and
+// only the faces with the centroid inside the slab are kept. The vertices
+// of the faces along a seam are generated by both of the neighboring slabs,
+// these are welded together.
+static Contour3D _grid_interior_tiled(const TriangleMesh        &imesh,
+                                      const JobController       &ctl,
+                                      double                     min_thickness,
+                                      double                     voxel_scale,
+                                      double                     closing_dist,
+                                      const std::vector<double> &seams,
+                                      double                     margin)
+{
+    // Faces along a seam have their vertices in the voxels next to it.
+    static const double SeamBand = 2.;
+    static const double WeldTolerance = 1e-3;
+    
+    const size_t nslabs = seams.size() + 1;
+    
+    Contour3D out;
+    std::map<WeldKey, int> seam_points_below, seam_points_above;
+    
+    for (size_t k = 0; k < nslabs; ++k) {
+        if (ctl.stopcondition()) return {};
+        
+        double zlo = k == 0 ? -std::numeric_limits<double>::max() : seams[k - 1];
+        double zhi = k + 1 == nslabs ? std::numeric_limits<double>::max() : seams[k];
+        
+        TriangleMesh slab = cut_slab(imesh, zlo - margin, zhi + margin);
+        
+        if (slab.empty()) continue;
+        
+        Contour3D part = _grid_interior(slab, ctl, min_thickness, voxel_scale,
+                                        closing_dist,
+                                        unsigned(100 * k / nslabs),
+                                        unsigned(100 * (k + 1) / nslabs));
+        
+        std::vector<int> remap(part.points.size(), -1);
+        auto add_point = [&](int idx) {
+            int &dst = remap[size_t(idx)];
+            if (dst >= 0) return dst;
+            
+            const Vec3d &p = part.points[size_t(idx)];
+            if (k > 0 && std::abs(p.z() - zlo) < SeamBand) {
+                double mindist = WeldTolerance;
+                for (int x = -1; x <= 1; ++x)
+                    for (int y = -1; y <= 1; ++y)
+                        for (int z = -1; z <= 1; ++z) {
+                            auto it = seam_points_below.find(
+                                weld_key(p, WeldTolerance, {x, y, z}));
+                            if (it == seam_points_below.end()) continue;
+                            double dist = (out.points[size_t(it->second)] - p).norm();
+                            if (dist <= mindist) { mindist = dist; dst = it->second; }
+                        }
+            }
+            
+            if (dst < 0) {
+                dst = int(out.points.size());
+                out.points.emplace_back(p);
+                if (k + 1 < nslabs && std::abs(p.z() - zhi) < SeamBand)
+                    seam_points_above.emplace(weld_key(p, WeldTolerance), dst);
+            }
+            
+            return dst;
+        };
+        
+        auto in_slab = [&part, zlo, zhi](auto &face) {
+            double z = 0.;
+            for (int i = 0; i < face.size(); ++i) z += part.points[size_t(face(i))].z();
+            z /= face.size();
+            return z >= zlo && z < zhi;
+        };
+        
+        for (const Vec3i &face : part.faces3)
+            if (in_slab(face))
+                out.faces3.emplace_back(add_point(face(0)), add_point(face(1)),
+                                        add_point(face(2)));
+        
+        for (const Vec4i &face : part.faces4)
+            if (in_slab(face))
+                out.faces4.emplace_back(add_point(face(0)), add_point(face(1)),
+                                        add_point(face(2)), add_point(face(3)));
+        
+        seam_points_below = std::move(seam_points_above);
+        seam_points_above.clear();
+    }
+    
+    return out;
+}
+
+static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
+                                       const JobController &ctl,
+                                       double               min_thickness,
+                                       double               voxel_scale,
+                                       double               closing_dist,
+                                       size_t               max_memory)
+{
+    TriangleMesh imesh{mesh};
+    
+    _scale(voxel_scale, imesh);
+    
+    double offset = voxel_scale * min_thickness;
+    double D = voxel_scale * closing_dist;
+    double band_width = 0.1 * offset + 1.1 * (offset + D);
+    
+    // The cutting planes shift the level set up to the interior band width
+    // away from them, redistancing moves the shifted iso surface another
+    // offset + D further.
+    double margin = 1.1 * (offset + D) + offset + D + 3.;
+    std::vector<double> seams = plan_slabs(imesh, margin, band_width, max_memory);
+    
+    // The slabs are cut by TriangleMeshSlicer, which works on the indexed mesh.
+    if (! seams.empty())
+        imesh.require_shared_vertices();
+    
+    Contour3D interior = seams.empty() ?
+        _grid_interior(imesh, ctl, min_thickness, voxel_scale, closing_dist) :
+        _grid_interior_tiled(imesh, ctl, min_thickness, voxel_scale,
+                             closing_dist, seams, margin);
+    
+    if (ctl.stopcondition() || interior.empty()) return {};
+    
+    auto omesh = to_triangle_mesh(std::move(interior));
     
     _scale(1. / voxel_scale, omesh);
     
@@ -94,7 +354,7 @@ std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
     auto voxel_scale = MIN_OVERSAMPL + (MAX_OVERSAMPL - MIN_OVERSAMPL) * hc.quality;
     auto meshptr = std::make_unique<TriangleMesh>(
         _generate_interior(mesh, ctl, hc.min_thickness, voxel_scale,
-                           hc.closing_distance));
+                           hc.closing_distance, hc.max_memory));
     
     if (meshptr && !meshptr->empty()) {
         
@@ -17,6 +17,11 @@ struct HollowingConfig
     double quality          = 0.5;
     double closing_distance = 0.5;
     bool enabled = true;
+
+    // Upper bound of the memory used by the OpenVDB grids in bytes, zero
+    // for no limit. If the estimate exceeds it, the mesh is processed in
+    // overlapping slabs along the Z axis, one slab at a time.
+    size_t max_memory = size_t(1) << 30;
 };
 
 struct DrainHole
@@ -5,6 +5,7 @@
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/RasterRLE.hpp>
 
 // minz image write:
 #include <miniz.h>
@@ -38,6 +39,74 @@ EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "png");
 }
 
+static mz_bool png_put_buf(const void *buf, int len, void *user)
+{
+    auto  out = static_cast<std::vector<uint8_t>*>(user);
+    auto  ptr = static_cast<const uint8_t*>(buf);
+    out->insert(out->end(), ptr, ptr + len);
+    return MZ_TRUE;
+}
+
+static void png_write_be32(uint8_t *dst, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i, v <<= 8) dst[i] = uint8_t(v >> 24);
+}
+
+// Same output as tdefl_write_image_to_png_file_in_memory() at its default
+// compression level, the rows being compressed as they are provided.
+EncodedRaster PNGRasterEncoder::operator()(const RasterRows &rows, size_t w,
+                                           size_t h, size_t num_components)
+{
+    // Number of probes of the compression level 6.
+    static constexpr mz_uint NUM_PROBES = 128;
+    static constexpr size_t  HEADER_SIZE = 41;
+    static constexpr uint8_t chans[] = { 0x00, 0x00, 0x04, 0x02, 0x06 };
+    
+    if (num_components == 0 || num_components > 4) return EncodedRaster({}, "png");
+    
+    const size_t bpl = w * num_components;
+    std::vector<uint8_t> buf(HEADER_SIZE, 0);
+    
+    // Not value initialized, the compressor is large and tdefl_init() initializes it.
+    std::unique_ptr<tdefl_compressor> comp(new tdefl_compressor);
+    tdefl_init(comp.get(), png_put_buf, &buf, NUM_PROBES | TDEFL_WRITE_ZLIB_HEADER);
+    
+    const uint8_t filter = 0;
+    for (size_t y = 0; y < h; ++y) {
+        tdefl_compress_buffer(comp.get(), &filter, 1, TDEFL_NO_FLUSH);
+        tdefl_compress_buffer(comp.get(), rows(y), bpl, TDEFL_NO_FLUSH);
+    }
+    
+    // On error, data() will return an empty vector, as with the other overload.
+    if (tdefl_compress_buffer(comp.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+        return EncodedRaster({}, "png");
+    
+    // PNG signature, IHDR chunk and the header of the IDAT chunk.
+    const size_t idat_size = buf.size() - HEADER_SIZE;
+    const uint8_t pnghdr[HEADER_SIZE] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00,
+        0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x49, 0x44, 0x41,
+        0x54 };
+    std::copy(pnghdr, pnghdr + HEADER_SIZE, buf.begin());
+    buf[18] = uint8_t(w >> 8);
+    buf[19] = uint8_t(w);
+    buf[22] = uint8_t(h >> 8);
+    buf[23] = uint8_t(h);
+    buf[25] = chans[num_components];
+    png_write_be32(buf.data() + 33, uint32_t(idat_size));
+    png_write_be32(buf.data() + 29, uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + 12, 17)));
+    
+    // IDAT CRC-32, followed by the IEND chunk.
+    static const uint8_t footer[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82 };
+    buf.insert(buf.end(), std::begin(footer), std::end(footer));
+    png_write_be32(buf.data() + buf.size() - 16,
+                   uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + HEADER_SIZE - 4, idat_size + 4)));
+    
+    return EncodedRaster(std::move(buf), "png");
+}
+
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -67,6 +136,28 @@ EncodedRaster PPMRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "ppm");
 }
 
+EncodedRaster PPMRasterEncoder::operator()(const RasterRows &rows, size_t w,
+                                           size_t h, size_t num_components)
+{
+    std::vector<uint8_t> buf;
+    
+    auto header = std::string("P5 ") +
+            std::to_string(w) + " " +
+            std::to_string(h) + " " + "255 ";
+    
+    auto bpl = w * num_components;
+    
+    buf.reserve(header.size() + bpl * h);
+    
+    std::copy(header.begin(), header.end(), std::back_inserter(buf));
+    for (size_t y = 0; y < h; ++y) {
+        const uint8_t *row = rows(y);
+        std::copy(row, row + bpl, std::back_inserter(buf));
+    }
+    
+    return EncodedRaster(std::move(buf), "ppm");
+}
+
 std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     const RasterBase::Resolution &res,
     const RasterBase::PixelDim &  pxdim,
@@ -83,6 +174,22 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_rle(
+    const RasterBase::Resolution &res,
+    const RasterBase::PixelDim &  pxdim,
+    double                        gamma,
+    const RasterBase::Trafo &     tr)
+{
+    std::unique_ptr<RasterBase> rst;
+    
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleAARLE>(res, pxdim, tr, agg::gamma_power(gamma));
+    else
+        rst = std::make_unique<RasterGrayscaleAARLE>(res, pxdim, tr, agg::gamma_threshold(.5));
+    
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
@@ -7,6 +7,7 @@
 #include <array>
 #include <utility>
 #include <cstdint>
+#include <functional>
 
 #include <libslic3r/ExPolygon.hpp>
 #include <libslic3r/SLA/Concurrency.hpp>
@@ -22,24 +23,31 @@ template<class T> using wkptr = std::weak_ptr<T>;
 namespace sla {
 
 // Raw byte buffer paired with its size. Suitable for compressed image data.
+// The buffer is immutable, copies share it, thus identical layers may share
+// a single encoded raster.
 class EncodedRaster {
 protected:
-    std::vector<uint8_t> m_buffer;
+    std::shared_ptr<const std::vector<uint8_t>> m_buffer;
     std::string m_ext;
 public:
     EncodedRaster() = default;
     explicit EncodedRaster(std::vector<uint8_t> &&buf, std::string ext)
-        : m_buffer(std::move(buf)), m_ext(std::move(ext))
+        : m_buffer(std::make_shared<const std::vector<uint8_t>>(std::move(buf))), m_ext(std::move(ext))
     {}
     
-    size_t size() const { return m_buffer.size(); }
-    const void * data() const { return m_buffer.data(); }
+    size_t size() const { return m_buffer ? m_buffer->size() : 0; }
+    const void * data() const { return m_buffer ? m_buffer->data() : nullptr; }
     const char * extension() const { return m_ext.c_str(); }
 };
 
 using RasterEncoder =
     std::function<EncodedRaster(const void *ptr, size_t w, size_t h, size_t num_components)>;
 
+// Source of the pixel rows of an image, for rasters which do not store the
+// image in a single buffer. The rows are requested in increasing order, the
+// returned pointer is valid until the next call.
+using RasterRows = std::function<const uint8_t*(size_t row)>;
+
 class RasterBase {
 public:
     
@@ -102,12 +110,16 @@ public:
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
 };
 
+// The encoders accept the image row by row as well, producing the same
+// output as for the image stored in a single buffer.
 struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+    EncodedRaster operator()(const RasterRows &rows, size_t w, size_t h, size_t num_components);
 };
 
 struct PPMRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+    EncodedRaster operator()(const RasterRows &rows, size_t w, size_t h, size_t num_components);
 };
 
 std::ostream& operator<<(std::ostream &stream, const EncodedRaster &bytes);
@@ -119,6 +131,14 @@ uqptr<RasterBase> create_raster_grayscale_aa(
     double                        gamma = 1.0,
     const RasterBase::Trafo &     tr    = {});
 
+// Same as create_raster_grayscale_aa(), the pixels are stored as runs of
+// constant values per row instead of a full buffer, see RasterGrayscaleAARLE.
+uqptr<RasterBase> create_raster_grayscale_aa_rle(
+    const RasterBase::Resolution &res,
+    const RasterBase::PixelDim &  pxdim,
+    double                        gamma = 1.0,
+    const RasterBase::Trafo &     tr    = {});
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
@@ -0,0 +1,147 @@
+#include <libslic3r/SLA/RasterRLE.hpp>
+
+#include <libslic3r/Utils.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Slic3r { namespace sla {
+
+// Append a run, merging it with the previous one if continuous and of the same value.
+static void push_run(RasterGrayscaleAARLE::Row &runs, uint32_t x, uint32_t len, uint8_t value)
+{
+    if (! runs.empty() && runs.back().value == value && runs.back().x + runs.back().len == x)
+        runs.back().len += len;
+    else
+        runs.push_back({ x, len, value });
+}
+
+void RasterGrayscaleAARLE::render_scanline(const agg::scanline_p8 &sl)
+{
+    const int y = sl.y();
+    const int w = int(m_resolution.width_px);
+    if (y < 0 || y >= int(m_resolution.height_px) || sl.num_spans() == 0)
+        return;
+
+    // Range of the pixels touched by the scanline, clipped to the raster.
+    int x_begin = std::numeric_limits<int>::max();
+    int x_end   = 0;
+    {
+        auto span = sl.begin();
+        for (unsigned n = sl.num_spans(); n > 0; -- n, ++ span) {
+            x_begin = std::min(x_begin, int(span->x));
+            x_end   = std::max(x_end, int(span->x) + std::abs(int(span->len)));
+        }
+    }
+    x_begin = std::max(x_begin, 0);
+    x_end   = std::min(x_end, w);
+    if (x_begin >= x_end)
+        return;
+
+    // Decode the runs overlapping the range.
+    Row     &row  = m_rows[size_t(y)];
+    uint8_t *line = m_line.data();
+    std::fill(line + x_begin, line + x_end, uint8_t(0));
+    auto it_begin = std::lower_bound(row.begin(), row.end(), x_begin,
+        [](const Run &run, int x) { return int(run.x + run.len) <= x; });
+    auto it_end = it_begin;
+    for (; it_end != row.end() && int(it_end->x) < x_end; ++ it_end)
+        std::fill(line + std::max(int(it_end->x), x_begin), line + std::min(int(it_end->x + it_end->len), x_end), it_end->value);
+
+    // Blend the spans, see agg::pixfmt_alpha_blend_gray::copy_or_blend_pix().
+    {
+        auto span = sl.begin();
+        for (unsigned n = sl.num_spans(); n > 0; -- n, ++ span) {
+            const int      x      = span->x;
+            const bool     solid  = span->len < 0;
+            const int      len    = std::abs(int(span->len));
+            const uint8_t *covers = span->covers;
+            for (int i = std::max(x, 0); i < std::min(x + len, w); ++ i) {
+                unsigned cover = solid ? *covers : covers[i - x];
+                if (cover == agg::cover_mask)
+                    line[i] = 255;
+                else
+                    agg::blender_gray8::blend_pix(line + i, 255, 255, cover);
+            }
+        }
+    }
+
+    // Encode the range back, keeping the parts of the boundary runs outside of it.
+    m_runs_tmp.clear();
+    if (it_begin != it_end && int(it_begin->x) < x_begin)
+        push_run(m_runs_tmp, it_begin->x, uint32_t(x_begin) - it_begin->x, it_begin->value);
+    for (int x = x_begin; x < x_end;) {
+        int x2 = x + 1;
+        while (x2 < x_end && line[x2] == line[x])
+            ++ x2;
+        if (line[x] != 0)
+            push_run(m_runs_tmp, uint32_t(x), uint32_t(x2 - x), line[x]);
+        x = x2;
+    }
+    if (it_begin != it_end) {
+        const Run &last = *(it_end - 1);
+        if (int(last.x + last.len) > x_end)
+            push_run(m_runs_tmp, uint32_t(x_end), last.x + last.len - uint32_t(x_end), last.value);
+    }
+
+    size_t pos = it_begin - row.begin();
+    row.erase(it_begin, it_end);
+    row.insert(row.begin() + pos, m_runs_tmp.begin(), m_runs_tmp.end());
+}
+
+void RasterGrayscaleAARLE::read_row(size_t row, uint8_t *dst) const
+{
+    std::fill(dst, dst + m_resolution.width_px, uint8_t(0));
+    for (const Run &run : m_rows[row])
+        std::fill(dst + run.x, dst + run.x + run.len, run.value);
+}
+
+uint8_t RasterGrayscaleAARLE::read_pixel(size_t col, size_t row) const
+{
+    const Row &runs = m_rows[row];
+    auto it = std::upper_bound(runs.begin(), runs.end(), col,
+        [](size_t x, const Run &run) { return x < run.x; });
+    if (it == runs.begin())
+        return 0;
+    -- it;
+    return col < it->x + it->len ? it->value : 0;
+}
+
+EncodedRaster RasterGrayscaleAARLE::encode(RasterEncoder encoder) const
+{
+    const size_t w = m_resolution.width_px;
+    const size_t h = m_resolution.height_px;
+
+    // Encoders known to accept the image row by row do not need the full image.
+    std::vector<uint8_t> line(w);
+    RasterRows rows = [this, &line](size_t row) -> const uint8_t* {
+        read_row(row, line.data());
+        return line.data();
+    };
+    if (PNGRasterEncoder *png = encoder.target<PNGRasterEncoder>())
+        return (*png)(rows, w, h, 1);
+    if (PPMRasterEncoder *ppm = encoder.target<PPMRasterEncoder>())
+        return (*ppm)(rows, w, h, 1);
+
+    std::vector<uint8_t> buf(w * h);
+    for (size_t row = 0; row < h; ++ row)
+        read_row(row, buf.data() + row * w);
+
+    return encoder(buf.data(), w, h, 1);
+}
+
+void RasterGrayscaleAARLE::clear()
+{
+    for (Row &row : m_rows)
+        row.clear();
+}
+
+size_t RasterGrayscaleAARLE::memory_used() const
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(m_rows, Row) + SLIC3R_STDVEC_MEMSIZE(m_line, uint8_t) + SLIC3R_STDVEC_MEMSIZE(m_runs_tmp, Run);
+    for (const Row &row : m_rows)
+        out += SLIC3R_STDVEC_MEMSIZE(row, Run);
+    return out;
+}
+
+}} // namespace Slic3r::sla
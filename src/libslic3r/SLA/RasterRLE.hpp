@@ -0,0 +1,75 @@
+#ifndef SLA_RASTERRLE_HPP
+#define SLA_RASTERRLE_HPP
+
+#include <libslic3r/SLA/AGGRaster.hpp>
+
+namespace Slic3r { namespace sla {
+
+/*
+ * Anti-aliased monochrome canvas like RasterGrayscaleAA, storing each row as
+ * a sorted sequence of runs of a constant non-zero pixel value instead of a
+ * full width * height buffer. The AGG scanlines are blended directly into the
+ * runs, so the memory held between drawing and encoding grows with the number
+ * of runs, not with the resolution, which suits the mostly empty layers of SLA
+ * prints. Encoding expands the runs into full rows for the encoders, so its
+ * cost is proportional to the raster size, same as for RasterGrayscaleAA.
+ */
+class RasterGrayscaleAARLE : public AGGRasterizer<> {
+    using Base = AGGRasterizer<>;
+    
+public:
+    // Run of pixels of the same value in a single row.
+    struct Run {
+        uint32_t x     = 0;
+        uint32_t len   = 0;
+        uint8_t  value = 0;
+    };
+    using Row = std::vector<Run>;
+    
+    template<class GammaFn>
+    RasterGrayscaleAARLE(const RasterBase::Resolution &res,
+                         const RasterBase::PixelDim &  pd,
+                         const RasterBase::Trafo &     trafo,
+                         GammaFn &&                    fn)
+        : Base(res, pd, trafo, std::forward<GammaFn>(fn))
+        , m_rows(res.height_px)
+        , m_line(res.width_px, 0)
+    {}
+    
+    void draw(const ExPolygon &poly) override { ScanlineRenderer r{this}; this->_draw(poly, r); }
+    void draw(const ClipperLib::Polygon &poly) override { ScanlineRenderer r{this}; this->_draw(poly, r); }
+    
+    EncodedRaster encode(RasterEncoder encoder) const override;
+    
+    // Runs of a single row, sorted by x, not overlapping.
+    const Row& row(size_t row) const { return m_rows[row]; }
+    // Decode a single row into dst of resolution().width_px pixels.
+    void read_row(size_t row, uint8_t *dst) const;
+    uint8_t read_pixel(size_t col, size_t row) const;
+    
+    void clear();
+    
+    // Memory allocated by the runs.
+    size_t memory_used() const;
+    
+private:
+    // Interface of a scanline renderer for agg::render_scanlines().
+    struct ScanlineRenderer {
+        RasterGrayscaleAARLE *self;
+        void prepare() {}
+        void render(const agg::scanline_p8 &sl) { self->render_scanline(sl); }
+    };
+    
+    // Blend the spans of a single scanline into its row with the white color,
+    // producing the same pixel values as agg::pixfmt_gray8.
+    void render_scanline(const agg::scanline_p8 &sl);
+    
+    std::vector<Row>     m_rows;
+    // Pixels of the range of a row being blended, reused between scanlines.
+    std::vector<uint8_t> m_line;
+    Row                  m_runs_tmp;
+};
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_RASTERRLE_HPP
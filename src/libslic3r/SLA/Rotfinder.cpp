@@ -1,5 +1,10 @@
 #include <limits>
 #include <exception>
+#include <algorithm>
+#include <cstring>
+
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
 
 #include <libnest2d/optimizers/nlopt/genetic.hpp>
 #include <libslic3r/SLA/Rotfinder.hpp>
@@ -9,6 +14,79 @@
 namespace Slic3r {
 namespace sla {
 
+FacetNormals merge_facet_normals(const TriangleMesh &mesh)
+{
+    // Normals compared by their bit patterns, so that the ordering is strict even with NaNs.
+    using Key = std::array<uint32_t, 3>;
+    std::vector<Key> keys;
+    keys.reserve(mesh.stl.facet_start.size());
+    for (const stl_facet &facet : mesh.stl.facet_start) {
+        Key key;
+        std::memcpy(key.data(), facet.normal.data(), sizeof(key));
+        keys.emplace_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    FacetNormals out;
+    for (size_t i = 0; i < keys.size();) {
+        size_t j = i + 1;
+        while (j < keys.size() && keys[j] == keys[i])
+            ++ j;
+        float n[3];
+        std::memcpy(n, keys[i].data(), sizeof(n));
+        out.x.emplace_back(n[0]);
+        out.y.emplace_back(n[1]);
+        out.z.emplace_back(n[2]);
+        out.count.emplace_back(float(j - i));
+        i = j;
+    }
+    return out;
+}
+
+// Sum over the normals [begin, end) of the absolute values of the coordinates
+// of the rotated normal, weighted by the number of facets.
+static double rotation_score(const FacetNormals &normals, const Matrix3d &rot, size_t begin, size_t end)
+{
+    const double r00 = rot(0, 0), r01 = rot(0, 1), r02 = rot(0, 2);
+    const double r10 = rot(1, 0), r11 = rot(1, 1), r12 = rot(1, 2);
+    const double r20 = rot(2, 0), r21 = rot(2, 1), r22 = rot(2, 2);
+    const float *x = normals.x.data(), *y = normals.y.data(), *z = normals.z.data(), *w = normals.count.data();
+    
+    auto score = [=](size_t i) {
+        double nx = x[i], ny = y[i], nz = z[i];
+        return w[i] * (std::abs(r00 * nx + r01 * ny + r02 * nz) +
+                       std::abs(r10 * nx + r11 * ny + r12 * nz) +
+                       std::abs(r20 * nx + r21 * ny + r22 * nz));
+    };
+    
+    // Independent partial sums, so that the compiler may vectorize the loop
+    // without reordering the floating point additions itself.
+    static constexpr size_t LANES = 4;
+    double acc[LANES] = { 0., 0., 0., 0. };
+    size_t i = begin;
+    for (; i + LANES <= end; i += LANES)
+        for (size_t j = 0; j < LANES; ++ j)
+            acc[j] += score(i + j);
+    for (; i < end; ++ i)
+        acc[0] += score(i);
+    
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+double rotation_score(const FacetNormals &normals, const Matrix3d &rot)
+{
+    // Large enough for the overhead of the parallel reduction to pay off.
+    static constexpr size_t GRAIN_SIZE = 16384;
+    
+    // Deterministic, so that the same rotation always gets the same score.
+    return tbb::parallel_deterministic_reduce(
+        tbb::blocked_range<size_t>(0, normals.size(), GRAIN_SIZE), 0.,
+        [&normals, &rot](const tbb::blocked_range<size_t> &range, double init) {
+            return init + rotation_score(normals, rot, range.begin(), range.end());
+        },
+        [](double a, double b) { return a + b; });
+}
+
 std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
                                          float accuracy,
                                          std::function<void(unsigned)> statuscb,
@@ -25,9 +103,9 @@ std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
     // return value
     std::array<double, 3> rot;
 
-    // We will use only one instance of this converted mesh to examine different
-    // rotations
-    const TriangleMesh& mesh = modelobj.raw_mesh();
+    // The score of a rotation only depends on the facet normals, the mesh is
+    // not needed once they are collected.
+    const FacetNormals normals = merge_facet_normals(modelobj.raw_mesh());
 
     // For current iteration number
     unsigned status = 0;
@@ -43,11 +121,9 @@ std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
     // call the status callback in each iteration but the actual value may be
     // the same for subsequent iterations (status goes from 0 to 100 but
     // iterations can be many more)
-    auto objfunc = [&mesh, &status, &statuscb, &stopcond, max_tries]
+    auto objfunc = [&normals, &status, &statuscb, &stopcond, max_tries]
             (double rx, double ry, double rz)
     {
-        const TriangleMesh& m = mesh;
-
         // prepare the rotation transformation
         Transform3d rt = Transform3d::Identity();
 
@@ -55,29 +131,19 @@ std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
         rt.rotate(Eigen::AngleAxisd(ry, Vec3d::UnitY()));
         rt.rotate(Eigen::AngleAxisd(rx, Vec3d::UnitX()));
 
-        double score = 0;
-
         // For all triangles we calculate the normal and sum up the dot product
         // (a scalar indicating how much are two vectors aligned) with each axis
         // this will result in a value that is greater if a normal is aligned
         // with all axes. If the normal is aligned than the triangle itself is
         // orthogonal to the axes and that is good for print quality.
+        // The dot products of the rotated normal with the axes are the
+        // coordinates of the rotated normal.
 
         // TODO: some applications optimize for minimum z-axis cross section
         // area. The current function is only an example of how to optimize.
 
         // Later we can add more criteria like the number of overhangs, etc...
-        for(size_t i = 0; i < m.stl.facet_start.size(); i++) {
-            Vec3d n = m.stl.facet_start[i].normal.cast<double>();
-
-            // rotate the normal with the current rotation given by the solver
-            n = rt * n;
-
-            // We should score against the alignment with the reference planes
-            score += std::abs(n.dot(Vec3d::UnitX()));
-            score += std::abs(n.dot(Vec3d::UnitY()));
-            score += std::abs(n.dot(Vec3d::UnitZ()));
-        }
+        double score = rotation_score(normals, rt.linear());
 
         // report status
         if(!stopcond()) statuscb( unsigned(++status * 100.0/max_tries) );
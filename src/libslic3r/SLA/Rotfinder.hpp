@@ -3,13 +3,41 @@
 
 #include <functional>
 #include <array>
+#include <vector>
+
+#include <libslic3r/Point.hpp>
 
 namespace Slic3r {
 
 class ModelObject;
+class TriangleMesh;
 
 namespace sla {
 
+/**
+  * Facet normals of a mesh as a structure of arrays, identical normals merged
+  * with the number of their facets as a weight. The score of a rotation is
+  * evaluated many times by the optimizer, this layout keeps the evaluation
+  * linear in memory and vectorizable, while meshes with large planar areas
+  * collapse to a fraction of their facet count.
+  */
+struct FacetNormals {
+    std::vector<float> x, y, z;
+    std::vector<float> count;
+    
+    size_t size() const { return x.size(); }
+};
+
+FacetNormals merge_facet_normals(const TriangleMesh &mesh);
+
+/**
+  * The score of a rotation maximized by find_best_rotation(): The sum over all
+  * facets of the absolute values of the coordinates of the rotated facet
+  * normal, that is of its dot products with the axes. It is greater if the
+  * facets are aligned with the axes.
+  */
+double rotation_score(const FacetNormals &normals, const Matrix3d &rot);
+
 /**
   * The function should find the best rotation for SLA upside down printing.
   *
@@ -6,11 +6,13 @@
 #include "MTUtils.hpp"
 
 #include <unordered_set>
+#include <unordered_map>
 #include <numeric>
 
 #include <tbb/parallel_for.h>
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
 
 // #define SLAPRINT_DO_BENCHMARK
 
@@ -661,6 +663,59 @@ std::string SLAPrint::validate() const
     return "";
 }
 
+size_t SLAPrint::PrintLayer::hash_slices(const std::vector<ClipperLib::Polygon> &slices)
+{
+    size_t seed = slices.size();
+    auto hash_path = [&seed](const ClipperLib::Path &path) {
+        boost::hash_combine(seed, path.size());
+        for (const ClipperLib::IntPoint &pt : path) {
+            boost::hash_combine(seed, pt.X);
+            boost::hash_combine(seed, pt.Y);
+        }
+    };
+    for (const ClipperLib::Polygon &poly : slices) {
+        hash_path(poly.Contour);
+        boost::hash_combine(seed, poly.Holes.size());
+        for (const ClipperLib::Path &hole : poly.Holes)
+            hash_path(hole);
+    }
+    return seed;
+}
+
+bool SLAPrint::PrintLayer::same_transformed_slices(const PrintLayer &other) const
+{
+    if (m_transformed_slices_hash != other.m_transformed_slices_hash ||
+        m_transformed_slices.size() != other.m_transformed_slices.size())
+        return false;
+    for (size_t i = 0; i < m_transformed_slices.size(); ++ i) {
+        const ClipperLib::Polygon &a = m_transformed_slices[i];
+        const ClipperLib::Polygon &b = other.m_transformed_slices[i];
+        if (a.Contour != b.Contour || a.Holes != b.Holes)
+            return false;
+    }
+    return true;
+}
+
+std::vector<size_t> SLAPrint::identical_print_layers() const
+{
+    std::vector<size_t> out(m_printer_input.size());
+    // First layer of each distinct content, a hash may map to more of them in case of a collision.
+    std::unordered_multimap<size_t, size_t> first_layers;
+    for (size_t idx = 0; idx < m_printer_input.size(); ++ idx) {
+        const PrintLayer &layer = m_printer_input[idx];
+        out[idx] = idx;
+        auto range = first_layers.equal_range(layer.transformed_slices_hash());
+        for (auto it = range.first; it != range.second; ++ it)
+            if (m_printer_input[it->second].same_transformed_slices(layer)) {
+                out[idx] = it->second;
+                break;
+            }
+        if (out[idx] == idx)
+            first_layers.emplace(layer.transformed_slices_hash(), idx);
+    }
+    return out;
+}
+
 void SLAPrint::set_printer(SLAPrinter *arch)
 {
     invalidate_step(slapsRasterize);
@@ -382,16 +382,26 @@ public:
     virtual void apply(const SLAPrinterConfig &cfg) = 0;
     
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
-    template<class Fn> void draw_layers(size_t layer_num, Fn &&drawfn)
+    // If identical is not empty, only the layers with identical[lyrid] == lyrid
+    // are drawn, the other layers share the encoded raster of layer identical[lyrid].
+    template<class Fn> void draw_layers(size_t layer_num, Fn &&drawfn,
+                                        const std::vector<size_t> &identical = {})
     {
+        assert(identical.empty() || identical.size() == layer_num);
         m_layers.resize(layer_num);
         sla::ccr::for_each(size_t(0), m_layers.size(),
-                           [this, &drawfn] (size_t idx) {
+                           [this, &drawfn, &identical] (size_t idx) {
+                               if (! identical.empty() && identical[idx] != idx)
+                                   return;
                                sla::EncodedRaster& enc = m_layers[idx];
                                auto rst = create_raster();
                                drawfn(*rst, idx);
                                enc = rst->encode(get_encoder());
                            });
+        if (! identical.empty())
+            for (size_t idx = 0; idx < m_layers.size(); ++ idx)
+                if (identical[idx] != idx)
+                    m_layers[idx] = m_layers[identical[idx]];
     }
 };
 
@@ -465,12 +475,17 @@ public:
         std::vector<std::reference_wrapper<const SliceRecord>> m_slices;
 
         std::vector<ClipperLib::Polygon> m_transformed_slices;
+        // Hash of m_transformed_slices to find identical layers quickly.
+        size_t m_transformed_slices_hash = 0;
 
         template<class Container> void transformed_slices(Container&& c)
         {
             m_transformed_slices = std::forward<Container>(c);
+            m_transformed_slices_hash = hash_slices(m_transformed_slices);
         }
         
+        static size_t hash_slices(const std::vector<ClipperLib::Polygon> &slices);
+        
         friend class SLAPrint::Steps;
 
     public:
@@ -491,12 +506,21 @@ public:
         const std::vector<ClipperLib::Polygon> & transformed_slices() const {
             return m_transformed_slices;
         }
+        
+        size_t transformed_slices_hash() const { return m_transformed_slices_hash; }
+        
+        // Layers with the same transformed slices produce the same raster.
+        bool same_transformed_slices(const PrintLayer &other) const;
     };
 
     // The aggregated and leveled print records from various objects.
     // TODO: use this structure for the preview in the future.
     const std::vector<PrintLayer>& print_layers() const { return m_printer_input; }
     
+    // For each print layer the index of the first print layer with the same
+    // transformed slices, its own index if there is no such layer.
+    std::vector<size_t> identical_print_layers() const;
+    
     void set_printer(SLAPrinter *archiver);
     
 private:
@@ -826,7 +826,15 @@ void SLAPrint::Steps::rasterize()
     // pst: previous state
     double pst = current_status();
     
-    double increment = (slot * sd) / m_print->m_printer_input.size();
+    // Layers identical to a previous one share its raster and are not drawn.
+    std::vector<size_t> identical = m_print->identical_print_layers();
+    size_t num_unique = 0;
+    for (size_t idx = 0; idx < identical.size(); ++ idx)
+        if (identical[idx] == idx)
+            ++ num_unique;
+    BOOST_LOG_TRIVIAL(debug) << "Rasterizing " << num_unique << " distinct layers of " << identical.size();
+    
+    double increment = (slot * sd) / std::max(num_unique, size_t(1));
     double dstatus = current_status();
     
     sla::ccr::SpinningMutex slck;
@@ -859,7 +867,7 @@ void SLAPrint::Steps::rasterize()
     if(canceled()) return;
     
     // Print all the layers in parallel
-    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn);
+    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn, identical);
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
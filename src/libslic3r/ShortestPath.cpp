@@ -13,6 +13,8 @@
 #include <cmath>
 #include <cassert>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 // Naive implementation of the Traveling Salesman Problem, it works by always taking the next closest neighbor.
@@ -998,11 +1000,120 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy2(SegmentEndPointFunc
 	return chain_segments_greedy_constrained_reversals2_<PointType, SegmentEndPointFunc, false, decltype(could_reverse_func)>(end_point_func, could_reverse_func, num_segments, start_near);
 }
 
-std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near)
+// Split segments into spatially compact clusters of at most cluster_size segments by recursive median splits
+// of the segment centers along the longer side of their bounding box.
+// Returns segment indices sorted by clusters, cluster_begin receives the start of each cluster in the returned vector
+// followed by the total number of segments.
+template<typename SegmentEndPointFunc>
+std::vector<size_t> cluster_segments(SegmentEndPointFunc end_point_func, size_t num_segments, size_t cluster_size, std::vector<size_t> &cluster_begin)
+{
+	assert(cluster_size > 0);
+	std::vector<Vec2d> centers;
+	centers.reserve(num_segments);
+	for (size_t i = 0; i < num_segments; ++ i)
+		centers.emplace_back(0.5 * (end_point_func(i, true).template cast<double>() + end_point_func(i, false).template cast<double>()));
+
+	std::vector<size_t> segments(num_segments);
+	for (size_t i = 0; i < num_segments; ++ i)
+		segments[i] = i;
+
+	cluster_begin.clear();
+	// Depth first traversal, the left range is split first, thus the clusters are emitted in the order of their segments.
+	std::vector<std::pair<size_t, size_t>> ranges { { 0, num_segments } };
+	while (! ranges.empty()) {
+		std::pair<size_t, size_t> range = ranges.back();
+		ranges.pop_back();
+		if (range.second - range.first <= cluster_size) {
+			cluster_begin.emplace_back(range.first);
+			continue;
+		}
+		Vec2d bbox_min = centers[segments[range.first]];
+		Vec2d bbox_max = bbox_min;
+		for (size_t i = range.first + 1; i < range.second; ++ i) {
+			bbox_min = bbox_min.cwiseMin(centers[segments[i]]);
+			bbox_max = bbox_max.cwiseMax(centers[segments[i]]);
+		}
+		int    axis   = (bbox_max.x() - bbox_min.x() >= bbox_max.y() - bbox_min.y()) ? 0 : 1;
+		size_t middle = (range.first + range.second) / 2;
+		std::nth_element(segments.begin() + range.first, segments.begin() + middle, segments.begin() + range.second,
+			[&centers, axis](size_t l, size_t r) { return centers[l](axis) < centers[r](axis); });
+		ranges.emplace_back(middle, range.second);
+		ranges.emplace_back(range.first, middle);
+	}
+	cluster_begin.emplace_back(num_segments);
+	return segments;
+}
+
+// Chain a large set of segments by splitting it into spatial clusters (see cluster_segments()), chaining the clusters in parallel
+// by chain_cluster_func(const size_t *segments, size_t num_segments, std::pair<size_t, bool> *out) and stitching the chained clusters
+// by the greedy algorithm, treating each chained cluster as a single segment. A chained cluster is reversed only if all its segments could reverse.
+// The travels between the clusters are not as short as if the whole set was chained at once, the loss is lower for larger clusters.
+template<typename PointType, typename SegmentEndPointFunc, typename CouldReverseFunc, typename ChainClusterFunc>
+std::vector<std::pair<size_t, bool>> chain_segments_clustered(SegmentEndPointFunc end_point_func, CouldReverseFunc could_reverse_func, size_t num_segments, const PointType *start_near, size_t cluster_size, ChainClusterFunc chain_cluster_func)
+{
+	std::vector<size_t> cluster_begin;
+	std::vector<size_t> segments = cluster_segments(end_point_func, num_segments, cluster_size, cluster_begin);
+	size_t              num_clusters = cluster_begin.size() - 1;
+
+	// Chained clusters, stored in the order of their segments.
+	std::vector<std::pair<size_t, bool>> chained(num_segments);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, num_clusters, 1),
+		[&segments, &cluster_begin, &chained, &chain_cluster_func](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				chain_cluster_func(segments.data() + cluster_begin[i], cluster_begin[i + 1] - cluster_begin[i], chained.data() + cluster_begin[i]);
+		});
+
+	// Stitch the chained clusters.
+	std::vector<PointType> cluster_end_points;
+	std::vector<char>      cluster_could_reverse(num_clusters, true);
+	cluster_end_points.reserve(num_clusters * 2);
+	for (size_t i = 0; i < num_clusters; ++ i) {
+		const std::pair<size_t, bool> &first = chained[cluster_begin[i]];
+		const std::pair<size_t, bool> &last  = chained[cluster_begin[i + 1] - 1];
+		cluster_end_points.emplace_back(end_point_func(first.first, ! first.second));
+		cluster_end_points.emplace_back(end_point_func(last.first, last.second));
+		for (size_t j = cluster_begin[i]; j < cluster_begin[i + 1]; ++ j)
+			if (! could_reverse_func(chained[j].first)) {
+				cluster_could_reverse[i] = false;
+				break;
+			}
+	}
+	auto cluster_end_point = [&cluster_end_points](size_t idx, bool first_point) -> const PointType& { return cluster_end_points[idx * 2 + (first_point ? 0 : 1)]; };
+	auto could_reverse_cluster = [&cluster_could_reverse](size_t idx) -> bool { return cluster_could_reverse[idx] != 0; };
+	std::vector<std::pair<size_t, bool>> cluster_order = chain_segments_greedy_constrained_reversals_<PointType, decltype(cluster_end_point), true, decltype(could_reverse_cluster)>(
+		cluster_end_point, could_reverse_cluster, num_clusters, start_near);
+
+	std::vector<std::pair<size_t, bool>> out;
+	out.reserve(num_segments);
+	for (const std::pair<size_t, bool> &cluster : cluster_order) {
+		size_t begin = cluster_begin[cluster.first];
+		size_t end   = cluster_begin[cluster.first + 1];
+		if (cluster.second) {
+			for (size_t j = end; j > begin; -- j)
+				out.emplace_back(chained[j - 1].first, ! chained[j - 1].second);
+		} else
+			out.insert(out.end(), chained.begin() + begin, chained.begin() + end);
+	}
+	assert(out.size() == num_segments);
+	return out;
+}
+
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near, size_t cluster_size)
 {
 	auto segment_end_point = [&entities](size_t idx, bool first_point) -> const Point& { return first_point ? entities[idx]->first_point() : entities[idx]->last_point(); };
 	auto could_reverse = [&entities](size_t idx) { const ExtrusionEntity *ee = entities[idx]; return ee->is_loop() || ee->can_reverse(); };
-	std::vector<std::pair<size_t, bool>> out = chain_segments_greedy_constrained_reversals<Point, decltype(segment_end_point), decltype(could_reverse)>(segment_end_point, could_reverse, entities.size(), start_near);
+	std::vector<std::pair<size_t, bool>> out;
+	if (cluster_size > 0 && entities.size() > 2 * cluster_size) {
+		auto chain_cluster = [&segment_end_point, &could_reverse](const size_t *segments, size_t num_segments, std::pair<size_t, bool> *chained) {
+			auto cluster_end_point = [&segment_end_point, segments](size_t idx, bool first_point) -> const Point& { return segment_end_point(segments[idx], first_point); };
+			auto could_reverse_in_cluster = [&could_reverse, segments](size_t idx) { return could_reverse(segments[idx]); };
+			for (const std::pair<size_t, bool> &segment : chain_segments_greedy_constrained_reversals<Point, decltype(cluster_end_point), decltype(could_reverse_in_cluster)>(
+					cluster_end_point, could_reverse_in_cluster, num_segments, nullptr))
+				*chained ++ = std::make_pair(segments[segment.first], segment.second);
+		};
+		out = chain_segments_clustered(segment_end_point, could_reverse, entities.size(), start_near, cluster_size, chain_cluster);
+	} else
+		out = chain_segments_greedy_constrained_reversals<Point, decltype(segment_end_point), decltype(could_reverse)>(segment_end_point, could_reverse, entities.size(), start_near);
 	for (std::pair<size_t, bool> &segment : out) {
 		ExtrusionEntity *ee = entities[segment.first];
 		if (ee->is_loop())
@@ -1028,9 +1139,9 @@ void reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const s
     entities.swap(out);
 }
 
-void chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near)
+void chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near, size_t cluster_size)
 {
-	reorder_extrusion_entities(entities, chain_extrusion_entities(entities, start_near));
+	reorder_extrusion_entities(entities, chain_extrusion_entities(entities, start_near, cluster_size));
 }
 
 std::vector<std::pair<size_t, bool>> chain_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near)
@@ -1903,7 +2014,7 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
 #endif /* NDEBUG */
 }
 
-Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
+Polylines chain_polylines(Polylines &&polylines, const Point *start_near, size_t cluster_size)
 {
 #ifdef DEBUG_SVG_OUTPUT
 	static int iRun = 0;
@@ -1912,7 +2023,32 @@ Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
 #endif /* DEBUG_SVG_OUTPUT */
 
 	Polylines out;
-	if (! polylines.empty()) {
+	if (cluster_size > 0 && polylines.size() > 2 * cluster_size) {
+		// Both the greedy chaining and the two exchanges are superlinear, run them over spatial clusters in parallel.
+		// Each cluster is chained without a fixed start, therefore the two exchanges are applied even if start_near is set,
+		// start_near is respected when stitching the clusters.
+		auto segment_end_point = [&polylines](size_t idx, bool first_point) -> const Point& { return first_point ? polylines[idx].first_point() : polylines[idx].last_point(); };
+		auto could_reverse     = [](size_t /* idx */) -> bool { return true; };
+		auto chain_cluster = [&segment_end_point](const size_t *segments, size_t num_segments, std::pair<size_t, bool> *chained) {
+			auto cluster_end_point = [&segment_end_point, segments](size_t idx, bool first_point) -> const Point& { return segment_end_point(segments[idx], first_point); };
+			std::vector<std::pair<size_t, bool>> ordered = chain_segments_greedy2<Point, decltype(cluster_end_point)>(cluster_end_point, num_segments, nullptr);
+			std::vector<FlipEdge> edges;
+			edges.reserve(num_segments);
+			for (const std::pair<size_t, bool> &segment : ordered)
+				edges.emplace_back(cluster_end_point(segment.first, ! segment.second).cast<double>(), cluster_end_point(segment.first, segment.second).cast<double>(), segments[segment.first]);
+			reorder_by_two_exchanges_with_segment_flipping(edges);
+			for (const FlipEdge &edge : edges)
+				// Polyline is flipped if its first point is not the start of the edge, see improve_ordering_by_two_exchanges_with_segment_flipping().
+				*chained ++ = std::make_pair(edge.source_index, edge.p1 != segment_end_point(edge.source_index, true).cast<double>());
+		};
+		std::vector<std::pair<size_t, bool>> ordered = chain_segments_clustered(segment_end_point, could_reverse, polylines.size(), start_near, cluster_size, chain_cluster);
+		out.reserve(polylines.size());
+		for (auto &segment_and_reversal : ordered) {
+			out.emplace_back(std::move(polylines[segment_and_reversal.first]));
+			if (segment_and_reversal.second)
+				out.back().reverse();
+		}
+	} else if (! polylines.empty()) {
 		auto segment_end_point = [&polylines](size_t idx, bool first_point) -> const Point& { return first_point ? polylines[idx].first_point() : polylines[idx].last_point(); };
 		std::vector<std::pair<size_t, bool>> ordered = chain_segments_greedy2<Point, decltype(segment_end_point)>(segment_end_point, polylines.size(), start_near);
 		out.reserve(polylines.size()); 
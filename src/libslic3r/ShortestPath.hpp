@@ -12,18 +12,24 @@ namespace ClipperLib { class PolyNode; }
 
 namespace Slic3r {
 
+// Sets of more than 2 * cluster_size segments are split into spatially compact clusters of at most cluster_size segments,
+// which are chained in parallel and stitched together. Larger clusters produce shorter travels at the cost of a longer run time,
+// zero (the default) chains the whole set at once. Clustering changes the order of the extrusions, it is enabled by the caller
+// only, see the chain_cluster_size config option.
+static constexpr const size_t CHAIN_CLUSTER_SIZE_DEFAULT = 0;
+
 std::vector<size_t> 				 chain_points(const Points &points, Point *start_near = nullptr);
 
-std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr);
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, size_t cluster_size = CHAIN_CLUSTER_SIZE_DEFAULT);
 void                                 reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const std::vector<std::pair<size_t, bool>> &chain);
-void                                 chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr);
+void                                 chain_and_reorder_extrusion_entities(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, size_t cluster_size = CHAIN_CLUSTER_SIZE_DEFAULT);
 
 std::vector<std::pair<size_t, bool>> chain_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near = nullptr);
 void                                 reorder_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, std::vector<std::pair<size_t, bool>> &chain);
 void                                 chain_and_reorder_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near = nullptr);
 
-Polylines 							 chain_polylines(Polylines &&src, const Point *start_near = nullptr);
-inline Polylines 					 chain_polylines(const Polylines& src, const Point* start_near = nullptr) { Polylines tmp(src); return chain_polylines(std::move(tmp), start_near); }
+Polylines 							 chain_polylines(Polylines &&src, const Point *start_near = nullptr, size_t cluster_size = CHAIN_CLUSTER_SIZE_DEFAULT);
+inline Polylines 					 chain_polylines(const Polylines& src, const Point* start_near = nullptr, size_t cluster_size = CHAIN_CLUSTER_SIZE_DEFAULT) { Polylines tmp(src); return chain_polylines(std::move(tmp), start_near, cluster_size); }
 
 std::vector<ClipperLib::PolyNode*>	 chain_clipper_polynodes(const Points &points, const std::vector<ClipperLib::PolyNode*> &items);
 
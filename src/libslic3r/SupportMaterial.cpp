@@ -7,6 +7,7 @@
 #include "EdgeGrid.hpp"
 #include "Geometry.hpp"
 
+#include <chrono>
 #include <cmath>
 #include <memory>
 #include <boost/log/trivial.hpp>
@@ -227,6 +228,14 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // The layers will be referenced by various LayersPtr (of type std::vector<Layer*>)
     MyLayerStorage layer_storage;
 
+    // Timing breakdown of the support generation steps, logged at the debug level.
+    auto t_step = std::chrono::steady_clock::now();
+    auto log_step_time = [&t_step](const char *step) {
+        auto t_now = std::chrono::steady_clock::now();
+        BOOST_LOG_TRIVIAL(debug) << "Support generator - " << step << " took " << std::chrono::duration<double>(t_now - t_step).count() << "s";
+        t_step = t_now;
+    };
+
     BOOST_LOG_TRIVIAL(info) << "Support generator - Creating top contacts";
 
     // Determine the top contact surfaces of the support, defined as:
@@ -236,6 +245,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // that it will be effective, regardless of how it's built below.
     // If raft is to be generated, the 1st top_contact layer will contain the 1st object layer silhouette without holes.
     MyLayersPtr top_contacts = this->top_contact_layers(object, layer_storage);
+    log_step_time("top contacts");
     if (top_contacts.empty())
         // Nothing is supported, no supports are generated.
         return;
@@ -259,6 +269,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     MyLayersPtr bottom_contacts = this->bottom_contact_layers_and_layer_support_areas(
         object, top_contacts, layer_storage,
         layer_support_areas);
+    log_step_time("bottom contacts and support areas");
 
 #ifdef SLIC3R_DEBUG
     for (size_t layer_id = 0; layer_id < object.layers().size(); ++ layer_id)
@@ -281,6 +292,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     this->trim_support_layers_by_object(object, top_contacts, 
         m_slicing_params.soluble_interface ? 0. : m_object_config->support_material_contact_distance.value, 
         m_slicing_params.soluble_interface ? 0. : m_object_config->support_material_contact_distance.value, m_gap_xy);
+    log_step_time("intermediate layers");
 
 #ifdef SLIC3R_DEBUG
     for (const MyLayer *layer : top_contacts)
@@ -293,6 +305,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
 
     // Fill in intermediate layers between the top / bottom support contact layers, trimm them by the object.
     this->generate_base_layers(object, bottom_contacts, top_contacts, intermediate_layers, layer_support_areas);
+    log_step_time("base layers");
 
 #ifdef SLIC3R_DEBUG
     for (MyLayersPtr::const_iterator it = intermediate_layers.begin(); it != intermediate_layers.end(); ++ it)
@@ -308,6 +321,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // Rather trim the top contacts by their overlapping bottom contacts to leave a gap instead of over extruding
     // top contacts over the bottom contacts.
     this->trim_top_contacts_by_bottom_contacts(object, bottom_contacts, top_contacts);
+    log_step_time("trimming top contacts by bottom contacts");
 
 
     BOOST_LOG_TRIVIAL(info) << "Support generator - Creating interfaces";
@@ -315,6 +329,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // Propagate top / bottom contact layers to generate interface layers.
     MyLayersPtr interface_layers = this->generate_interface_layers(
         bottom_contacts, top_contacts, intermediate_layers, layer_storage);
+    log_step_time("interfaces");
 
     BOOST_LOG_TRIVIAL(info) << "Support generator - Creating raft";
 
@@ -322,6 +337,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // There is also a 1st intermediate layer containing bases of support columns.
     // Inflate the bases of the support columns and create the raft base under the object.
     MyLayersPtr raft_layers = this->generate_raft_base(top_contacts, interface_layers, intermediate_layers, layer_storage);
+    log_step_time("raft");
 
 #ifdef SLIC3R_DEBUG
     for (MyLayersPtr::const_iterator it = interface_layers.begin(); it != interface_layers.end(); ++ it)
@@ -384,11 +400,13 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
         }
         i = j;
     }
+    log_step_time("layers");
 
     BOOST_LOG_TRIVIAL(info) << "Support generator - Generating tool paths";
 
     // Generate the actual toolpaths and save them into each layer.
     this->generate_toolpaths(object, raft_layers, bottom_contacts, top_contacts, intermediate_layers, interface_layers);
+    log_step_time("tool paths");
 
 #ifdef SLIC3R_DEBUG
     {
@@ -1439,217 +1457,323 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
 
     if (! top_contacts.empty()) 
     {
-        // There is some support to be built, if there are non-empty top surfaces detected.
+        // The propagation of the support areas downwards is inherently serial: The projection of the contact areas passed to the layer below
+        // is trimmed by the object, cleaned of slivers and snapped to the support grid at each layer. Therefore only the propagation itself
+        // is evaluated layer by layer, while the rest of the work is moved out of the serial loop and calculated in parallel:
+        // 1) the projections of the top contact areas, the polygons trimming the projection and the top surfaces of the object,
+        // 2) the bottom contact layers, which only depend on the raw projection reaching the top surface they are placed on,
+        // 3) trimming of the support areas above by the bottom contact layers, applied in the same order as by the serial algorithm.
+        // The resulting support areas are identical to the serial evaluation.
+        const bool buildplate_only = m_object_config->support_material_buildplate_only;
+        // The topmost object layer is not visited, as there is no place for a bottom contact layer above it.
+        const int  num_layers      = int(object.total_layer_count()) - 1;
+        auto       t_start         = std::chrono::steady_clock::now();
+
+        // Index of the lowest top contact layer collected by the propagation.
+        int contact_idx_min = int(top_contacts.size());
+        if (num_layers > 0)
+            while (contact_idx_min > 0 && top_contacts[contact_idx_min - 1]->print_z > object.get_layer(0)->print_z - EPSILON)
+                -- contact_idx_min;
+        // Projections of the top contact layers, to be merged with the projection from above when the propagation reaches them.
+        std::vector<Polygons> contact_projections(top_contacts.size());
+        tbb::parallel_for(tbb::blocked_range<int>(contact_idx_min, int(top_contacts.size())),
+            [&top_contacts, &contact_projections](const tbb::blocked_range<int>& range) {
+                for (int contact_idx = range.begin(); contact_idx < range.end(); ++ contact_idx) {
+                    Polygons polygons_new;
+                    // Contact surfaces are expanded away from the object, trimmed by the object.
+                    // Use a slight positive offset to overlap the touching regions.
+#if 0
+                    // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
+                    polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
+#else
+                    // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
+                    // than the grid cells.
+                    polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
+#endif
+                    // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
+                    // Use a slight positive offset to overlap the touching regions.
+                    polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, float(SCALED_EPSILON)));
+                    contact_projections[contact_idx] = union_(polygons_new);
+                }
+            });
+        std::chrono::steady_clock::duration t_inputs      = std::chrono::steady_clock::now() - t_start;
+        std::chrono::steady_clock::duration t_propagation = std::chrono::steady_clock::duration::zero();
+
+        // Contact surfaces supported exclusively by the top surfaces of an object layer, one per object layer.
+        std::vector<Polygons> layer_touching(std::max(num_layers, 0));
+        // Last top contact layer visited when collecting the projection for an object layer.
+        std::vector<int>      layer_contact_idx(std::max(num_layers, 0), -1);
+
+        // The topmost layer reached by the projection of the highest top contact layer. The layers above receive no projection.
+        int layer_id_top = num_layers - 1;
+        while (layer_id_top >= 0 && top_contacts.back()->print_z <= object.get_layer(layer_id_top)->print_z - EPSILON)
+            -- layer_id_top;
+        // The trimming polygons and the top surfaces are calculated in parallel for a window of layers ahead of the propagation
+        // to bound the memory consumption.
+        static constexpr int  layer_window_size = 64;
+        std::vector<Polygons> window_trimming(layer_window_size);
+        std::vector<Polygons> window_top(layer_window_size);
         // Sum of unsupported contact areas above the current layer.print_z.
         Polygons  projection;
         // Last top contact layer visited when collecting the projection of contact areas.
         int       contact_idx = int(top_contacts.size()) - 1;
-        for (int layer_id = int(object.total_layer_count()) - 2; layer_id >= 0; -- layer_id) {
-            BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
-            const Layer &layer = *object.get_layer(layer_id);
-            // Collect projections of all contact areas above or at the same level as this top surface.
-            for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) {
-                Polygons polygons_new;
-                // Contact surfaces are expanded away from the object, trimmed by the object.
-                // Use a slight positive offset to overlap the touching regions.
-#if 0
-                // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
-#else
-                // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
-                // than the grid cells.
-                polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
-#endif
-                // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
-                // Use a slight positive offset to overlap the touching regions.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, float(SCALED_EPSILON)));
-                polygons_append(projection, union_(polygons_new));
-            }
-            if (projection.empty())
-                continue;
-            Polygons projection_raw = union_(projection);
-
-            tbb::task_group task_group;
-            if (! m_object_config->support_material_buildplate_only)
-                // Find the bottom contact layers above the top surfaces of this layer.
-                task_group.run([this, &object, &top_contacts, contact_idx, &layer, layer_id, &layer_storage, &layer_support_areas, &bottom_contacts, &projection_raw] {
-                    Polygons top = collect_region_slices_by_type(layer, stTop);
-        #ifdef SLIC3R_DEBUG
-                    {
-                        BoundingBox bbox = get_extents(projection_raw);
-                        bbox.merge(get_extents(top));
-                        ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                        svg.draw(union_ex(top, false), "blue", 0.5f);
-                        svg.draw(union_ex(projection_raw, true), "red", 0.5f);
-                        svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
-                        svg.draw(layer.lslices, "green", 0.5f);
+        for (int window_end = layer_id_top; window_end >= 0; window_end -= layer_window_size) {
+            const int window_begin = std::max(0, window_end - layer_window_size + 1);
+            auto t_window_start = std::chrono::steady_clock::now();
+            tbb::parallel_for(tbb::blocked_range<int>(window_begin, window_end + 1),
+                [&object, buildplate_only, window_begin, &window_trimming, &window_top](const tbb::blocked_range<int>& range) {
+                    for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                        const Layer &layer = *object.get_layer(layer_id);
+                        // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
+                        // Polygons trimming = union_(to_polygons(layer.slices), touching, true);
+                        window_trimming[layer_id - window_begin] = offset(layer.lslices, float(SCALED_EPSILON));
+                        window_top[layer_id - window_begin] = buildplate_only ? Polygons() : collect_region_slices_by_type(layer, stTop);
                     }
-        #endif /* SLIC3R_DEBUG */
-
-                    // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
-                    // top surfaces above layer.print_z falls onto this top surface. 
-                    // Touching are the contact surfaces supported exclusively by this top surfaces.
-                    // Don't use a safety offset as it has been applied during insertion of polygons.
-                    if (! top.empty()) {
-                        Polygons touching = intersection(top, projection_raw, false);
-                        if (! touching.empty()) {
-                            // Allocate a new bottom contact layer.
-                            MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
-                            bottom_contacts.push_back(&layer_new);
-                            // Grow top surfaces so that interface and support generation are generated
-                            // with some spacing from object - it looks we don't need the actual
-                            // top shapes so this can be done here
-                            //FIXME calculate layer height based on the actual thickness of the layer:
-                            // If the layer is extruded with no bridging flow, support just the normal extrusions.
-                            layer_new.height  = m_slicing_params.soluble_interface ? 
-                                // Align the interface layer with the object's layer height.
-                                object.layers()[layer_id + 1]->height :
-                                // Place a bridge flow interface layer over the top surface.
-                                //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
-                                // According to Jindrich the bottom surfaces work well.
-                                //FIXME test the bridging flow instead?
-                                m_support_material_interface_flow.nozzle_diameter;
-                            layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
-                                layer.print_z + layer_new.height + m_object_config->support_material_contact_distance.value;
-                            layer_new.bottom_z = layer.print_z;
-                            layer_new.idx_object_layer_below = layer_id;
-                            layer_new.bridging = ! m_slicing_params.soluble_interface;
-                            //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
-                            //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
-                            layer_new.polygons = offset(touching, float(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
-                            if (! m_slicing_params.soluble_interface) {
-                                // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
-                                // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
-                                for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
-                                    top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
-                                    ++ top_idx) {
-                                    if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
-                                        // A top layer has been found, which is close to the new bottom layer.
-                                        coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
-                                        assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
-                                        if (diff > 0.) {
-                                            // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
-                                            assert(diff < layer_new.height + EPSILON);
-                                            assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        } else {
-                                            // The top contact layer is above this layer. One may either make this layer thicker or thinner.
-                                            // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
-                                            // By making the layer thinner, one adds one more discrete layer.
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        }
-                                        break;
-                                    }
-                                }
-                            }
-                #ifdef SLIC3R_DEBUG
-                            Slic3r::SVG::export_expolygons(
-                                debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
-                                union_ex(layer_new.polygons, false));
-                #endif /* SLIC3R_DEBUG */
-                            // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
-                            //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
-                            touching = offset(touching, float(SCALED_EPSILON));
-                            for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
-                                const Layer &layer_above = *object.layers()[layer_id_above];
-                                if (layer_above.print_z > layer_new.print_z - EPSILON)
-                                    break; 
-                                if (! layer_support_areas[layer_id_above].empty()) {
-#ifdef SLIC3R_DEBUG
-                                    {
-                                        BoundingBox bbox = get_extents(touching);
-                                        bbox.merge(get_extents(layer_support_areas[layer_id_above]));
-                                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
-                                        svg.draw(union_ex(touching, false), "blue", 0.5f);
-                                        svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
-                                        svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
-                                    }
-#endif /* SLIC3R_DEBUG */
-                                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
-#ifdef SLIC3R_DEBUG
-                                    Slic3r::SVG::export_expolygons(
-                                        debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
-                                        union_ex(layer_support_areas[layer_id_above], false));
-#endif /* SLIC3R_DEBUG */
-                                }
-                            }
-                        }
-                    } // ! top.empty()
                 });
-
-            Polygons &layer_support_area = layer_support_areas[layer_id];
-            task_group.run([this, &projection, &projection_raw, &layer, &layer_support_area, layer_id] {
-                // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
-    //            Polygons trimming = union_(to_polygons(layer.slices), touching, true);
-                Polygons trimming = offset(layer.lslices, float(SCALED_EPSILON));
-                projection = diff(projection_raw, trimming, false);
-    #ifdef SLIC3R_DEBUG
-                {
-                    BoundingBox bbox = get_extents(projection_raw);
-                    bbox.merge(get_extents(trimming));
-                    ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                    svg.draw(union_ex(trimming, false), "blue", 0.5f);
-                    svg.draw(union_ex(projection, true), "red", 0.5f);
-                    svg.draw_outline(union_ex(projection, true), "red", "blue", scale_(0.1f));
-                }
-    #endif /* SLIC3R_DEBUG */
-                remove_sticks(projection);
-                remove_degenerate(projection);
+            auto t_window_inputs = std::chrono::steady_clock::now();
+            t_inputs += t_window_inputs - t_window_start;
+
+            for (int layer_id = window_end; layer_id >= window_begin; -- layer_id) {
+                BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
+                const Layer &layer = *object.get_layer(layer_id);
+                // Collect projections of all contact areas above or at the same level as this top surface.
+                for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx)
+                    polygons_append(projection, std::move(contact_projections[contact_idx]));
+                if (projection.empty())
+                    continue;
+                Polygons        projection_raw = union_(projection);
+                const Polygons &trimming       = window_trimming[layer_id - window_begin];
+                const Polygons &top            = window_top[layer_id - window_begin];
+                layer_contact_idx[layer_id] = contact_idx;
+
+                tbb::task_group task_group;
+                if (! top.empty())
+                    // Find the bottom contact areas above the top surfaces of this layer.
+                    task_group.run([&layer_touching, &top, &projection_raw, layer_id
+        #ifdef SLIC3R_DEBUG 
+                        , &layer
+        #endif /* SLIC3R_DEBUG */
+                        ] {
         #ifdef SLIC3R_DEBUG
-                Slic3r::SVG::export_expolygons(
-                    debug_out_path("support-support-areas-raw-cleaned-%d-%lf.svg", iRun, layer.print_z),
-                    union_ex(projection, false));
+                        {
+                            BoundingBox bbox = get_extents(projection_raw);
+                            bbox.merge(get_extents(top));
+                            ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
+                            svg.draw(union_ex(top, false), "blue", 0.5f);
+                            svg.draw(union_ex(projection_raw, true), "red", 0.5f);
+                            svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
+                            svg.draw(layer.lslices, "green", 0.5f);
+                        }
         #endif /* SLIC3R_DEBUG */
-                SupportGridPattern support_grid_pattern(
-                    // Support islands, to be stretched into a grid.
-                    projection, 
-                    // Trimming polygons, to trim the stretched support islands.
-                    trimming,
-                    // Grid spacing.
-                    m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
-                    Geometry::deg2rad(m_object_config->support_material_angle.value));
-                tbb::task_group task_group_inner;
-                // 1) Cache the slice of a support volume. The support volume is expanded by 1/2 of support material flow spacing
-                // to allow a placement of suppot zig-zag snake along the grid lines.
-                task_group_inner.run([this, &support_grid_pattern, &layer_support_area
+                        // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
+                        // top surfaces above layer.print_z falls onto this top surface. 
+                        // Touching are the contact surfaces supported exclusively by this top surfaces.
+                        // Don't use a safety offset as it has been applied during insertion of polygons.
+                        layer_touching[layer_id] = intersection(top, projection_raw, false);
+                    });
+
+                Polygons &layer_support_area = layer_support_areas[layer_id];
+                task_group.run([this, &projection, &projection_raw, &trimming, &layer_support_area
         #ifdef SLIC3R_DEBUG 
                     , &layer
         #endif /* SLIC3R_DEBUG */
                     ] {
-                    layer_support_area = support_grid_pattern.extract_support(m_support_material_flow.scaled_spacing()/2 + 25, true);
+                    projection = diff(projection_raw, trimming, false);
+        #ifdef SLIC3R_DEBUG
+                    {
+                        BoundingBox bbox = get_extents(projection_raw);
+                        bbox.merge(get_extents(trimming));
+                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
+                        svg.draw(union_ex(trimming, false), "blue", 0.5f);
+                        svg.draw(union_ex(projection, true), "red", 0.5f);
+                        svg.draw_outline(union_ex(projection, true), "red", "blue", scale_(0.1f));
+                    }
+        #endif /* SLIC3R_DEBUG */
+                    remove_sticks(projection);
+                    remove_degenerate(projection);
         #ifdef SLIC3R_DEBUG
                     Slic3r::SVG::export_expolygons(
-                        debug_out_path("support-layer_support_area-gridded-%d-%lf.svg", iRun, layer.print_z),
-                        union_ex(layer_support_area, false));
+                        debug_out_path("support-support-areas-raw-cleaned-%d-%lf.svg", iRun, layer.print_z),
+                        union_ex(projection, false));
         #endif /* SLIC3R_DEBUG */
-                });
-                // 2) Support polygons will be projected down. To keep the interface and base layers from growing, return a contour a tiny bit smaller than the grid cells.
-                Polygons projection_new;
-                task_group_inner.run([&projection_new, &support_grid_pattern
+                    SupportGridPattern support_grid_pattern(
+                        // Support islands, to be stretched into a grid.
+                        projection, 
+                        // Trimming polygons, to trim the stretched support islands.
+                        trimming,
+                        // Grid spacing.
+                        m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
+                        Geometry::deg2rad(m_object_config->support_material_angle.value));
+                    tbb::task_group task_group_inner;
+                    // 1) Cache the slice of a support volume. The support volume is expanded by 1/2 of support material flow spacing
+                    // to allow a placement of suppot zig-zag snake along the grid lines.
+                    task_group_inner.run([this, &support_grid_pattern, &layer_support_area
         #ifdef SLIC3R_DEBUG 
-                    , &layer
+                        , &layer
         #endif /* SLIC3R_DEBUG */
-                    ] {
-                    projection_new = support_grid_pattern.extract_support(-5, true);
+                        ] {
+                        layer_support_area = support_grid_pattern.extract_support(m_support_material_flow.scaled_spacing()/2 + 25, true);
         #ifdef SLIC3R_DEBUG
-                    Slic3r::SVG::export_expolygons(
-                        debug_out_path("support-projection_new-gridded-%d-%lf.svg", iRun, layer.print_z),
-                        union_ex(projection_new, false));
+                        Slic3r::SVG::export_expolygons(
+                            debug_out_path("support-layer_support_area-gridded-%d-%lf.svg", iRun, layer.print_z),
+                            union_ex(layer_support_area, false));
+        #endif /* SLIC3R_DEBUG */
+                    });
+                    // 2) Support polygons will be projected down. To keep the interface and base layers from growing, return a contour a tiny bit smaller than the grid cells.
+                    Polygons projection_new;
+                    task_group_inner.run([&projection_new, &support_grid_pattern
+        #ifdef SLIC3R_DEBUG 
+                        , &layer
+        #endif /* SLIC3R_DEBUG */
+                        ] {
+                        projection_new = support_grid_pattern.extract_support(-5, true);
+        #ifdef SLIC3R_DEBUG
+                        Slic3r::SVG::export_expolygons(
+                            debug_out_path("support-projection_new-gridded-%d-%lf.svg", iRun, layer.print_z),
+                            union_ex(projection_new, false));
         #endif /* SLIC3R_DEBUG */
+                    });
+                    task_group_inner.wait();
+                    projection = std::move(projection_new);
                 });
-                task_group_inner.wait();
-                projection = std::move(projection_new);
-            });
-            task_group.wait();
+                task_group.wait();
+            }
+            t_propagation += std::chrono::steady_clock::now() - t_window_inputs;
         }
-        std::reverse(bottom_contacts.begin(), bottom_contacts.end());
+        window_trimming.clear();
+        window_top.clear();
+
+        // Allocate the bottom contact layers over the top surfaces touched by the projection, one per object layer.
+        auto t_bottom_contacts_start = std::chrono::steady_clock::now();
+        std::vector<MyLayer*> layer_bottom_contacts(layer_touching.size(), nullptr);
+        tbb::spin_mutex layer_storage_mutex;
+        tbb::parallel_for(tbb::blocked_range<int>(0, int(layer_touching.size())),
+            [this, &object, &top_contacts, &layer_storage, &layer_storage_mutex, &layer_touching, &layer_contact_idx, &layer_bottom_contacts](const tbb::blocked_range<int>& range) {
+                for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    Polygons &touching = layer_touching[layer_id];
+                    if (touching.empty())
+                        continue;
+                    const Layer &layer       = *object.get_layer(layer_id);
+                    const int    contact_idx = layer_contact_idx[layer_id];
+                    // Allocate a new bottom contact layer.
+                    MyLayer &layer_new = layer_allocate(layer_storage, layer_storage_mutex, sltBottomContact);
+                    layer_bottom_contacts[layer_id] = &layer_new;
+                    // Grow top surfaces so that interface and support generation are generated
+                    // with some spacing from object - it looks we don't need the actual
+                    // top shapes so this can be done here
+                    //FIXME calculate layer height based on the actual thickness of the layer:
+                    // If the layer is extruded with no bridging flow, support just the normal extrusions.
+                    layer_new.height  = m_slicing_params.soluble_interface ? 
+                        // Align the interface layer with the object's layer height.
+                        object.layers()[layer_id + 1]->height :
+                        // Place a bridge flow interface layer over the top surface.
+                        //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
+                        // According to Jindrich the bottom surfaces work well.
+                        //FIXME test the bridging flow instead?
+                        m_support_material_interface_flow.nozzle_diameter;
+                    layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
+                        layer.print_z + layer_new.height + m_object_config->support_material_contact_distance.value;
+                    layer_new.bottom_z = layer.print_z;
+                    layer_new.idx_object_layer_below = layer_id;
+                    layer_new.bridging = ! m_slicing_params.soluble_interface;
+                    //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
+                    //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
+                    layer_new.polygons = offset(touching, float(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
+                    if (! m_slicing_params.soluble_interface) {
+                        // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
+                        // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
+                        for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
+                            top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
+                            ++ top_idx) {
+                            if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
+                                // A top layer has been found, which is close to the new bottom layer.
+                                coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
+                                assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
+                                if (diff > 0.) {
+                                    // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
+                                    assert(diff < layer_new.height + EPSILON);
+                                    assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
+                                    layer_new.print_z  = top_contacts[top_idx]->print_z;
+                                    layer_new.height  -= diff;
+                                } else {
+                                    // The top contact layer is above this layer. One may either make this layer thicker or thinner.
+                                    // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
+                                    // By making the layer thinner, one adds one more discrete layer.
+                                    layer_new.print_z  = top_contacts[top_idx]->print_z;
+                                    layer_new.height  -= diff;
+                                }
+                                break;
+                            }
+                        }
+                    }
+        #ifdef SLIC3R_DEBUG
+                    Slic3r::SVG::export_expolygons(
+                        debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
+                        union_ex(layer_new.polygons, false));
+        #endif /* SLIC3R_DEBUG */
+                    // The touching areas will trim the already created base layers above the current layer.
+                    touching = offset(touching, float(SCALED_EPSILON));
+                }
+            });
+        // Collect the bottom contact layers sorted by a raising object layer.
+        for (MyLayer *layer_new : layer_bottom_contacts)
+            if (layer_new != nullptr)
+                bottom_contacts.push_back(layer_new);
+
+        // Trim the already created base layers above the bottom contact layers intersecting with the new bottom contacts layer.
+        //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
+        // The support areas of an object layer are trimmed by the bottom contact layers below in a decreasing order of the object layer below,
+        // which is the order the serial propagation used to apply the trimming in.
+        auto t_trimming_start = std::chrono::steady_clock::now();
+        std::vector<std::vector<int>> layer_trimmed_by(object.total_layer_count());
+        for (int layer_id = int(layer_bottom_contacts.size()) - 1; layer_id >= 0; -- layer_id)
+            if (const MyLayer *layer_new = layer_bottom_contacts[layer_id]; layer_new != nullptr)
+                for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()) && 
+                     object.get_layer(layer_id_above)->print_z <= layer_new->print_z - EPSILON; ++ layer_id_above)
+                    layer_trimmed_by[layer_id_above].emplace_back(layer_id);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_trimmed_by.size()),
+            [&layer_touching, &layer_support_areas, &layer_trimmed_by
+#ifdef SLIC3R_DEBUG 
+                , &object
+#endif /* SLIC3R_DEBUG */
+                ](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_id_above = range.begin(); layer_id_above < range.end(); ++ layer_id_above)
+                    for (int layer_id : layer_trimmed_by[layer_id_above])
+                        if (! layer_support_areas[layer_id_above].empty()) {
+                            const Polygons &touching = layer_touching[layer_id];
+#ifdef SLIC3R_DEBUG
+                            const Layer &layer       = *object.get_layer(layer_id);
+                            const Layer &layer_above = *object.get_layer(layer_id_above);
+                            {
+                                BoundingBox bbox = get_extents(touching);
+                                bbox.merge(get_extents(layer_support_areas[layer_id_above]));
+                                ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
+                                svg.draw(union_ex(touching, false), "blue", 0.5f);
+                                svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
+                                svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
+                            }
+#endif /* SLIC3R_DEBUG */
+                            layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
+#ifdef SLIC3R_DEBUG
+                            Slic3r::SVG::export_expolygons(
+                                debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
+                                union_ex(layer_support_areas[layer_id_above], false));
+#endif /* SLIC3R_DEBUG */
+                        }
+            });
+        auto t_trimming_end = std::chrono::steady_clock::now();
+
 //        trim_support_layers_by_object(object, bottom_contacts, 0., 0., m_gap_xy);
         trim_support_layers_by_object(object, bottom_contacts, 
             m_slicing_params.soluble_interface ? 0. : m_object_config->support_material_contact_distance.value, 
             m_slicing_params.soluble_interface ? 0. : m_object_config->support_material_contact_distance.value, m_gap_xy);
 
+        auto seconds = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double>(d).count(); };
+        BOOST_LOG_TRIVIAL(debug) << "Support generator - bottom_contact_layers - inputs " << seconds(t_inputs) << 
+            "s, propagation " << seconds(t_propagation) << 
+            "s, bottom contacts " << seconds(t_trimming_start - t_bottom_contacts_start) << 
+            "s, trimming of support areas " << seconds(t_trimming_end - t_trimming_start) << 
+            "s, trimming of bottom contacts by object " << seconds(std::chrono::steady_clock::now() - t_trimming_end) << "s";
     } // ! top_contacts.empty()
 
     return bottom_contacts;
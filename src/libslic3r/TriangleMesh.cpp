@@ -684,6 +684,7 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
     mesh = _mesh;
     if (! mesh->has_shared_vertices())
         throw std::invalid_argument("TriangleMeshSlicer was passed a mesh without shared vertices.");
+    m_facet_z_index.clear();
 
     throw_on_cancel();
     facets_edges.assign(_mesh->stl.stats.number_of_facets * 3, -1);
@@ -772,9 +773,86 @@ void TriangleMeshSlicer::set_up_direction(const Vec3f& up)
 {
     m_quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
     m_use_quaternion = true;
+    if (! m_facet_z_index.empty())
+        // The Z extents of the facets changed.
+        this->build_facet_z_index();
 }
 
+void TriangleMeshSlicer::build_facet_z_index()
+{
+    std::vector<Vec2f> facet_z(this->mesh->stl.stats.number_of_facets);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, facet_z.size()),
+        [&facet_z, this](const tbb::blocked_range<size_t>& range) {
+            for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                // The same extents as calculated by _slice_do().
+                const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
+                facet_z[facet_idx] = Vec2f(
+                    fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2))),
+                    fmaxf(facet.vertex[0](2), fmaxf(facet.vertex[1](2), facet.vertex[2](2))));
+            }
+        }
+    );
+    m_facet_z_index.build(std::move(facet_z));
+}
+
+void FacetZIndex::build(std::vector<Vec2f> &&facet_z)
+{
+    m_facet_z = std::move(facet_z);
+    m_by_min_z.resize(m_facet_z.size());
+    for (uint32_t i = 0; i < uint32_t(m_by_min_z.size()); ++ i)
+        m_by_min_z[i] = i;
+    m_by_max_z = m_by_min_z;
+    std::sort(m_by_min_z.begin(), m_by_min_z.end(), [this](uint32_t l, uint32_t r) { return m_facet_z[l].x() < m_facet_z[r].x(); });
+    std::sort(m_by_max_z.begin(), m_by_max_z.end(), [this](uint32_t l, uint32_t r) { return m_facet_z[l].y() < m_facet_z[r].y(); });
+}
 
+void FacetZIndex::clear()
+{
+    m_facet_z.clear();
+    m_by_min_z.clear();
+    m_by_max_z.clear();
+}
+
+size_t FacetZIndex::num_below(float z_max) const
+{
+    return std::upper_bound(m_by_min_z.begin(), m_by_min_z.end(), z_max, [this](float z, uint32_t i) { return z < m_facet_z[i].x(); }) - m_by_min_z.begin();
+}
+
+size_t FacetZIndex::first_above(float z_min) const
+{
+    return std::lower_bound(m_by_max_z.begin(), m_by_max_z.end(), z_min, [this](uint32_t i, float z) { return m_facet_z[i].y() < z; }) - m_by_max_z.begin();
+}
+
+size_t FacetZIndex::num_facets_in_range(float z_min, float z_max) const
+{
+    if (z_min > z_max)
+        return 0;
+    // A facet is either below z_min, above z_max or it intersects the range, as min_z <= max_z.
+    return this->num_below(z_max) - this->first_above(z_min);
+}
+
+std::vector<uint32_t> FacetZIndex::facets_in_range(float z_min, float z_max) const
+{
+    std::vector<uint32_t> out;
+    if (z_min > z_max)
+        return out;
+    size_t num_below   = this->num_below(z_max);
+    size_t first_above = this->first_above(z_min);
+    out.reserve(num_below - first_above);
+    // Filter the shorter of the two candidate lists.
+    if (num_below < m_by_max_z.size() - first_above) {
+        for (auto it = m_by_min_z.begin(); it != m_by_min_z.begin() + num_below; ++ it)
+            if (m_facet_z[*it].y() >= z_min)
+                out.emplace_back(*it);
+    } else {
+        for (auto it = m_by_max_z.begin() + first_above; it != m_by_max_z.end(); ++ it)
+            if (m_facet_z[*it].x() <= z_max)
+                out.emplace_back(*it);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
 
 void TriangleMeshSlicer::slice(const std::vector<float> &z, SlicingMode mode, std::vector<Polygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const
 {
@@ -810,14 +888,47 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, SlicingMode mode, st
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
     std::vector<IntersectionLines> lines(z.size());
     {
-        boost::mutex lines_mutex;
+        // The facets are sliced in chunks of consecutive facets, each chunk collects its intersection lines into its own buffer,
+        // thus no locking is needed. The lines of each layer are then concatenated in the order of the chunks, so that
+        // the lines of a layer are ordered by the facet index independently of the thread scheduling.
+        const size_t num_facets       = size_t(this->mesh->stl.stats.number_of_facets);
+        // If the facet index is available, only the facets intersecting the Z range of the slicing planes are sliced.
+        std::vector<uint32_t> facets;
+        bool                  all_facets = true;
+        if (! m_facet_z_index.empty() && ! z.empty() && m_facet_z_index.num_facets_in_range(z.front(), z.back()) < num_facets) {
+            facets     = m_facet_z_index.facets_in_range(z.front(), z.back());
+            all_facets = false;
+        }
+        const size_t num_sliced       = all_facets ? num_facets : facets.size();
+        const size_t facets_per_chunk = std::max<size_t>(1024, num_sliced / 256);
+        const size_t num_chunks       = (num_sliced + facets_per_chunk - 1) / facets_per_chunk;
+        std::vector<std::vector<LayerIntersectionLine>> chunks(num_chunks);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, num_chunks, 1),
+            [&chunks, facets_per_chunk, num_sliced, all_facets, &facets, &z, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+                for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+                    throw_on_cancel();
+                    std::vector<LayerIntersectionLine> &chunk = chunks[chunk_idx];
+                    for (size_t i = chunk_idx * facets_per_chunk; i < std::min(num_sliced, (chunk_idx + 1) * facets_per_chunk); ++ i)
+                        this->_slice_do(all_facets ? i : size_t(facets[i]), &chunk, z);
+                    // Sort by the layer index, keep the facet order inside a layer.
+                    std::stable_sort(chunk.begin(), chunk.end(), [](const LayerIntersectionLine &l, const LayerIntersectionLine &r) { return l.first < r.first; });
+                }
+            }
+        );
+        throw_on_cancel();
         tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
-            [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
-                for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
-                    if ((facet_idx & 0x0ffff) == 0)
-                        throw_on_cancel();
-                    this->_slice_do(facet_idx, &lines, &lines_mutex, z);
+            tbb::blocked_range<size_t>(0, z.size()),
+            [&chunks, &lines](const tbb::blocked_range<size_t>& range) {
+                auto lower = [](const LayerIntersectionLine &l, size_t layer_idx) { return l.first < layer_idx; };
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    IntersectionLines &layer_lines = lines[layer_idx];
+                    for (const std::vector<LayerIntersectionLine> &chunk : chunks) {
+                        auto it_begin = std::lower_bound(chunk.begin(), chunk.end(), layer_idx, lower);
+                        auto it_end   = std::lower_bound(it_begin, chunk.end(), layer_idx + 1, lower);
+                        for (auto it = it_begin; it != it_end; ++ it)
+                            layer_lines.emplace_back(it->second);
+                    }
                 }
             }
         );
@@ -902,8 +1013,7 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, SlicingMode mode, st
 #endif
 }
 
-void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<LayerIntersectionLine>* lines, const std::vector<float> &z) const
 {
     const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
     
@@ -931,11 +1041,10 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
         std::vector<float>::size_type layer_idx = it - z.begin();
         IntersectionLine il;
         if (this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &il) == TriangleMeshSlicer::Slicing) {
-            boost::lock_guard<boost::mutex> l(*lines_mutex);
             if (il.edge_type == feHorizontal) {
                 // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
             } else
-                (*lines)[layer_idx].emplace_back(il);
+                lines->emplace_back(layer_idx, il);
         }
     }
 }
@@ -950,6 +1059,9 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, SlicingMode mode, co
 	tbb::parallel_for(
 		tbb::blocked_range<size_t>(0, z.size()),
 		[&layers_p, mode, closing_radius, layers, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+            // The temporary data structures of the Clipper operations are released at once after each layer.
+            ClipperLib::Arena      arena;
+            ClipperLib::ArenaScope arena_scope(arena);
     		for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
 #ifdef SLIC3R_TRIANGLEMESH_DEBUG
                 printf("Layer %zu (slice_z = %.2f):\n", layer_id, z[layer_id]);
@@ -959,6 +1071,7 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, SlicingMode mode, co
     			this->make_expolygons(layers_p[layer_id], closing_radius, &expolygons);
     			if (mode == SlicingMode::PositiveLargestContour)
 					keep_largest_contour_only(expolygons);
+                arena.release();
     		}
     	});
 	BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::make_expolygons in parallel - end";
@@ -161,6 +161,8 @@ public:
 };
 typedef std::vector<IntersectionLine> IntersectionLines;
 typedef std::vector<IntersectionLine*> IntersectionLinePtrs;
+// Intersection line tagged with the index of the layer it belongs to.
+typedef std::pair<size_t, IntersectionLine> LayerIntersectionLine;
 
 enum class SlicingMode : uint32_t {
 	// Regular slicing, maintain all contours and their orientation.
@@ -172,6 +174,34 @@ enum class SlicingMode : uint32_t {
 	PositiveLargestContour,
 };
 
+// Index of the facets of a mesh by their Z extents, to quickly find the facets intersecting a range of slicing planes
+// without touching the other facets. The index is built once and reused by the consecutive slicing calls,
+// for example when re-slicing just the Z range modified by the variable layer height editing.
+class FacetZIndex
+{
+public:
+    // Build the index from the (min_z, max_z) extents of the facets.
+    void                    build(std::vector<Vec2f> &&facet_z);
+    void                    clear();
+    bool                    empty() const { return m_facet_z.empty(); }
+    size_t                  num_facets() const { return m_facet_z.size(); }
+    // Indices of the facets intersecting the closed Z range <z_min, z_max>, sorted by the facet index.
+    std::vector<uint32_t>   facets_in_range(float z_min, float z_max) const;
+    // Number of the facets intersecting the closed Z range <z_min, z_max>.
+    size_t                  num_facets_in_range(float z_min, float z_max) const;
+
+private:
+    // Extents of the facets, indexed by the facet index.
+    std::vector<Vec2f>      m_facet_z;
+    // Facet indices sorted by the minimum, resp. maximum Z of the facet.
+    std::vector<uint32_t>   m_by_min_z;
+    std::vector<uint32_t>   m_by_max_z;
+
+    // Number of facets with min_z <= z_max, resp. the position of the first facet with max_z >= z_min.
+    size_t                  num_below(float z_max) const;
+    size_t                  first_above(float z_min) const;
+};
+
 class TriangleMeshSlicer
 {
 public:
@@ -190,6 +220,10 @@ public:
         const float min_z, const float max_z, IntersectionLine *line_out) const;
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     void set_up_direction(const Vec3f& up);
+    // Build the index of facets by their Z extents. Once built, slice() only processes the facets intersecting
+    // the Z range of the slicing planes, which makes slicing of a short Z range of a large mesh cheap.
+    void build_facet_z_index();
+    const FacetZIndex& facet_z_index() const { return m_facet_z_index; }
     
 private:
     const TriangleMesh      *mesh;
@@ -201,8 +235,10 @@ private:
     Eigen::Quaternion<float, Eigen::DontAlign> m_quaternion;
     // Whether or not the above quaterion should be used
     bool                     m_use_quaternion = false;
+    // Optional index of the facets by their Z extents.
+    FacetZIndex              m_facet_z_index;
 
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
+    void _slice_do(size_t facet_idx, std::vector<LayerIntersectionLine>* lines, const std::vector<float> &z) const;
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
     void make_expolygons(const Polygons &loops, const float closing_radius, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
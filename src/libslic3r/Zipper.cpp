@@ -110,6 +110,53 @@ void Zipper::add_entry(const std::string &name, const void *data, size_t l)
     m_data.clear();
 }
 
+Zipper::CompressedEntry Zipper::compress_entry(const void *data, size_t l, e_compression compression)
+{
+    CompressedEntry out;
+    out.uncompressed_size = l;
+    out.crc = uint32_t(mz_crc32(MZ_CRC32_INIT, static_cast<const mz_uint8*>(data), l));
+
+    int level = MZ_NO_COMPRESSION;
+    switch (compression) {
+    case NO_COMPRESSION: level = MZ_NO_COMPRESSION; break;
+    case FAST_COMPRESSION: level = MZ_BEST_SPEED; break;
+    case TIGHT_COMPRESSION: level = MZ_BEST_COMPRESSION; break;
+    }
+
+    // Very short entries are stored by miniz as well.
+    if (level != MZ_NO_COMPRESSION && l > 3) {
+        // Raw deflate stream (negative window bits), as written into a zip archive by mz_zip_writer_add_mem().
+        size_t out_len = 0;
+        void  *out_buf = tdefl_compress_mem_to_heap(data, l, &out_len,
+            int(tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)));
+        if (out_buf == nullptr)
+            throw std::runtime_error(L("Error with zip archive") + ": " + mz_zip_get_error_string(MZ_ZIP_COMPRESSION_FAILED) + "!");
+        out.data.assign(static_cast<const uint8_t*>(out_buf), static_cast<const uint8_t*>(out_buf) + out_len);
+        mz_free(out_buf);
+        out.deflated = true;
+    } else
+        out.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + l);
+
+    return out;
+}
+
+void Zipper::add_entry(const std::string &name, const CompressedEntry &entry)
+{
+    if(!m_impl->is_alive()) return;
+
+    finish_entry();
+
+    bool ok = entry.deflated ?
+        mz_zip_writer_add_mem_ex(&m_impl->arch, name.c_str(), entry.data.data(), entry.data.size(), nullptr, 0,
+                                 MZ_ZIP_FLAG_COMPRESSED_DATA, entry.uncompressed_size, entry.crc) :
+        mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), entry.data.data(), entry.data.size(), MZ_NO_COMPRESSION);
+    if(!ok)
+        m_impl->blow_up();
+
+    m_entry.clear();
+    m_data.clear();
+}
+
 void Zipper::finish_entry()
 {
     if(!m_impl->is_alive()) return;
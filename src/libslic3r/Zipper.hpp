@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace Slic3r {
 
@@ -17,6 +18,16 @@ public:
         TIGHT_COMPRESSION
     };
 
+    // Data of an entry compressed in advance by compress_entry(), see
+    // add_entry(const std::string&, const CompressedEntry&).
+    struct CompressedEntry {
+        std::vector<uint8_t> data;
+        size_t   uncompressed_size = 0;
+        uint32_t crc               = 0;
+        // Raw deflate stream if true, the data stored as is otherwise.
+        bool     deflated          = false;
+    };
+
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
@@ -51,6 +62,19 @@ public:
     /// This method throws exactly like finish_entry() does.
     void add_entry(const std::string& name, const void* data, size_t bytes);
 
+    /// Compress a byte buffer the same way add_entry() would. This method does
+    /// not touch the archive, thus it may be called from multiple threads to
+    /// compress entries in parallel, which are then added in sequence.
+    static CompressedEntry compress_entry(const void* data, size_t bytes, e_compression level);
+    CompressedEntry compress_entry(const void* data, size_t bytes) const
+    {
+        return compress_entry(data, bytes, m_compression);
+    }
+
+    /// Add a new binary file entry compressed in advance by compress_entry().
+    /// This method throws exactly like finish_entry() does.
+    void add_entry(const std::string& name, const CompressedEntry &entry);
+
     // Writing data to the archive works like with standard streams. The target
     // within the zip file is the entry created with the add_entry method.
 
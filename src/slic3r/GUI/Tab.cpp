@@ -1490,6 +1490,7 @@ void TabPrint::build()
 
         optgroup = page->new_optgroup(L("Other"));
         optgroup->append_single_option_line("clip_multipart_objects");
+        optgroup->append_single_option_line("chain_cluster_size");
 
     page = add_options_page(L("Output options"), "output+page_white");
         optgroup = page->new_optgroup(L("Sequential printing"));
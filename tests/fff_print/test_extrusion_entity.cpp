@@ -1,10 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "libslic3r/ExtrusionEntityCollection.hpp"
 #include "libslic3r/ExtrusionEntity.hpp"
 #include "libslic3r/Point.hpp"
+#include "libslic3r/ShortestPath.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include "test_data.hpp"
@@ -83,3 +85,51 @@ SCENARIO("ExtrusionEntityCollection: Polygon flattening", "[ExtrusionEntity]") {
         }
     }
 }
+
+SCENARIO("ExtrusionEntityCollection: Chaining over spatial clusters", "[ExtrusionEntity]") {
+    srand(0xDEADBEEF); // consistent seed for test reproducibility.
+
+    GIVEN("Paths, loops and no-sort collections, more than twice the cluster size") {
+        const size_t cluster_size = 20;
+        Slic3r::ExtrusionEntityCollection sample;
+        for (size_t i = 0; i < 5 * cluster_size; ++ i) {
+            Slic3r::ExtrusionPath path = random_path(2);
+            if (i % 3 == 0) {
+                sample.append(path);
+            } else if (i % 3 == 1) {
+                // Not reversible.
+                Slic3r::ExtrusionEntityCollection sub_nosort;
+                sub_nosort.no_sort = true;
+                sub_nosort.append(path);
+                sub_nosort.append(random_path(2));
+                sample.append(std::move(sub_nosort));
+            } else {
+                path.polyline.append(path.first_point());
+                sample.append(ExtrusionLoop(std::move(path)));
+            }
+        }
+        for (const Point *start_near : { static_cast<const Point*>(nullptr), &sample.entities.back()->last_point() }) {
+            WHEN((start_near ? "Chained from a start point" : "Chained without a start point")) {
+                std::vector<std::pair<size_t, bool>> chain = chain_extrusion_entities(sample.entities, start_near, cluster_size);
+                THEN("Each entity is chained once") {
+                    std::vector<size_t> indices;
+                    for (const std::pair<size_t, bool> &segment : chain)
+                        indices.emplace_back(segment.first);
+                    std::sort(indices.begin(), indices.end());
+                    REQUIRE(indices.size() == sample.entities.size());
+                    for (size_t i = 0; i < indices.size(); ++ i)
+                        REQUIRE(indices[i] == i);
+                }
+                THEN("Only the reversible entities are reversed") {
+                    size_t num_reversed = 0;
+                    for (const std::pair<size_t, bool> &segment : chain)
+                        if (segment.second) {
+                            REQUIRE(sample.entities[segment.first]->can_reverse());
+                            ++ num_reversed;
+                        }
+                    REQUIRE(num_reversed > 0);
+                }
+            }
+        }
+    }
+}
@@ -1,8 +1,15 @@
 #include <catch2/catch.hpp>
 
 #include <memory>
+#include <fstream>
+#include <numeric>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/GCodeProcessor.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +27,108 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("GCodeReader::parse_file() produces the same lines as parse_buffer()", "[GCode]") {
+    GIVEN("G-code with CRLF and LF line endings, comments and no newline at the end of file") {
+        const std::string gcode =
+            "G21 ; set units to millimeters\r\n"
+            "G1 Z0.200 F7800.000\n"
+            "\n"
+            "G1 X10.123 Y-0.000 E0.12346\n"
+            "G1 X.5 Y1. E-0.8 F2100\r\n"
+            "G1 X1e1 Y123456789012345678 Z0.00000000000000000000001\n"
+            "G1 X1.2.3 Y-\n"
+            "G1 X\n"
+            "5 ; the number of an empty axis value shall not be parsed from the next line\n"
+            "M107";
+        boost::filesystem::path temp = boost::filesystem::unique_path();
+        {
+            std::ofstream f(temp.string(), std::ios::binary);
+            f << gcode;
+        }
+        std::vector<std::pair<std::string, std::vector<float>>> lines_buffer, lines_file;
+        auto collect = [](std::vector<std::pair<std::string, std::vector<float>>> &out) {
+            return [&out](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+                out.push_back({ line.raw(), { line.x(), line.y(), line.z(), line.e(), line.f(), float(line.has_x()), float(line.has_y()), reader.x(), reader.y(), reader.z() } });
+            };
+        };
+        GCodeReader reader_buffer;
+        // The buffer parser skips a trailing empty line and splits lines at '\r' as well, thus parse the lines one by one.
+        {
+            std::istringstream ss(gcode);
+            std::string line;
+            while (std::getline(ss, line))
+                reader_buffer.parse_line(line, collect(lines_buffer));
+        }
+        GCodeReader reader_file;
+        reader_file.parse_file(temp.string(), collect(lines_file));
+        boost::nowide::remove(temp.string().c_str());
+        THEN("All lines including their parsed coordinates match") {
+            REQUIRE(lines_file.size() == 10);
+            REQUIRE(lines_file == lines_buffer);
+        }
+        THEN("Numbers are parsed as by strtod") {
+            REQUIRE(lines_file[3].second[0] == 10.123f);
+            REQUIRE(lines_file[4].second[0] == 0.5f);
+            REQUIRE(lines_file[4].second[3] == -0.8f);
+            REQUIRE(lines_file[5].second[0] == 10.f);
+            REQUIRE(lines_file[6].second[5] == 0.f);
+            REQUIRE(lines_file[7].second[0] == 0.f);
+            REQUIRE(lines_file[7].second[5] == 1.f);
+        }
+    }
+}
+
+SCENARIO("GCodeProcessor::process_buffer() does not depend on how the G-code is split into blocks", "[GCode]") {
+    GIVEN("G-code with an empty axis value followed by a line starting with a number") {
+        const std::string gcode =
+            "G21\n"
+            "G90\n"
+            "M83\n"
+            "G1 Z0.2 F7800\n"
+            "G1 X10.5 Y20.25 E1.5 F1800\n"
+            "G1 X\n"
+            "5 ; the number of an empty axis value shall not be parsed from the next line\n"
+            "G1 X30.125 Y-4.5 E0.75\n"
+            "G1 Y12.5\n";
+        auto process = [&gcode](const std::vector<size_t> &splits) {
+            GCodeProcessor processor;
+            processor.apply_config(PrintConfig::defaults());
+            processor.initialize();
+            size_t begin = 0;
+            for (size_t split : splits) {
+                // The data past the end of a block is valid memory, thus reading past the end of the block would not crash,
+                // but it would be detected by the moves differing from those of the G-code processed in one block.
+                processor.process_buffer(gcode.data() + begin, split - begin);
+                begin = split;
+            }
+            processor.process_buffer(gcode.data() + begin, gcode.size() - begin);
+            std::vector<std::pair<Vec3f, float>> moves;
+            for (const GCodeProcessor::MoveVertex &move : processor.get_result().moves)
+                moves.emplace_back(move.position, move.delta_extruder);
+            return moves;
+        };
+        std::vector<std::pair<Vec3f, float>> moves = process({});
+        auto has_move = [&moves](std::function<bool(const Vec3f&)> pred) {
+            return std::find_if(moves.begin(), moves.end(), [&pred](const std::pair<Vec3f, float> &m){ return pred(m.first); }) != moves.end();
+        };
+        THEN("The empty axis value is parsed as zero") {
+            REQUIRE(has_move([](const Vec3f &pos){ return pos == Vec3f(10.5f, 20.25f, 0.2f); }));
+            REQUIRE(has_move([](const Vec3f &pos){ return pos == Vec3f(0.f, 20.25f, 0.2f); }));
+            REQUIRE(! has_move([](const Vec3f &pos){ return pos.x() == 5.f; }));
+        }
+        WHEN("The G-code is split into two blocks at every position, including inside the numbers and after \"G1 X\\n\"") {
+            THEN("The moves are the same as if processed in one block") {
+                for (size_t split = 1; split < gcode.size(); ++ split)
+                    REQUIRE(process({ split }) == moves);
+            }
+        }
+        WHEN("The G-code is fed character by character") {
+            std::vector<size_t> splits(gcode.size() - 1);
+            std::iota(splits.begin(), splits.end(), 1);
+            THEN("The moves are the same as if processed in one block") {
+                REQUIRE(process(splits) == moves);
+            }
+        }
+    }
+}
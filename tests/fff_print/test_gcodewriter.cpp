@@ -1,6 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <random>
+#include <sstream>
 
 #include "libslic3r/GCodeWriter.hpp"
 
@@ -94,3 +99,78 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+static std::string format_fixed_stream(double value, int precision)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(precision) << value;
+    return ss.str();
+}
+
+static std::string format_fixed_fast(double value, int precision)
+{
+    std::string out;
+    append_fixed(out, value, precision);
+    return out;
+}
+
+SCENARIO("append_fixed emits the same text as std::ostream with std::fixed.", "[GCodeWriter]") {
+    GIVEN("Numbers close to rounding ties, zeros and numbers out of the fast path range") {
+        for (double v : { 0., -0., 0.0005, -0.0005, 0.00049999, 1.0625, -1.0625, 2.5, 203.200522, 99999.123, 999999.9995, 1e9, -1e20, 1e300 })
+            for (int precision = 0; precision <= 9; ++ precision)
+                REQUIRE(format_fixed_fast(v, precision) == format_fixed_stream(v, precision));
+    }
+    GIVEN("Random coordinates and extrusion values") {
+        std::mt19937_64 rng(0);
+        std::uniform_real_distribution<double> dist(-1000., 1000.);
+        size_t num_different = 0;
+        for (size_t i = 0; i < 100000; ++ i) {
+            double v = dist(rng);
+            for (double value : { v, v * 1e-3, std::round(v * 1000.) / 1000., std::round(v * 2000.) / 2000. })
+                for (int precision : { 3, 5 })
+                    if (format_fixed_fast(value, precision) != format_fixed_stream(value, precision))
+                        ++ num_different;
+        }
+        REQUIRE(num_different == 0);
+    }
+}
+
+SCENARIO("Move emitters format coordinates with fixed precision.", "[GCodeWriter]") {
+    GIVEN("GCodeWriter instance with a single extruder") {
+        GCodeWriter writer;
+        writer.set_extruders({ 0 });
+        writer.set_extruder(0);
+        THEN("travel_to_xy emits three decimal digits") {
+            REQUIRE_THAT(writer.travel_to_xy(Vec2d(10.12345, -0.0004)), Catch::Equals("G1 X10.123 Y-0.000 F7800.000\n"));
+        }
+        THEN("extrude_to_xy emits five decimal digits of E") {
+            REQUIRE_THAT(writer.extrude_to_xy(Vec2d(1., 2.), 0.123456789), Catch::Equals("G1 X1.000 Y2.000 E0.12346\n"));
+        }
+    }
+}
+
+TEST_CASE("Benchmark append_fixed against std::ostream", "[GCodeWriter][.benchmark]") {
+    std::mt19937_64 rng(0);
+    std::uniform_real_distribution<double> dist(-300., 300.);
+    std::vector<double> values(1000000);
+    for (double &v : values)
+        v = dist(rng);
+
+    size_t len_fast = 0, len_stream = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    std::string out;
+    for (double v : values) {
+        out.clear();
+        append_fixed(out, v, 3);
+        len_fast += out.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (double v : values)
+        len_stream += format_fixed_stream(v, 3).size();
+    auto t2 = std::chrono::steady_clock::now();
+
+    double time_fast   = std::chrono::duration<double>(t1 - t0).count();
+    double time_stream = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "append_fixed: " << time_fast << "s, std::ostream: " << time_stream << "s, speedup " << time_stream / time_fast << std::endl;
+    REQUIRE(len_fast == len_stream);
+}
@@ -4,6 +4,8 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
 
+#include <sstream>
+
 #include "test_data.hpp"
 
 using namespace Slic3r;
@@ -87,3 +89,215 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: layers kept after a layer height profile edit", "[PrintObject]") {
+    GIVEN("A sliced sphere") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize({ { "layer_height", 0.2 }, { "first_layer_height", 0.2 } });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::sphere_50mm}, print, model, config);
+        print.process();
+        const PrintObject            *object        = print.objects().front();
+        const std::vector<Layer*>     layers_before = object->layers();
+        const double                  height        = object->slicing_parameters().object_print_z_height();
+        WHEN("The layer height profile is edited in the middle of the object") {
+            const std::vector<coordf_t> profile { 0., 0.2, 0.5 * height, 0.2, 0.5 * height, 0.1, 0.5 * height + 2., 0.1, 0.5 * height + 2., 0.2, height, 0.2 };
+            model.objects.front()->layer_height_profile = profile;
+            print.apply(model, config);
+            print.process();
+            THEN("The PrintObject is kept and the layers below the edit are reused") {
+                REQUIRE(print.objects().front() == object);
+                const std::vector<Layer*> &layers = object->layers();
+                size_t num_kept = 0;
+                for (size_t i = 0; i < layers.size() && layers[i]->print_z < 0.5 * height - EPSILON; ++ i) {
+                    REQUIRE(layers[i] == layers_before[i]);
+                    ++ num_kept;
+                }
+                REQUIRE(num_kept > 0);
+            }
+            THEN("The layers match a print sliced from scratch") {
+                Slic3r::Print print2;
+                Slic3r::Model model2;
+                Slic3r::Test::init_print({TestMesh::sphere_50mm}, print2, model2, config);
+                model2.objects.front()->layer_height_profile = profile;
+                print2.apply(model2, config);
+                print2.process();
+                const std::vector<Layer*> &layers  = print.objects().front()->layers();
+                const std::vector<Layer*> &layers2 = print2.objects().front()->layers();
+                REQUIRE(layers.size() == layers2.size());
+                for (size_t i = 0; i < layers.size(); ++ i) {
+                    REQUIRE(layers[i]->id() == layers2[i]->id());
+                    REQUIRE(layers[i]->print_z == Approx(layers2[i]->print_z));
+                    REQUIRE(layers[i]->height == Approx(layers2[i]->height));
+                    REQUIRE(layers[i]->lslices.size() == layers2[i]->lslices.size());
+                    for (size_t j = 0; j < layers[i]->lslices.size(); ++ j)
+                        REQUIRE(layers[i]->lslices[j].area() == Approx(layers2[i]->lslices[j].area()));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: perimeters kept outside of the layers sliced again", "[PrintObject]") {
+    GIVEN("A sphere with perimeters generated") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize({ { "layer_height", 0.2 }, { "first_layer_height", 0.2 } });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::sphere_50mm}, print, model, config);
+        print.process();
+        const PrintObject *object = print.objects().front();
+        const double       height = object->slicing_parameters().object_print_z_height();
+        // Perimeters of a layer well below the edited range.
+        const ExtrusionEntity *perimeter_before = object->get_layer(2)->regions().front()->perimeters.entities.front();
+        WHEN("The layer height profile is edited in the middle of the object") {
+            const std::vector<coordf_t> profile { 0., 0.2, 0.5 * height, 0.2, 0.5 * height, 0.1, 0.5 * height + 2., 0.1, 0.5 * height + 2., 0.2, height, 0.2 };
+            model.objects.front()->layer_height_profile = profile;
+            print.apply(model, config);
+            print.process();
+            THEN("The perimeters of the layers far from the edit are kept") {
+                REQUIRE(object->get_layer(2)->regions().front()->perimeters.entities.front() == perimeter_before);
+            }
+            THEN("The perimeters match a print processed from scratch") {
+                Slic3r::Print print2;
+                Slic3r::Model model2;
+                Slic3r::Test::init_print({TestMesh::sphere_50mm}, print2, model2, config);
+                model2.objects.front()->layer_height_profile = profile;
+                print2.apply(model2, config);
+                print2.process();
+                const std::vector<Layer*> &layers  = object->layers();
+                const std::vector<Layer*> &layers2 = print2.objects().front()->layers();
+                REQUIRE(layers.size() == layers2.size());
+                for (size_t i = 0; i < layers.size(); ++ i) {
+                    const ExtrusionEntityCollection &perimeters  = layers[i]->regions().front()->perimeters;
+                    const ExtrusionEntityCollection &perimeters2 = layers2[i]->regions().front()->perimeters;
+                    REQUIRE(perimeters.entities.size() == perimeters2.entities.size());
+                    REQUIRE(perimeters.total_volume() == Approx(perimeters2.total_volume()));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: memory accounting and release of the intermediate layer data", "[PrintObject]") {
+    GIVEN("A 20mm cube printed on a raft") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize({ { "raft_layers", 2 }, { "fill_density", "20%" } });
+        WHEN("The print is processed") {
+            Slic3r::Print print;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, config);
+            const PrintObject    &object = *print.objects().front();
+            PrintObjectMemoryUsed memory = object.memory_used();
+            LayerMemoryUsed       total  = memory.total();
+            THEN("The memory is accounted for each layer and each support layer") {
+                REQUIRE(memory.layers.size() == object.layer_count());
+                REQUIRE(memory.support_layers.size() == object.support_layer_count());
+                for (const LayerMemoryUsed &layer : memory.layers)
+                    REQUIRE(layer[ldtPerimeters] > 0);
+            }
+            THEN("The data of all the steps are accounted for") {
+                REQUIRE(total[ldtRegionSlices] > 0);
+                REQUIRE(total[ldtFillSurfaces] > 0);
+                REQUIRE(total[ldtFills] > 0);
+                REQUIRE(total[ldtSupportFills] > 0);
+                size_t by_step = 0;
+                for (int step = 0; step < posCount; ++ step)
+                    by_step += memory.step(PrintObjectStep(step));
+                REQUIRE(by_step == total.total());
+            }
+        }
+        WHEN("The print is processed with the intermediate data released") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            print.set_release_intermediates(true);
+            print.process();
+            Slic3r::Print print_kept;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print_kept, config);
+            LayerMemoryUsed total      = print.objects().front()->memory_used().total();
+            LayerMemoryUsed total_kept = print_kept.objects().front()->memory_used().total();
+            THEN("Only the data not needed by the G-code export are released") {
+                // The internal region slices are kept for the retractions of the G-code export.
+                REQUIRE(total[ldtRegionSlices] < total_kept[ldtRegionSlices]);
+                REQUIRE(total[ldtFillExPolygons] == 0);
+                REQUIRE(total[ldtFillSurfaces] == 0);
+                REQUIRE(total[ldtThinFills] == 0);
+                REQUIRE(total.total() < total_kept.total());
+                for (LayerDataType type : { ldtLSlices, ldtPerimeters, ldtFills, ldtSupportIslands, ldtSupportFills })
+                    REQUIRE(total[type] == total_kept[type]);
+            }
+            THEN("The G-code is the same as with the intermediate data kept") {
+                // Strip the comments, the header contains a time stamp.
+                auto strip_comments = [](const std::string &gcode) {
+                    std::string out;
+                    std::istringstream is(gcode);
+                    for (std::string line; std::getline(is, line);)
+                        if (line.empty() || line.front() != ';')
+                            out += line + "\n";
+                    return out;
+                };
+                REQUIRE(strip_comments(Slic3r::Test::gcode(print)) == strip_comments(Slic3r::Test::gcode(print_kept)));
+            }
+            THEN("After a change of the infill settings, the object is sliced again") {
+                config.set_deserialize({ { "fill_density", "40%" } });
+                print.set_release_intermediates(false);
+                print.apply(model, config);
+                print.process();
+                REQUIRE(print.objects().front()->memory_used().total()[ldtRegionSlices] > 0);
+                REQUIRE(print.objects().front()->memory_used().total()[ldtFills] > 0);
+            }
+        }
+    }
+    GIVEN("An ironed 20mm cube without support material") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize({ { "fill_density", "20%" }, { "ironing", 1 } });
+        WHEN("The print is processed with the intermediate data released") {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            print.set_release_intermediates(true);
+            // Reported after each batch of layers is filled, ironed and released.
+            size_t num_statuses = 0;
+            size_t num_partially_released = 0;
+            bool   released_once_done = true;
+            print.set_status_callback([&](const PrintBase::SlicingStatus &status) {
+                if (status.text.find("Infilling layers ") != 0)
+                    return;
+                ++ num_statuses;
+                size_t num_released = 0;
+                for (const Layer *layer : print.objects().front()->layers()) {
+                    LayerMemoryUsed memory   = layer->memory_used();
+                    bool            done     = memory[ldtFills] > 0;
+                    bool            released = memory[ldtFillSurfaces] == 0;
+                    released_once_done &= done == released;
+                    num_released += released;
+                }
+                if (num_released > 0 && num_released < print.objects().front()->layer_count())
+                    ++ num_partially_released;
+            });
+            print.process();
+            Slic3r::Print print_kept;
+            Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print_kept, config);
+            THEN("The data of each layer are released right after its infill and ironing is generated") {
+                REQUIRE(num_statuses > 1);
+                // Some layers were still to be processed when the others were already released.
+                REQUIRE(num_partially_released > 0);
+                REQUIRE(released_once_done);
+            }
+            THEN("The infill is the same as with the intermediate data kept") {
+                const PrintObject &object      = *print.objects().front();
+                const PrintObject &object_kept = *print_kept.objects().front();
+                REQUIRE(object.layer_count() == object_kept.layer_count());
+                for (size_t i = 0; i < object.layer_count(); ++ i) {
+                    LayerMemoryUsed layer      = object.get_layer(int(i))->memory_used();
+                    LayerMemoryUsed layer_kept = object_kept.get_layer(int(i))->memory_used();
+                    REQUIRE(layer[ldtRegionSlices] <= layer_kept[ldtRegionSlices]);
+                    REQUIRE(layer[ldtFillSurfaces] == 0);
+                    REQUIRE(layer[ldtFills] == layer_kept[ldtFills]);
+                    REQUIRE(object.get_layer(int(i))->regions().front()->fills.items_count() == object_kept.get_layer(int(i))->regions().front()->fills.items_count());
+                }
+            }
+        }
+    }
+}
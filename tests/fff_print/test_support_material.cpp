@@ -5,6 +5,8 @@
 
 #include "test_data.hpp" // get access to init_print, etc
 
+#include <tbb/task_scheduler_init.h>
+
 using namespace Slic3r::Test;
 using namespace Slic3r;
 
@@ -115,6 +117,62 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: support does not depend on the number of threads", "[SupportMaterial]")
+{
+    GIVEN("A cube with a hole supported from the top surface below the hole") {
+        TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::cube_with_hole);
+        mesh.rotate_x(float(M_PI / 2));
+        auto support_layers = [&mesh](Slic3r::Print &print) {
+            Slic3r::Test::init_and_process_print({ mesh }, print, {
+                { "support_material",   1 },
+                { "layer_height",       0.2 },
+                { "first_layer_height", 0.3 },
+            });
+            std::vector<std::pair<coordf_t, std::vector<Points>>> out;
+            for (const SupportLayer *layer : print.objects().front()->support_layers()) {
+                out.emplace_back(layer->print_z, std::vector<Points>());
+                for (const Polyline &polyline : layer->support_fills.as_polylines())
+                    out.back().second.emplace_back(polyline.points);
+            }
+            return out;
+        };
+        WHEN("Support is generated with a single thread and with all threads") {
+            Slic3r::Print print_serial, print_parallel;
+            std::vector<std::pair<coordf_t, std::vector<Points>>> layers_serial;
+            {
+                tbb::task_scheduler_init init(1);
+                layers_serial = support_layers(print_serial);
+            }
+            std::vector<std::pair<coordf_t, std::vector<Points>>> layers_parallel = support_layers(print_parallel);
+            THEN("The support layers and their extrusions are identical") {
+                REQUIRE(! layers_serial.empty());
+                REQUIRE(layers_serial == layers_parallel);
+            }
+            THEN("The support areas match those of the former serial propagation of the support down the object") {
+                // print_z and area of the support islands in mm^2, as generated before the propagation was parallelized.
+                static const std::vector<std::pair<size_t, std::pair<double, double>>> expected {
+                    {  0, {  0.3,   130.4591 } },
+                    {  1, {  0.584,  15.7388 } },
+                    { 18, {  5.416,  15.7388 } },
+                    { 19, {  5.7,    68.6405 } },
+                    { 20, {  6.,     64.4114 } },
+                    { 49, { 14.7,    64.4110 } },
+                    { 50, { 14.9,    16.2411 } }
+                };
+                const SupportLayerPtrs &layers = print_serial.objects().front()->support_layers();
+                REQUIRE(layers.size() == 51);
+                for (const auto &[idx, z_area] : expected) {
+                    double area = 0.;
+                    for (const ExPolygon &expoly : layers[idx]->support_islands.expolygons)
+                        area += expoly.area();
+                    REQUIRE(layers[idx]->print_z == Approx(z_area.first).margin(0.001));
+                    REQUIRE(area * SCALING_FACTOR * SCALING_FACTOR == Approx(z_area.second).margin(0.001));
+                }
+            }
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
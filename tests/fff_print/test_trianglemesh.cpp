@@ -5,10 +5,14 @@
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/Format/OBJ.hpp"
 
 #include <algorithm>
 #include <future>
 #include <chrono>
+#include <iostream>
+
+#include <tbb/task_scheduler_init.h>
 
 //#include "test_options.hpp"
 #include "test_data.hpp"
@@ -228,6 +232,100 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+static std::vector<float> slicing_planes(const TriangleMesh &mesh, float layer_height)
+{
+    BoundingBoxf3 bb = mesh.bounding_box();
+    std::vector<float> z;
+    for (double h = bb.min.z() + 0.5 * layer_height; h < bb.max.z(); h += layer_height)
+        z.emplace_back(float(h));
+    return z;
+}
+
+SCENARIO( "TriangleMeshSlicer: slicing does not depend on the number of threads.") {
+    GIVEN( "A finely tesselated sphere and a test mesh") {
+        std::vector<TriangleMesh> meshes { make_sphere(25., 2. * PI / 360.), Slic3r::Test::mesh(Slic3r::Test::TestMesh::gt2_teeth) };
+        for (TriangleMesh &mesh : meshes) {
+            mesh.repair();
+            mesh.require_shared_vertices();
+            std::vector<float> z = slicing_planes(mesh, 0.1f);
+            WHEN("Sliced with a single thread and with all threads") {
+                std::vector<Polygons> layers_serial, layers_parallel;
+                {
+                    tbb::task_scheduler_init init(1);
+                    slice_mesh(mesh, z, layers_serial, []{});
+                }
+                slice_mesh(mesh, z, layers_parallel, []{});
+                THEN("The slices are identical") {
+                    REQUIRE(layers_serial.size() == z.size());
+                    REQUIRE(layers_serial == layers_parallel);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO( "TriangleMeshSlicer: facet Z index.") {
+    GIVEN( "A sphere with the facet Z index built") {
+        TriangleMesh mesh = make_sphere(25., 2. * PI / 180.);
+        mesh.repair();
+        mesh.require_shared_vertices();
+        TriangleMeshSlicer slicer(&mesh);
+        slicer.build_facet_z_index();
+        const FacetZIndex &index = slicer.facet_z_index();
+        REQUIRE(index.num_facets() == mesh.facets_count());
+        WHEN("Facets intersecting a Z range are queried") {
+            const float z_min = 10.f, z_max = 12.5f;
+            std::vector<uint32_t> facets = index.facets_in_range(z_min, z_max);
+            THEN("Exactly the facets spanning the range are returned") {
+                std::vector<uint32_t> expected;
+                for (uint32_t i = 0; i < uint32_t(mesh.facets_count()); ++ i) {
+                    const stl_facet &f = mesh.stl.facet_start[i];
+                    float fmin = std::min(f.vertex[0].z(), std::min(f.vertex[1].z(), f.vertex[2].z()));
+                    float fmax = std::max(f.vertex[0].z(), std::max(f.vertex[1].z(), f.vertex[2].z()));
+                    if (fmin <= z_max && fmax >= z_min)
+                        expected.emplace_back(i);
+                }
+                REQUIRE(! facets.empty());
+                REQUIRE(facets == expected);
+                REQUIRE(index.num_facets_in_range(z_min, z_max) == expected.size());
+            }
+        }
+        WHEN("A short Z range is sliced with and without the index") {
+            std::vector<float> z { 10.05f, 10.15f, 10.3f, 12.f };
+            std::vector<Polygons> layers_indexed, layers_full;
+            slicer.slice(z, SlicingMode::Regular, &layers_indexed, [](){});
+            TriangleMeshSlicer(&mesh).slice(z, SlicingMode::Regular, &layers_full, [](){});
+            THEN("The slices are identical") {
+                REQUIRE(layers_indexed.size() == z.size());
+                REQUIRE(layers_indexed == layers_full);
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark TriangleMeshSlicer", "[TriangleMesh][.benchmark]") {
+    auto benchmark = [](const std::string &name, TriangleMesh &mesh) {
+        mesh.repair();
+        mesh.require_shared_vertices();
+        std::vector<float> z = slicing_planes(mesh, 0.05f);
+        std::vector<Polygons> layers;
+        auto t0 = std::chrono::steady_clock::now();
+        slice_mesh(mesh, z, layers, []{});
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << name << ": " << mesh.facets_count() << " facets, " << z.size() << " layers, " <<
+            std::chrono::duration<double>(t1 - t0).count() << "s" << std::endl;
+        REQUIRE(layers.size() == z.size());
+    };
+    for (const char *name : { "frog_legs.obj", "extruder_idler.obj", "A_upsidedown.obj", "ipadstand.obj", "bridge.obj" }) {
+        TriangleMesh mesh;
+        REQUIRE(load_obj((std::string(TEST_DATA_DIR) + "/" + name).c_str(), &mesh));
+        benchmark(name, mesh);
+    }
+    // Synthetic mesh of about 10M facets.
+    TriangleMesh sphere = make_sphere(50., PI / 1580.);
+    benchmark("Sphere", sphere);
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
@@ -2,11 +2,16 @@
 
 #include <numeric>
 #include <iostream>
+#include <chrono>
 #include <boost/filesystem.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/mutex.h>
+
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 
 using namespace Slic3r;
 
@@ -299,3 +304,301 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+// Sequence of Clipper operations similar to the perimeter generator: successive insets and gaps between them.
+static ExPolygons clipper_perimeter_ops(const ExPolygons &slices)
+{
+    const float spacing = float(scale_(0.45));
+    ExPolygons  out;
+    ExPolygons  last = slices;
+    for (int i = 0; i < 5 && ! last.empty(); ++ i) {
+        ExPolygons next = offset2_ex(last, - 1.5f * spacing, 0.5f * spacing);
+        append(out, diff_ex(offset(last, - 0.5f * spacing), offset(next, 0.5f * spacing + 10.f)));
+        last = std::move(next);
+    }
+    append(out, union_ex(to_polygons(last)));
+    return out;
+}
+
+// Slices of a sphere overlapping with a cylinder, providing islands with holes.
+static std::vector<ExPolygons> arena_test_slices(double layer_height)
+{
+    TriangleMesh mesh = make_sphere(25., PI / 180.);
+    TriangleMesh cylinder = make_cylinder(10., 40., PI / 180.);
+    cylinder.translate(20.f, 0.f, -20.f);
+    mesh.merge(cylinder);
+    mesh.repair();
+    mesh.require_shared_vertices();
+    std::vector<float> z;
+    for (double slice_z = -25. + 0.5 * layer_height; slice_z < 25.; slice_z += layer_height)
+        z.emplace_back(float(slice_z));
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer(&mesh).slice(z, SlicingMode::Regular, 0.049f, &layers, [](){});
+    return layers;
+}
+
+SCENARIO("Clipper operations allocating from an arena", "[ClipperUtils]") {
+    GIVEN("Slices of a sphere and a cylinder") {
+        std::vector<ExPolygons> layers = arena_test_slices(1.);
+        WHEN("The perimeter like operations are executed with and without an arena") {
+            ClipperLib::Arena arena;
+            std::vector<ExPolygons> results_heap, results_arena;
+            for (const ExPolygons &slices : layers)
+                results_heap.emplace_back(clipper_perimeter_ops(slices));
+            {
+                ClipperLib::ArenaScope arena_scope(arena);
+                for (const ExPolygons &slices : layers) {
+                    results_arena.emplace_back(clipper_perimeter_ops(slices));
+                    arena.release();
+                }
+            }
+            THEN("The results are the same") {
+                REQUIRE(results_heap.size() == results_arena.size());
+                for (size_t i = 0; i < results_heap.size(); ++ i)
+                    REQUIRE(results_heap[i] == results_arena[i]);
+            }
+            THEN("The allocations are served from a few arena blocks") {
+                REQUIRE(arena.num_allocations() > 0);
+                REQUIRE(arena.num_blocks() < arena.num_allocations());
+                REQUIRE(ClipperLib::current_arena() == nullptr);
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark Clipper operations with an arena", "[ClipperUtils][.benchmark]") {
+    std::vector<ExPolygons> layers = arena_test_slices(0.05);
+    for (bool use_arena : { false, true }) {
+        size_t     num_allocations = 0;
+        size_t     num_blocks      = 0;
+        tbb::mutex mutex;
+        auto t0 = std::chrono::steady_clock::now();
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
+            [&layers, use_arena, &num_allocations, &num_blocks, &mutex](const tbb::blocked_range<size_t> &range) {
+                ClipperLib::Arena arena;
+                std::unique_ptr<ClipperLib::ArenaScope> arena_scope(use_arena ? new ClipperLib::ArenaScope(arena) : nullptr);
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    clipper_perimeter_ops(layers[i]);
+                    arena.release();
+                }
+                tbb::mutex::scoped_lock lock(mutex);
+                num_allocations += arena.num_allocations();
+                num_blocks      += arena.num_blocks();
+            });
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << (use_arena ? "Arena" : "Heap") << ": " << layers.size() << " layers, " << std::chrono::duration<double>(t1 - t0).count() << "s";
+        if (use_arena)
+            std::cout << ", " << num_allocations << " allocations served from " << num_blocks << " arena blocks";
+        std::cout << std::endl;
+    }
+}
+
+SCENARIO("Clipper reading Slic3r paths in place", "[ClipperUtils]") {
+    GIVEN("Slices of a sphere and a cylinder") {
+        std::vector<ExPolygons> layers = arena_test_slices(1.);
+        const float delta = float(scale_(0.3));
+        WHEN("Offsetting the slices") {
+            THEN("The result is the same as if the slices were converted to ClipperLib::Paths first") {
+                for (const ExPolygons &slices : layers) {
+                    Polygons polygons = to_polygons(slices);
+                    REQUIRE(offset(polygons, - delta) == ClipperPaths_to_Slic3rPolygons(
+                        _offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, - delta, jtMiter, 3.)));
+                    REQUIRE(offset(polygons, delta, jtRound, scale_(0.01)) == ClipperPaths_to_Slic3rPolygons(
+                        _offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, delta, jtRound, scale_(0.01))));
+                    Polylines polylines;
+                    for (const Polygon &polygon : polygons)
+                        polylines.emplace_back(polygon.split_at_first_point());
+                    REQUIRE(offset(polylines, delta) == ClipperPaths_to_Slic3rPolygons(
+                        _offset(Slic3rMultiPoints_to_ClipperPaths(polylines), ClipperLib::etOpenButt, delta, jtSquare, 3.)));
+                }
+            }
+        }
+        WHEN("Clipping the slices") {
+            THEN("The ExPolygons operations match the operations over polygons") {
+                for (const ExPolygons &slices : layers) {
+                    ExPolygons shrunk = offset_ex(slices, - delta);
+                    REQUIRE(diff_ex(slices, shrunk) == diff_ex(to_polygons(slices), to_polygons(shrunk)));
+                    REQUIRE(intersection(slices, shrunk) == intersection(to_polygons(slices), to_polygons(shrunk)));
+                    REQUIRE(union_ex(slices, true) == union_ex(to_polygons(slices), true));
+                }
+            }
+            THEN("Clipper output is the same for Slic3r paths and for ClipperLib::Paths") {
+                for (const ExPolygons &slices : layers) {
+                    Polygons subject = to_polygons(slices);
+                    Polygons clip    = offset(subject, - delta);
+                    ClipperLib::Paths out_paths, out_provider;
+                    {
+                        ClipperLib::Clipper clipper;
+                        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+                        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+                        clipper.Execute(ClipperLib::ctDifference, out_paths, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+                    }
+                    {
+                        ClipperLib::Clipper clipper;
+                        clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+                        clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+                        clipper.Execute(ClipperLib::ctDifference, out_provider, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+                    }
+                    REQUIRE(out_paths == out_provider);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark Clipper operations reading Slic3r paths in place", "[ClipperUtils][.benchmark]") {
+    std::vector<ExPolygons> layers = arena_test_slices(0.05);
+    std::vector<Polygons>   polygons;
+    for (const ExPolygons &slices : layers)
+        polygons.emplace_back(to_polygons(slices));
+    const float delta = float(scale_(0.3));
+    auto benchmark = [&layers](const char *name, auto op) {
+        auto t0 = std::chrono::steady_clock::now();
+        size_t num_output = 0;
+        for (size_t i = 0; i < layers.size(); ++ i)
+            num_output += op(i);
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << name << ": " << std::chrono::duration<double>(t1 - t0).count() << "s, " << num_output << " output polygons" << std::endl;
+    };
+    // Legacy path: conversion to ClipperLib::Paths, scaling and unscaling in separate passes.
+    benchmark("offset() converting to ClipperLib::Paths", [&polygons, delta](size_t i) {
+        return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons[i]), ClipperLib::etClosedPolygon, - delta, jtMiter, 3.)).size(); });
+    benchmark("offset() reading Slic3r paths in place", [&polygons, delta](size_t i) {
+        return offset(polygons[i], - delta).size(); });
+    benchmark("offset_ex(ExPolygons)", [&layers, delta](size_t i) {
+        return offset_ex(layers[i], - delta).size(); });
+    benchmark("offset2_ex(Polygons)", [&polygons, delta](size_t i) {
+        return offset2_ex(polygons[i], - delta, 0.5f * delta).size(); });
+    benchmark("diff_ex() over to_polygons()", [&layers, delta](size_t i) {
+        return diff_ex(to_polygons(layers[i]), to_polygons(offset_ex(layers[i], - delta))).size(); });
+    benchmark("diff_ex() over ExPolygons", [&layers, delta](size_t i) {
+        return diff_ex(layers[i], offset_ex(layers[i], - delta)).size(); });
+    benchmark("union_ex(ExPolygons)", [&layers](size_t i) {
+        return union_ex(layers[i]).size(); });
+}
+
+// Reference implementation of offsetting ExPolygons one by one, as it was implemented before ExPolygonsOffsetter,
+// copied here to verify ExPolygonsOffsetter against it.
+static ClipperLib::Paths reference_offset(const ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = jtMiter, double miterLimit = 3.)
+{
+    const float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
+    auto offset_path = [delta_scaled, joinType, miterLimit](const Polygon &polygon, bool reversed, float d) {
+        ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(polygon);
+        if (reversed)
+            std::reverse(input.begin(), input.end());
+        for (ClipperLib::IntPoint &pt : input) {
+            pt.X <<= CLIPPER_OFFSET_POWER_OF_2;
+            pt.Y <<= CLIPPER_OFFSET_POWER_OF_2;
+        }
+        ClipperLib::ClipperOffset co;
+        if (joinType == jtRound)
+            co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+        else
+            co.MiterLimit = miterLimit;
+        co.ShortestEdgeLength = double(std::abs(delta_scaled * 0.005f));
+        co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        ClipperLib::Paths out;
+        co.Execute(out, d);
+        return out;
+    };
+    ClipperLib::Paths contours_cummulative;
+    size_t expolygons_collected = 0;
+    for (const ExPolygon &expoly : expolygons) {
+        ClipperLib::Paths contours = offset_path(expoly.contour, false, delta_scaled);
+        if (contours.empty())
+            continue;
+        ClipperLib::Paths holes;
+        for (const Polygon &hole : expoly.holes)
+            append(holes, offset_path(hole, true, - delta_scaled));
+        if (holes.empty()) {
+            append(contours_cummulative, std::move(contours));
+            ++ expolygons_collected;
+        } else if (delta < 0) {
+            ClipperLib::Clipper clipper;
+            clipper.AddPaths(contours, ClipperLib::ptSubject, true);
+            clipper.AddPaths(holes, ClipperLib::ptClip, true);
+            ClipperLib::Paths output;
+            clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            if (! output.empty()) {
+                append(contours_cummulative, std::move(output));
+                ++ expolygons_collected;
+            }
+        } else {
+            append(contours_cummulative, std::move(contours));
+            for (ClipperLib::Path &hole : holes)
+                std::reverse(hole.begin(), hole.end());
+            append(contours_cummulative, std::move(holes));
+            ++ expolygons_collected;
+        }
+    }
+    ClipperLib::Paths output;
+    if (expolygons_collected > 1 && delta > 0) {
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
+        clipper.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    } else
+        output = std::move(contours_cummulative);
+    for (ClipperLib::Path &path : output)
+        for (ClipperLib::IntPoint &pt : path) {
+            pt.X = (pt.X + CLIPPER_OFFSET_SCALE_ROUNDING_DELTA) >> CLIPPER_OFFSET_POWER_OF_2;
+            pt.Y = (pt.Y + CLIPPER_OFFSET_SCALE_ROUNDING_DELTA) >> CLIPPER_OFFSET_POWER_OF_2;
+        }
+    return output;
+}
+
+static ExPolygons reference_offset2_ex(const ExPolygons &expolygons, const float delta1, const float delta2)
+{
+    Polygons polys;
+    for (const ExPolygon &expoly : expolygons)
+        append(polys, ClipperPaths_to_Slic3rPolygons(reference_offset(
+            ClipperPaths_to_Slic3rExPolygons(reference_offset({ expoly }, delta1)), delta2)));
+    return union_ex(polys);
+}
+
+SCENARIO("Offsetting ExPolygons by multiple deltas", "[ClipperUtils]") {
+    auto test_offsetter = [](const std::vector<ExPolygons> &layers, const float spacing) {
+        for (const ExPolygons &slices : layers) {
+            ExPolygonsOffsetter offsetter(slices);
+            REQUIRE(offsetter.size() == slices.size());
+            REQUIRE(offsetter.offset_ex(- 0.5f * spacing) == ClipperPaths_to_Slic3rExPolygons(reference_offset(slices, - 0.5f * spacing)));
+            REQUIRE(offsetter.offset(0.5f * spacing) == ClipperPaths_to_Slic3rPolygons(reference_offset(slices, 0.5f * spacing)));
+            REQUIRE(offsetter.offset2_ex(- 0.5f * spacing, 0.25f * spacing) == reference_offset2_ex(slices, - 0.5f * spacing, 0.25f * spacing));
+            // Each offset drops the short edges relative to its own delta, as offset_ex() does.
+            REQUIRE(offsetter.offset_ex(- 0.1f * spacing) == ClipperPaths_to_Slic3rExPolygons(reference_offset(slices, - 0.1f * spacing)));
+            REQUIRE(offsetter.offset_ex(1.5f * spacing) == ClipperPaths_to_Slic3rExPolygons(reference_offset(slices, 1.5f * spacing)));
+        }
+    };
+    GIVEN("Slices of a sphere and a cylinder") {
+        std::vector<ExPolygons> layers = arena_test_slices(1.);
+        THEN("Each offset of ExPolygonsOffsetter matches the reference offset of the slices one by one") {
+            test_offsetter(layers, float(scale_(0.45)));
+        }
+    }
+    GIVEN("A grid of squares with holes 0.3mm apart") {
+        ExPolygons slices;
+        for (int i = 0; i < 3; ++ i)
+            for (int j = 0; j < 3; ++ j) {
+                ExPolygon square;
+                square.contour = Polygon::new_scale({ { 0., 0. }, { 10., 0. }, { 10., 10. }, { 0., 10. } });
+                Polygon hole = Polygon::new_scale({ { 3., 3. }, { 7., 3. }, { 7., 7. }, { 3., 7. } });
+                hole.reverse();
+                square.holes.emplace_back(std::move(hole));
+                square.translate(scale_(10.3 * i), scale_(10.3 * j));
+                slices.emplace_back(std::move(square));
+            }
+        THEN("Each offset of ExPolygonsOffsetter matches the reference offset of the squares one by one") {
+            test_offsetter({ slices }, float(scale_(0.45)));
+        }
+        THEN("The outwards offset merges the squares, the inwards offset keeps them apart") {
+            ExPolygonsOffsetter offsetter(slices);
+            ExPolygons grown  = offsetter.offset_ex(float(scale_(0.225)));
+            ExPolygons shrunk = offsetter.offset_ex(- float(scale_(0.225)));
+            REQUIRE(grown.size() == 1);
+            REQUIRE(grown.front().holes.size() == 9);
+            REQUIRE(shrunk.size() == 9);
+            // Each square of 10x10mm with a hole of 4x4mm shrinks to 9.55x9.55mm with a hole of 4.45x4.45mm.
+            for (const ExPolygon &expoly : shrunk)
+                REQUIRE(expoly.area() == Approx(scale_(scale_(9.55 * 9.55 - 4.45 * 4.45))).epsilon(1e-4));
+        }
+    }
+}
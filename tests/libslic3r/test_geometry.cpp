@@ -1,5 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+
 #include "libslic3r/Point.hpp"
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Polygon.hpp"
@@ -8,6 +13,8 @@
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/ShortestPath.hpp"
+#include "libslic3r/MotionPlanner.hpp"
+#include "libslic3r/EdgeGrid.hpp"
 
 using namespace Slic3r;
 
@@ -252,6 +259,34 @@ SCENARIO("Circle Fit, TaubinFit with Newton's method", "[Geometry]") {
     }
 }
 
+// Short randomly oriented segments scattered over a square, similar to gap fill.
+static Polylines random_short_polylines(size_t num_polylines, double size, double length)
+{
+	std::mt19937 rng(1);
+	auto random_coord = [&rng](double max) { return coord_t(rng() % uint32_t(scale_(max) + 1)); };
+	Polylines out;
+	out.reserve(num_polylines);
+	for (size_t i = 0; i < num_polylines; ++ i) {
+		Point a(random_coord(size), random_coord(size));
+		Point b = a + Point(random_coord(2. * length), random_coord(2. * length)) - Point::new_scale(length, length);
+		out.emplace_back(a, b);
+	}
+	return out;
+}
+
+static double travel_length(const Polylines &polylines)
+{
+	double length = 0.;
+	for (size_t i = 1; i < polylines.size(); ++ i)
+		length += (polylines[i].first_point() - polylines[i - 1].last_point()).cast<double>().norm();
+	return length;
+}
+
+static bool same_polylines(const Polylines &a, const Polylines &b)
+{
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const Polyline &pa, const Polyline &pb) { return pa.points == pb.points; });
+}
+
 SCENARIO("Path chaining", "[Geometry]") {
 	GIVEN("A path") {
 		std::vector<Point> points = { Point(26,26),Point(52,26),Point(0,26),Point(26,52),Point(26,0),Point(0,52),Point(52,52),Point(52,0) };
@@ -321,6 +356,80 @@ SCENARIO("Path chaining", "[Geometry]") {
 			}
 		}
 	}
+	GIVEN("Many short polylines") {
+		Polylines polylines = random_short_polylines(1000, 200., 1.5);
+		auto all_chained = [&polylines](const Polylines &chained) {
+			if (chained.size() != polylines.size())
+				return false;
+			// End points of a polyline independent of its orientation.
+			auto key = [](const Polyline &pl) {
+				Point a = pl.first_point();
+				Point b = pl.last_point();
+				if (b.x() < a.x() || (b.x() == a.x() && b.y() < a.y()))
+					std::swap(a, b);
+				return std::array<coord_t, 4>{ a.x(), a.y(), b.x(), b.y() };
+			};
+			std::vector<std::array<coord_t, 4>> src, dst;
+			for (const Polyline &pl : polylines)
+				src.emplace_back(key(pl));
+			for (const Polyline &pl : chained)
+				dst.emplace_back(key(pl));
+			std::sort(src.begin(), src.end());
+			std::sort(dst.begin(), dst.end());
+			return src == dst;
+		};
+		WHEN("Chained over spatial clusters") {
+			Polylines chained = chain_polylines(polylines, nullptr, 100);
+			THEN("Each polyline is chained once") {
+				REQUIRE(all_chained(chained));
+			}
+		}
+		WHEN("Chained over spatial clusters from a start point") {
+			Point start(0, 0);
+			Polylines chained = chain_polylines(polylines, &start, 100);
+			THEN("Each polyline is chained once") {
+				REQUIRE(all_chained(chained));
+			}
+		}
+	}
+	GIVEN("Five times the cluster size of short polylines") {
+		// Small enough for the greedy chaining of the whole set to be quick.
+		Polylines polylines = random_short_polylines(250, 100., 1.5);
+		Point     start(0, 0);
+		WHEN("Chained over spatial clusters") {
+			Polylines chained = chain_polylines(polylines, nullptr, 50);
+			Point     start_chained = chained.front().first_point();
+			Polylines greedy  = chain_polylines(polylines, &start_chained, 0);
+			THEN("The set is split into clusters") {
+				REQUIRE(! same_polylines(chained, greedy));
+			}
+			THEN("The travels are not longer than the greedy chaining of the whole set") {
+				REQUIRE(travel_length(chained) <= 1.05 * travel_length(greedy));
+			}
+		}
+		THEN("Sets of at most twice the cluster size are chained as without clustering") {
+			REQUIRE(same_polylines(chain_polylines(polylines, nullptr, 125), chain_polylines(polylines, nullptr, 0)));
+			REQUIRE(same_polylines(chain_polylines(polylines, &start, 125), chain_polylines(polylines, &start, 0)));
+		}
+		THEN("The default cluster size chains the whole set at once") {
+			REQUIRE(same_polylines(chain_polylines(polylines), chain_polylines(polylines, nullptr, 0)));
+			REQUIRE(same_polylines(chain_polylines(polylines, &start), chain_polylines(polylines, &start, 0)));
+		}
+	}
+}
+
+TEST_CASE("Benchmark chaining of polylines over spatial clusters", "[Geometry][.benchmark]") {
+	for (size_t num_polylines : { size_t(1000), size_t(20000) })
+		for (size_t cluster_size : { size_t(0), size_t(50), size_t(100), size_t(200) }) {
+			if (cluster_size == 0 && num_polylines > 1000)
+				// The two exchanges over the whole set take hours.
+				continue;
+			Polylines polylines = random_short_polylines(num_polylines, 200., 1.5);
+			auto t0 = std::chrono::steady_clock::now();
+			Polylines chained = chain_polylines(std::move(polylines), nullptr, cluster_size);
+			auto t1 = std::chrono::steady_clock::now();
+			std::cout << num_polylines << " polylines, cluster size " << cluster_size << ": " << std::chrono::duration<double>(t1 - t0).count() << "s, travel " << unscale<double>(travel_length(chained)) << "mm" << std::endl;
+		}
 }
 
 SCENARIO("Line distances", "[Geometry]"){
@@ -452,3 +561,142 @@ SCENARIO("Ported from xs/t/14_geometry.t", "[Geometry]"){
     	REQUIRE(! Slic3r::Geometry::directions_parallel(M_PI /2, PI, M_PI /180));
     }
 }
+
+SCENARIO("MotionPlannerGraph", "[Geometry]") {
+    GIVEN("A grid graph with a wall in the middle") {
+        // 9x9 grid of nodes, 4-connected, with the edges crossing the column x = 4 removed except for the top row.
+        MotionPlannerGraph graph;
+        const int n = 9;
+        for (int j = 0; j < n; ++ j)
+            for (int i = 0; i < n; ++ i)
+                graph.add_node(Point::new_scale(i, j));
+        auto add_edge = [&graph](int a, int b) {
+            graph.add_edge(a, b, scale_(1.));
+            graph.add_edge(b, a, scale_(1.));
+        };
+        for (int j = 0; j < n; ++ j)
+            for (int i = 0; i < n; ++ i) {
+                if (i + 1 < n && (i != 4 || j == n - 1))
+                    add_edge(j * n + i, j * n + i + 1);
+                if (j + 1 < n)
+                    add_edge(j * n + i, (j + 1) * n + i);
+            }
+        graph.build_nodes_index();
+        THEN("The closest node is found by the spatial index") {
+            REQUIRE(graph.find_closest_node(Point::new_scale(2.9, 5.2)) == 5 * n + 3);
+            REQUIRE(graph.find_closest_node(Point::new_scale(-10., 100.)) == (n - 1) * n);
+        }
+        WHEN("A shortest path is searched from one side of the wall to the other") {
+            Polyline path = graph.shortest_path(Point(0, 0), Point::new_scale(8., 0.));
+            THEN("The path goes around the wall") {
+                REQUIRE(path.first_point() == Point(0, 0));
+                REQUIRE(path.last_point() == Point::new_scale(8., 0.));
+                // 8 steps up, 8 steps right, 8 steps down.
+                REQUIRE(path.length() == Approx(scale_(24.)));
+            }
+        }
+    }
+}
+
+SCENARIO("MotionPlanner", "[Geometry]") {
+    GIVEN("An U shaped island") {
+        ExPolygon island;
+        for (const Vec2d &pt : { Vec2d(0., 0.), Vec2d(30., 0.), Vec2d(30., 30.), Vec2d(20., 30.), Vec2d(20., 10.), Vec2d(10., 10.), Vec2d(10., 30.), Vec2d(0., 30.) })
+            island.contour.points.emplace_back(Point::new_scale(pt.x(), pt.y()));
+        MotionPlanner planner({ island });
+        WHEN("A travel is planned between the two arms") {
+            Point from = Point::new_scale(5., 25.);
+            Point to   = Point::new_scale(25., 25.);
+            Polyline path = planner.shortest_path(from, to);
+            THEN("The travel does not leave the island") {
+                REQUIRE(path.first_point() == from);
+                REQUIRE(path.last_point() == to);
+                REQUIRE(path.points.size() > 2);
+                for (const Point &pt : path.points)
+                    REQUIRE(island.contains_b(pt));
+            }
+        }
+        WHEN("A travel is planned inside a single arm") {
+            Polyline path = planner.shortest_path(Point::new_scale(5., 25.), Point::new_scale(5., 5.));
+            THEN("The travel is a straight line") {
+                REQUIRE(path.points.size() == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("EdgeGrid closest point and signed distance", "[Geometry]") {
+    GIVEN("A star shaped polygon with a hole") {
+        ExPolygon expoly;
+        for (int i = 0; i < 200; ++ i) {
+            double a = 2. * PI * i / 200.;
+            double r = (i & 1) ? 10. : 12.;
+            expoly.contour.points.emplace_back(Point::new_scale(r * cos(a), r * sin(a)));
+        }
+        expoly.holes.emplace_back(Polygon::new_scale({ { -3., -3. }, { -3., 3. }, { 3., 3. }, { 3., -3. } }));
+        EdgeGrid::Grid grid;
+        grid.create(expoly, coord_t(scale_(1.)));
+        grid.calculate_sdf();
+        const Lines lines = expoly.lines();
+        const coord_t search_radius = coord_t(scale_(2.));
+        WHEN("Queried at points of a regular grid") {
+            bool closest_ok = true;
+            bool foot_ok    = true;
+            bool sign_ok    = true;
+            for (double y = -14.; y <= 14.; y += 0.37)
+                for (double x = -14.; x <= 14.; x += 0.37) {
+                    Point  pt = Point::new_scale(x, y);
+                    double dist_min = std::numeric_limits<double>::max();
+                    for (const Line &line : lines)
+                        dist_min = std::min(dist_min, line.distance_to(pt));
+                    EdgeGrid::Grid::ClosestPointResult cp = grid.closest_point(pt, search_radius);
+                    if (dist_min < search_radius - SCALED_EPSILON) {
+                        if (! cp.valid() || std::abs(std::abs(cp.distance) - dist_min) > SCALED_EPSILON)
+                            closest_ok = false;
+                        else {
+                            const Points &pts = *grid.contours()[cp.contour_idx];
+                            const Point  &p1  = pts[cp.start_point_idx];
+                            const Point  &p2  = pts[(cp.start_point_idx + 1 == pts.size()) ? 0 : cp.start_point_idx + 1];
+                            Vec2d foot = p1.cast<double>() * (1. - cp.t) + p2.cast<double>() * cp.t;
+                            if (std::abs((foot - pt.cast<double>()).norm() - dist_min) > SCALED_EPSILON)
+                                foot_ok = false;
+                        }
+                        coordf_t dist;
+                        if (! grid.signed_distance(pt, search_radius, dist) || (dist < 0) != expoly.contains(pt))
+                            // Negative inside, positive outside.
+                            sign_ok = sign_ok && dist_min < SCALED_EPSILON;
+                    }
+                }
+            THEN("The closest point is found at the distance of the closest edge") {
+                REQUIRE(closest_ok);
+            }
+            THEN("The closest point lies on the contour segment it references") {
+                REQUIRE(foot_ok);
+            }
+            THEN("The signed distance is negative inside the polygon") {
+                REQUIRE(sign_ok);
+            }
+        }
+        WHEN("The segments crossing the cells are resolved to their contours") {
+            size_t num_segments = 0;
+            bool   segments_ok  = true;
+            for (coord_t r = 0; r < coord_t(grid.rows()); ++ r)
+                for (coord_t c = 0; c < coord_t(grid.cols()); ++ c) {
+                    auto cell_data_range = grid.cell_data_range(r, c);
+                    for (auto it_segment = cell_data_range.first; it_segment != cell_data_range.second; ++ it_segment) {
+                        std::pair<size_t, size_t> contour_and_segment = grid.contour_and_segment(*it_segment);
+                        const Points &pts = *grid.contours()[contour_and_segment.first];
+                        size_t ipt = contour_and_segment.second;
+                        auto segment = grid.segment(*it_segment);
+                        if (ipt >= pts.size() || segment.first != pts[ipt] || segment.second != pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1])
+                            segments_ok = false;
+                        ++ num_segments;
+                    }
+                }
+            THEN("Each segment matches the points of its contour") {
+                REQUIRE(num_segments >= lines.size());
+                REQUIRE(segments_ok);
+            }
+        }
+    }
+}
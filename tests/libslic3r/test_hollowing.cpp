@@ -44,3 +44,57 @@ TEST_CASE("Negative 3D offset should produce smaller object.", "[Hollowing]")
     in_mesh.WriteOBJFile("merged_out.obj");
 }
 
+
+// Hollows the mesh at once and in the thinnest slabs and compares the results.
+static void check_slabs_match_whole(const Slic3r::TriangleMesh &in_mesh)
+{
+    Slic3r::sla::HollowingConfig hcfg;
+    hcfg.max_memory = 0;
+    std::unique_ptr<Slic3r::TriangleMesh> whole =
+        Slic3r::sla::generate_interior(in_mesh, hcfg);
+    
+    // Any limit below the estimate splits the mesh into the thinnest slabs.
+    hcfg.max_memory = 1;
+    std::unique_ptr<Slic3r::TriangleMesh> tiled =
+        Slic3r::sla::generate_interior(in_mesh, hcfg);
+    
+    REQUIRE(whole);
+    REQUIRE(tiled);
+    REQUIRE(!tiled->empty());
+    
+    // The slabs are stitched into a closed surface: repair() finds no open
+    // edges along the seams, thus it has nothing to connect or to remove.
+    tiled->repair();
+    REQUIRE(tiled->stl.stats.facets_w_1_bad_edge == 0);
+    REQUIRE(tiled->stl.stats.facets_w_2_bad_edge == 0);
+    REQUIRE(tiled->stl.stats.facets_w_3_bad_edge == 0);
+    REQUIRE(tiled->stl.stats.edges_fixed == 0);
+    REQUIRE(tiled->stl.stats.facets_removed == 0);
+    REQUIRE(tiled->is_manifold());
+    
+    // If the margin around the slabs was too narrow, the cutting planes would
+    // dent the interior along the seams.
+    REQUIRE(std::abs(tiled->volume()) ==
+            Approx(std::abs(whole->volume())).epsilon(0.01));
+    
+    Slic3r::BoundingBoxf3 bb_whole = whole->bounding_box();
+    Slic3r::BoundingBoxf3 bb_tiled = tiled->bounding_box();
+    REQUIRE((bb_tiled.min - bb_whole.min).norm() < 0.1);
+    REQUIRE((bb_tiled.max - bb_whole.max).norm() < 0.1);
+}
+
+TEST_CASE("Hollowing in slabs should match the interior hollowed at once", "[Hollowing]")
+{
+    SECTION("20mm cube") {
+        check_slabs_match_whole(load_model("20mm_cube.obj"));
+    }
+    // Curved surfaces cross the seams at all angles.
+    SECTION("Sphere") {
+        Slic3r::TriangleMesh sphere = Slic3r::make_sphere(10., Slic3r::PI / 60.);
+        sphere.repair();
+        check_slabs_match_whole(sphere);
+    }
+    SECTION("ipadstand") {
+        check_slabs_match_whole(load_model("ipadstand.obj"));
+    }
+}
@@ -1,10 +1,19 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <random>
+#include <chrono>
+#include <cstring>
+#include <numeric>
 
 #include "sla_test_utils.hpp"
 
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
+#include <libslic3r/SLA/RasterRLE.hpp>
+#include <libslic3r/SLA/Rotfinder.hpp>
+#include <libslic3r/Format/SL1.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/PNGRead.hpp>
+#include <libslic3r/miniz_extension.hpp>
 
 namespace {
 
@@ -221,6 +230,187 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
     REQUIRE(raster_pxsum(raster0) == 0);
 }
 
+static bool same_encoded(const sla::EncodedRaster &a, const sla::EncodedRaster &b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+TEST_CASE("RLE raster should match the full buffer raster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::RasterBase::Resolution res{2560, 1440};
+    sla::RasterBase::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+    
+    for (double gamma : {1., 0.})
+        for (auto orientation : {sla::RasterBase::roLandscape, sla::RasterBase::roPortrait}) {
+            sla::RasterBase::Trafo trafo{orientation, sla::RasterBase::MirrorX};
+            uqptr<sla::RasterBase> raster = sla::create_raster_grayscale_aa(res, pixdim, gamma, trafo);
+            uqptr<sla::RasterBase> raster_rle = sla::create_raster_grayscale_aa_rle(res, pixdim, gamma, trafo);
+            
+            // Overlapping polygons, partially outside of the display.
+            for (auto [size, dx] : { std::make_pair(60., 0.), std::make_pair(10., 25.), std::make_pair(40., 50.) }) {
+                ExPolygon poly = square_with_hole(size);
+                poly.rotate(0.3);
+                poly.translate(bb.center().x() + scaled(dx), bb.center().y());
+                raster->draw(poly);
+                raster_rle->draw(poly);
+            }
+            
+            auto &dense = static_cast<const sla::RasterGrayscaleAA&>(*raster);
+            auto &rle   = static_cast<const sla::RasterGrayscaleAARLE&>(*raster_rle);
+            size_t differences = 0;
+            for (size_t row = 0; row < res.height_px; ++row)
+                for (size_t col = 0; col < res.width_px; ++col)
+                    differences += dense.read_pixel(col, row) != rle.read_pixel(col, row);
+            REQUIRE(differences == 0);
+            REQUIRE(rle.memory_used() < res.pixels());
+            
+            REQUIRE(same_encoded(raster->encode(sla::PNGRasterEncoder{}), raster_rle->encode(sla::PNGRasterEncoder{})));
+            REQUIRE(same_encoded(raster->encode(sla::PPMRasterEncoder{}), raster_rle->encode(sla::PPMRasterEncoder{})));
+        }
+}
+
+TEST_CASE("Benchmark the RLE raster against the full buffer raster", "[SLARasterOutput][.benchmark]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::RasterBase::Resolution res{2560, 1440};
+    sla::RasterBase::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+    
+    // A few small islands, as on most layers of a print.
+    ExPolygons layer;
+    for (size_t i = 0; i < 8; ++i) {
+        ExPolygon poly = square_with_hole(4. + double(i));
+        poly.translate(bb.min.x() + scaled(10. + 12. * double(i)), bb.center().y());
+        layer.emplace_back(std::move(poly));
+    }
+    
+    const size_t num_layers = 20;
+    auto time = [&layer, num_layers](auto &&create_raster) {
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (size_t i = 0; i < num_layers; ++i) {
+            uqptr<sla::RasterBase> raster = create_raster();
+            for (const ExPolygon &poly : layer)
+                raster->draw(poly);
+            bytes += raster->encode(sla::PNGRasterEncoder{}).size();
+        }
+        return std::make_pair(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_layers, bytes);
+    };
+    auto dense = time([&]() { return sla::create_raster_grayscale_aa(res, pixdim); });
+    auto rle   = time([&]() { return sla::create_raster_grayscale_aa_rle(res, pixdim); });
+    
+    sla::RasterGrayscaleAARLE raster_rle(res, pixdim, {}, agg::gamma_power(1.));
+    for (const ExPolygon &poly : layer)
+        raster_rle.draw(poly);
+    
+    std::cout << "Raster " << res.width_px << "x" << res.height_px << ", " << layer.size() << " islands" << std::endl <<
+        "    memory full buffer: " << res.pixels() << " B, RLE: " << raster_rle.memory_used() << " B" << std::endl <<
+        "    draw and encode per layer full buffer: " << dense.first << " ms, RLE: " << rle.first << " ms" << std::endl;
+    REQUIRE(dense.second == rle.second);
+}
+
+// Layer images of an SL1 archive, in the order of the layers.
+static std::vector<std::string> sl1_layer_images(const std::string &fname)
+{
+    mz_zip_archive zip;
+    mz_zip_zero_struct(&zip);
+    REQUIRE(open_zip_reader(&zip, fname));
+    std::vector<std::pair<std::string, std::string>> images;
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip); ++i) {
+        mz_zip_archive_file_stat stat;
+        REQUIRE(mz_zip_reader_file_stat(&zip, i, &stat));
+        std::string name = stat.m_filename;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0) {
+            std::string data(size_t(stat.m_uncomp_size), '\0');
+            REQUIRE(mz_zip_reader_extract_to_mem(&zip, i, data.data(), data.size(), 0));
+            images.emplace_back(std::move(name), std::move(data));
+        }
+    }
+    close_zip_reader(&zip);
+    // The layer index is zero padded in the name of the image.
+    std::sort(images.begin(), images.end());
+    std::vector<std::string> out;
+    for (auto &image : images)
+        out.emplace_back(std::move(image.second));
+    return out;
+}
+
+static png::ImageGreyscale decode_layer_image(const std::string &data)
+{
+    png::ImageGreyscale img;
+    REQUIRE(png::decode_png(png::ReadBuf{data.data(), data.size()}, img));
+    return img;
+}
+
+TEST_CASE("Identical SLA layers should be exported once per layer with the same image", "[SLARasterOutput]") {
+    // Two plates joined by a narrower neck. The layers of the upper plate are
+    // identical to the layers of the lower plate, but not adjacent to them.
+    TriangleMesh mesh = make_cube(20., 20., 2.);
+    TriangleMesh neck = make_cube(10., 10., 2.);
+    neck.translate(5.f, 5.f, 2.f);
+    TriangleMesh top = make_cube(20., 20., 2.);
+    top.translate(0.f, 0.f, 4.f);
+    mesh.merge(neck);
+    mesh.merge(top);
+    mesh.translate(-10.f, -10.f, 0.f);
+    
+    Model model;
+    ModelObject *object = model.add_object();
+    object->add_volume(mesh);
+    object->add_instance()->set_offset(Vec3d(60., 34., 0.));
+    
+    DynamicPrintConfig config;
+    config.apply(SLAFullPrintConfig::defaults());
+    config.set("supports_enable", false);
+    config.set("pad_enable", false);
+    config.set("elefant_foot_compensation", 0.);
+    config.set("layer_height", 0.1);
+    config.set("display_pixels_x", 640);
+    config.set("display_pixels_y", 360);
+    
+    SLAPrint print;
+    print.apply(model, config);
+    SL1Archive archive(print.printer_config());
+    print.set_printer(&archive);
+    print.process();
+    
+    const std::vector<size_t> identical = print.identical_print_layers();
+    REQUIRE(identical.size() == print.print_layers().size());
+    // Layers of the upper plate, which share the raster of a layer of the lower plate.
+    std::vector<size_t> upper_plate;
+    for (size_t idx = 0; idx < identical.size(); ++idx) {
+        REQUIRE(identical[idx] <= idx);
+        if (identical[idx] != idx && ! print.print_layers()[idx - 1].same_transformed_slices(print.print_layers()[idx]))
+            upper_plate.emplace_back(idx);
+    }
+    // The first layer of the upper plate follows a layer of the neck.
+    REQUIRE(upper_plate.size() == 1);
+    const size_t source = identical[upper_plate.front()];
+    REQUIRE(upper_plate.front() - source > 1);
+    
+    const std::string stored_fname   = "identical_layers_stored.sl1";
+    const std::string streamed_fname = "identical_layers_streamed.sl1";
+    archive.export_print(stored_fname, print);
+    SL1Archive(print.printer_config()).export_print_streaming(streamed_fname, print);
+    std::vector<std::string> stored   = sl1_layer_images(stored_fname);
+    std::vector<std::string> streamed = sl1_layer_images(streamed_fname);
+    std::remove(stored_fname.c_str());
+    std::remove(streamed_fname.c_str());
+    
+    // One archive entry per layer, the same from both exports.
+    REQUIRE(stored.size() == identical.size());
+    REQUIRE(stored == streamed);
+    
+    png::ImageGreyscale source_img = decode_layer_image(stored[source]);
+    REQUIRE(std::count(source_img.buf.begin(), source_img.buf.end(), 0) < long(source_img.buf.size()));
+    for (size_t idx = 0; idx < identical.size(); ++idx)
+        if (identical[idx] == source)
+            REQUIRE(decode_layer_image(stored[idx]).buf == source_img.buf);
+        else if (identical[idx] == idx)
+            // The neck layers are drawn.
+            REQUIRE(decode_layer_image(stored[idx]).buf != source_img.buf);
+}
+
 TEST_CASE("Triangle mesh conversions should be correct", "[SLAConversions]")
 {
     sla::Contour3D cntr;
@@ -239,3 +429,42 @@ TEST_CASE("halfcone test", "[halfcone]") {
     m.require_shared_vertices();
     m.WriteOBJFile("Halfcone.obj");
 }
+
+// The score of a rotation as evaluated by find_best_rotation() facet by facet,
+// before the facet normals were merged.
+static double rotation_score_per_facet(const TriangleMesh &mesh, const Transform3d &rt)
+{
+    double score = 0;
+    for (const stl_facet &facet : mesh.stl.facet_start) {
+        Vec3d n = rt * facet.normal.cast<double>();
+        score += std::abs(n.dot(Vec3d::UnitX()));
+        score += std::abs(n.dot(Vec3d::UnitY()));
+        score += std::abs(n.dot(Vec3d::UnitZ()));
+    }
+    return score;
+}
+
+TEST_CASE("Rotation score of merged facet normals should match the score per facet", "[SLARotfinder]") {
+    // The cube and the caps of the cylinder repeat their normals, the sphere
+    // has enough distinct normals for the score to be reduced in parallel.
+    TriangleMesh mesh = make_cube(20., 20., 20.);
+    TriangleMesh cylinder = make_cylinder(10., 20.);
+    cylinder.translate(30.f, 0.f, 0.f);
+    TriangleMesh sphere = make_sphere(10., PI / 180.);
+    sphere.translate(-30.f, 0.f, 0.f);
+    mesh.merge(cylinder);
+    mesh.merge(sphere);
+    
+    sla::FacetNormals normals = sla::merge_facet_normals(mesh);
+    REQUIRE(normals.size() < mesh.stl.facet_start.size());
+    REQUIRE(std::accumulate(normals.count.begin(), normals.count.end(), 0.) == Approx(double(mesh.stl.facet_start.size())));
+    
+    for (const Vec3d &angles : { Vec3d(0., 0., 0.), Vec3d(PI / 4., 0., 0.), Vec3d(0.3, -1.1, 2.5), Vec3d(PI, PI / 2., -PI / 3.) }) {
+        // The rotation composed the same way as by find_best_rotation().
+        Transform3d rt = Transform3d::Identity();
+        rt.rotate(Eigen::AngleAxisd(angles.z(), Vec3d::UnitZ()));
+        rt.rotate(Eigen::AngleAxisd(angles.y(), Vec3d::UnitY()));
+        rt.rotate(Eigen::AngleAxisd(angles.x(), Vec3d::UnitX()));
+        REQUIRE(sla::rotation_score(normals, rt.linear()) == Approx(rotation_score_per_facet(mesh, rt)).epsilon(1e-9));
+    }
+}